@@ -10,9 +10,11 @@
 #pragma warning(disable:4786)   // some identifier longer than 256 characters
 #endif
 #include "bitvector.h"
+#include "bitvector64.h"
 #define FASTBIT_LAZY_INIT 1
 
 #include <iomanip>      // setw
+#include <algorithm>    // std::push_heap, std::pop_heap
 
 // constances defined in bitvector
 const unsigned ibis::bitvector::MAXBITS =
@@ -29,6 +31,260 @@ const ibis::bitvector::word_t ibis::bitvector::HEADER0 =
 (2U << ibis::bitvector::SECONDBIT);
 const ibis::bitvector::word_t ibis::bitvector::HEADER1 =
 (3U << ibis::bitvector::SECONDBIT);
+/// The last word of a bitvector serialized by writeWAH64.  The last word
+/// of the usual serialized form is the number of bits in the active word,
+/// which is always less than MAXBITS.
+const ibis::bitvector::word_t ibis::bitvector::WAH64TAG = 64;
+/// The last word of a bitvector serialized by writeHybrid as a sorted list
+/// of positions of the bits that are 1.
+const ibis::bitvector::word_t ibis::bitvector::ARRAYTAG = 65;
+/// The last word of a bitvector serialized by writeHybrid as a list of
+/// runs of 1s.
+const ibis::bitvector::word_t ibis::bitvector::RUNTAG = 66;
+
+// Block kernels for runs of literal words.  The logical operations spend
+// most of their time on literal words, and a run of literal words can be
+// combined without decoding one word at a time.  On x86_64 the kernels
+// use SSE2 (always available), and AVX2 or AVX-512 when the CPU supports
+// them; the choice is made once at run time.  Define FASTBIT_NO_SIMD to
+// use only the portable version.
+#if !defined(FASTBIT_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64))
+#  include <emmintrin.h>        // SSE2
+#  define FASTBIT_WAH_SSE2 1
+#  if (defined(__GNUC__) && __GNUC__ >= 5) || defined(__clang__)
+#    include <immintrin.h>      // AVX2, AVX-512
+#    define FASTBIT_WAH_AVX 1
+#  endif
+#endif
+
+/// The logical operations supported by the block kernels.
+enum ibis_wah_block_op {IBIS_WAH_AND, IBIS_WAH_OR, IBIS_WAH_XOR,
+                        IBIS_WAH_MINUS};
+
+/// A block kernel computes out[i] = a[i] op b[i] for i in [0, n).  The
+/// output may be the same array as either input.
+typedef void (*ibis_wah_block_fn)(int, ibis::bitvector::word_t*,
+                                  const ibis::bitvector::word_t*,
+                                  const ibis::bitvector::word_t*, size_t);
+
+/// The portable version of the block kernel.
+static inline void ibis_wah_block_plain(int op, ibis::bitvector::word_t *out,
+                                        const ibis::bitvector::word_t *a,
+                                        const ibis::bitvector::word_t *b,
+                                        size_t n) {
+    switch (op) {
+    case IBIS_WAH_AND:
+        for (size_t j = 0; j < n; ++ j) out[j] = a[j] & b[j];
+        break;
+    case IBIS_WAH_OR:
+        for (size_t j = 0; j < n; ++ j) out[j] = a[j] | b[j];
+        break;
+    case IBIS_WAH_XOR:
+        for (size_t j = 0; j < n; ++ j) out[j] = a[j] ^ b[j];
+        break;
+    default:
+        for (size_t j = 0; j < n; ++ j) out[j] = a[j] & ~(b[j]);
+        break;
+    }
+} // ibis_wah_block_plain
+
+#if defined(FASTBIT_WAH_SSE2)
+/// The SSE2 version of the block kernel, four words per step.
+static void ibis_wah_block_sse2(int op, ibis::bitvector::word_t *out,
+                                const ibis::bitvector::word_t *a,
+                                const ibis::bitvector::word_t *b, size_t n) {
+    const size_t nv = (n & ~static_cast<size_t>(3));
+    size_t j = 0;
+    switch (op) {
+    case IBIS_WAH_AND:
+        for (; j < nv; j += 4)
+            _mm_storeu_si128((__m128i*)(out+j), _mm_and_si128
+                             (_mm_loadu_si128((const __m128i*)(a+j)),
+                              _mm_loadu_si128((const __m128i*)(b+j))));
+        break;
+    case IBIS_WAH_OR:
+        for (; j < nv; j += 4)
+            _mm_storeu_si128((__m128i*)(out+j), _mm_or_si128
+                             (_mm_loadu_si128((const __m128i*)(a+j)),
+                              _mm_loadu_si128((const __m128i*)(b+j))));
+        break;
+    case IBIS_WAH_XOR:
+        for (; j < nv; j += 4)
+            _mm_storeu_si128((__m128i*)(out+j), _mm_xor_si128
+                             (_mm_loadu_si128((const __m128i*)(a+j)),
+                              _mm_loadu_si128((const __m128i*)(b+j))));
+        break;
+    default: // _mm_andnot_si128(x, y) computes ~x & y
+        for (; j < nv; j += 4)
+            _mm_storeu_si128((__m128i*)(out+j), _mm_andnot_si128
+                             (_mm_loadu_si128((const __m128i*)(b+j)),
+                              _mm_loadu_si128((const __m128i*)(a+j))));
+        break;
+    }
+    if (j < n)
+        ibis_wah_block_plain(op, out+j, a+j, b+j, n-j);
+} // ibis_wah_block_sse2
+#endif
+
+#if defined(FASTBIT_WAH_AVX)
+/// The AVX2 version of the block kernel, eight words per step.
+__attribute__((target("avx2")))
+static void ibis_wah_block_avx2(int op, ibis::bitvector::word_t *out,
+                                const ibis::bitvector::word_t *a,
+                                const ibis::bitvector::word_t *b, size_t n) {
+    const size_t nv = (n & ~static_cast<size_t>(7));
+    size_t j = 0;
+    switch (op) {
+    case IBIS_WAH_AND:
+        for (; j < nv; j += 8)
+            _mm256_storeu_si256((__m256i*)(out+j),
+                                _mm256_and_si256
+                                (_mm256_loadu_si256((const __m256i*)(a+j)),
+                                 _mm256_loadu_si256((const __m256i*)(b+j))));
+        break;
+    case IBIS_WAH_OR:
+        for (; j < nv; j += 8)
+            _mm256_storeu_si256((__m256i*)(out+j),
+                                _mm256_or_si256
+                                (_mm256_loadu_si256((const __m256i*)(a+j)),
+                                 _mm256_loadu_si256((const __m256i*)(b+j))));
+        break;
+    case IBIS_WAH_XOR:
+        for (; j < nv; j += 8)
+            _mm256_storeu_si256((__m256i*)(out+j),
+                                _mm256_xor_si256
+                                (_mm256_loadu_si256((const __m256i*)(a+j)),
+                                 _mm256_loadu_si256((const __m256i*)(b+j))));
+        break;
+    default:
+        for (; j < nv; j += 8)
+            _mm256_storeu_si256((__m256i*)(out+j),
+                                _mm256_andnot_si256
+                                (_mm256_loadu_si256((const __m256i*)(b+j)),
+                                 _mm256_loadu_si256((const __m256i*)(a+j))));
+        break;
+    }
+    if (j < n)
+        ibis_wah_block_sse2(op, out+j, a+j, b+j, n-j);
+} // ibis_wah_block_avx2
+
+/// The AVX-512 version of the block kernel, sixteen words per step.
+__attribute__((target("avx512f")))
+static void ibis_wah_block_avx512(int op, ibis::bitvector::word_t *out,
+                                  const ibis::bitvector::word_t *a,
+                                  const ibis::bitvector::word_t *b, size_t n) {
+    const size_t nv = (n & ~static_cast<size_t>(15));
+    size_t j = 0;
+    switch (op) {
+    case IBIS_WAH_AND:
+        for (; j < nv; j += 16)
+            _mm512_storeu_si512(out+j, _mm512_and_si512
+                                (_mm512_loadu_si512(a+j),
+                                 _mm512_loadu_si512(b+j)));
+        break;
+    case IBIS_WAH_OR:
+        for (; j < nv; j += 16)
+            _mm512_storeu_si512(out+j, _mm512_or_si512
+                                (_mm512_loadu_si512(a+j),
+                                 _mm512_loadu_si512(b+j)));
+        break;
+    case IBIS_WAH_XOR:
+        for (; j < nv; j += 16)
+            _mm512_storeu_si512(out+j, _mm512_xor_si512
+                                (_mm512_loadu_si512(a+j),
+                                 _mm512_loadu_si512(b+j)));
+        break;
+    default:
+        for (; j < nv; j += 16)
+            _mm512_storeu_si512(out+j, _mm512_andnot_si512
+                                (_mm512_loadu_si512(b+j),
+                                 _mm512_loadu_si512(a+j)));
+        break;
+    }
+    if (j < n)
+        ibis_wah_block_sse2(op, out+j, a+j, b+j, n-j);
+} // ibis_wah_block_avx512
+#endif
+
+/// The block kernels selected for this CPU, one for short runs and one for
+/// long runs.  They are set on first use.  Two threads racing to set them
+/// would store the same values.
+static ibis_wah_block_fn ibis_wah_block_short = 0;
+static ibis_wah_block_fn ibis_wah_block_long = 0;
+
+/// Pick the block kernels matching the capabilities of this CPU.  The wide
+/// AVX2 and AVX-512 kernels are only used for long runs, because the first
+/// wide instructions after a pause run slowly while the CPU powers up the
+/// upper lanes, which costs more than it saves on runs of a few dozen words.
+static void ibis_wah_block_select() {
+    ibis_wah_block_fn fn = ibis_wah_block_plain;
+#if defined(FASTBIT_WAH_SSE2)
+    fn = ibis_wah_block_sse2;
+#endif
+    ibis_wah_block_long = fn;
+#if defined(FASTBIT_WAH_AVX)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        ibis_wah_block_long = ibis_wah_block_avx512;
+    else if (__builtin_cpu_supports("avx2"))
+        ibis_wah_block_long = ibis_wah_block_avx2;
+#endif
+    ibis_wah_block_short = fn;
+} // ibis_wah_block_select
+
+/// Apply the operation @c op to @c n pairs of literal words.
+static void ibis_wah_block(int op, ibis::bitvector::word_t *out,
+                           const ibis::bitvector::word_t *a,
+                           const ibis::bitvector::word_t *b, size_t n) {
+    if (n < 8) { // too short for the vector units to pay off
+        ibis_wah_block_plain(op, out, a, b, n);
+    }
+    else {
+        if (ibis_wah_block_short == 0)
+            ibis_wah_block_select();
+        if (n < 256)
+            ibis_wah_block_short(op, out, a, b, n);
+        else
+            ibis_wah_block_long(op, out, a, b, n);
+    }
+} // ibis_wah_block
+
+/// Count the number of consecutive literal words at the start of [a, ae).
+/// The operations switch to this and the block kernels only after 32
+/// literal words in a row, because the word-by-word loops are faster on
+/// the short runs of literal words common in sparse bitvectors.
+static size_t
+ibis_wah_literals(const ibis::bitvector::word_t *a,
+                  const ibis::bitvector::word_t *ae) {
+    const ibis::bitvector::word_t *p = a;
+    while (p + 8 <= ae && ((p[0] | p[1] | p[2] | p[3] | p[4] | p[5] | p[6] |
+                            p[7]) >> (8*sizeof(ibis::bitvector::word_t)-1))
+           == 0)
+        p += 8;
+    while (p < ae && (*p >> (8*sizeof(ibis::bitvector::word_t)-1)) == 0)
+        ++ p;
+    return p - a;
+} // ibis_wah_literals
+
+/// Count the number of positions where both [a, ae) and [b, be) hold
+/// literal words, starting from the first word of each.
+static size_t
+ibis_wah_literals(const ibis::bitvector::word_t *a,
+                  const ibis::bitvector::word_t *ae,
+                  const ibis::bitvector::word_t *b,
+                  const ibis::bitvector::word_t *be) {
+    const size_t n = (ae - a <= be - b ? ae - a : be - b);
+    size_t j = 0;
+    while (j + 8 <= n &&
+           ((a[j] | a[j+1] | a[j+2] | a[j+3] | a[j+4] | a[j+5] | a[j+6] |
+             a[j+7] | b[j] | b[j+1] | b[j+2] | b[j+3] | b[j+4] | b[j+5] |
+             b[j+6] | b[j+7]) >> (8*sizeof(ibis::bitvector::word_t)-1)) == 0)
+        j += 8;
+    while (j < n && ((a[j] | b[j]) >> (8*sizeof(ibis::bitvector::word_t)-1))
+           == 0)
+        ++ j;
+    return j;
+} // ibis_wah_literals
 
 /// Default constructor.  Creates a new empty bitvector.
 ibis::bitvector::bitvector() : nbits(0), nset(0), active(), m_vec() {
@@ -53,7 +309,10 @@ ibis::bitvector::bitvector(const bitvector& bv)
 /// space for the underlying vector.
 ibis::bitvector::bitvector(const array_t<ibis::bitvector::word_t>& arr)
     : nbits(0), nset(0), m_vec(arr) {
-    if (m_vec.size() > 1) { // non-trivial size
+    if (m_vec.size() > 1 && m_vec.back() >= WAH64TAG) {
+        readTagged(); // one of the alternative serialized forms
+    }
+    else if (m_vec.size() > 1) { // non-trivial size
         if (m_vec.back() > 0) { // has active bits
             if (m_vec.back() < MAXBITS) {
                 active.nbits = m_vec.back();
@@ -110,7 +369,10 @@ ibis::bitvector::bitvector(const array_t<ibis::bitvector::word_t>& arr)
 ibis::bitvector::bitvector(const array_t<ibis::bitvector::word_t>& arr,
                            const size_t begin, const size_t end)
     : nbits(0), nset(0), m_vec(arr, begin, end) {
-    if (m_vec.size() > 1) { // non-trivial size
+    if (m_vec.size() > 1 && m_vec.back() >= WAH64TAG) {
+        readTagged(); // one of the alternative serialized forms
+    }
+    else if (m_vec.size() > 1) { // non-trivial size
         if (m_vec.back() > 0) { // has active bits
             if (m_vec.back() < MAXBITS) {
                 active.nbits = m_vec.back();
@@ -166,7 +428,10 @@ ibis::bitvector::bitvector(const array_t<ibis::bitvector::word_t>& arr,
 /// space for the underlying vector.
 ibis::bitvector::bitvector(ibis::bitvector::word_t *buf, size_t nbuf)
     : nbits(0), nset(0), m_vec(buf, nbuf) {
-    if (m_vec.size() > 1) { // non-trivial size
+    if (m_vec.size() > 1 && m_vec.back() >= WAH64TAG) {
+        readTagged(); // one of the alternative serialized forms
+    }
+    else if (m_vec.size() > 1) { // non-trivial size
         if (m_vec.back() > 0) { // has active bits
             if (m_vec.back() < MAXBITS) {
                 active.nbits = m_vec.back();
@@ -841,7 +1106,8 @@ void ibis::bitvector::setBit(const ibis::bitvector::word_t ind, int val) {
 /// determine the values of bits 0 through i-1, therefore, it is highly
 /// recommended that you don't use this function.  A compressed bitmap data
 /// structure is simply not the right data structure to support random
-/// accesses!
+/// accesses!  For repeated accesses, build a skipIndex and use
+/// skipIndex::getBit.
 int ibis::bitvector::getBit(const ibis::bitvector::word_t ind) const {
     if (ind >= size()) {
         return 0;
@@ -1006,6 +1272,136 @@ void ibis::bitvector::subset(const ibis::bitvector& mask,
     }
 } // ibis::bitvector::subset
 
+/// Extract the bits in the range [begin, end) into the bitvector @c res.
+/// The result has (end - begin) bits unless the range extends past the
+/// end of this bitvector.  The fills and the literal words falling
+/// entirely in the range are copied a word at a time.
+///
+/// @note To extract many ranges from a large bitvector, use
+/// skipIndex::slice, which avoids scanning the words before @c begin.
+void ibis::bitvector::slice(word_t begin, word_t end,
+                            ibis::bitvector& res) const {
+    slice_words(0, 0, begin, end, res);
+} // ibis::bitvector::slice
+
+/// Extract the bits in the range [begin, end) into @c res, starting the
+/// scan at the word m_vec[off] whose first bit is at position @c pos.
+void ibis::bitvector::slice_words(word_t off, word_t pos, word_t begin,
+                                  word_t end, ibis::bitvector& res) const {
+    res.clear();
+    if (end > size())
+        end = size();
+    if (begin >= end)
+        return;
+
+    array_t<word_t>::const_iterator it = m_vec.begin() + off;
+    // skip the words before begin
+    while (it < m_vec.end()) {
+        const word_t len = (*it > ALLONES ? (*it & MAXCNT) * MAXBITS :
+                            MAXBITS);
+        if (pos + len > begin)
+            break;
+        pos += len;
+        ++ it;
+    }
+    for (; it < m_vec.end() && pos < end; ++ it) {
+        if (*it > ALLONES) { // a fill
+            const word_t len = (*it & MAXCNT) * MAXBITS;
+            const word_t lo = (pos >= begin ? pos : begin);
+            const word_t hi = (pos + len <= end ? pos + len : end);
+            res.appendFill(*it >= HEADER1, hi - lo);
+            pos += len;
+        }
+        else if (pos >= begin && pos + MAXBITS <= end) {
+            res.appendWord(*it);
+            pos += MAXBITS;
+        }
+        else { // part of a literal word
+            const word_t lo = (pos >= begin ? 0 : begin - pos);
+            const word_t hi = (pos + MAXBITS <= end ? MAXBITS : end - pos);
+            res.append_bits(((*it) >> (MAXBITS - hi)) &
+                            ((1U << (hi - lo)) - 1), hi - lo);
+            pos += MAXBITS;
+        }
+    }
+    if (pos < end) { // the remaining bits are in the active word
+        const word_t lo = (pos >= begin ? 0 : begin - pos);
+        const word_t hi = end - pos;
+        res.append_bits((active.val >> (active.nbits - hi)) &
+                        ((1U << (hi - lo)) - 1), hi - lo);
+    }
+} // ibis::bitvector::slice_words
+
+/// Build the table for bitvector @c b.  An entry is recorded for every
+/// @c stride compressed words.
+ibis::bitvector::skipIndex::skipIndex(const ibis::bitvector &b,
+                                      word_t stride) : bv(b) {
+    if (stride == 0)
+        stride = 1;
+    const word_t nw = bv.m_vec.size();
+    starts.reserve(nw / stride + 1);
+    offsets.reserve(nw / stride + 1);
+    word_t pos = 0;
+    for (word_t j = 0; j < nw; ++ j) {
+        if (j % stride == 0) {
+            starts.push_back(pos);
+            offsets.push_back(j);
+        }
+        const word_t w = bv.m_vec[j];
+        pos += (w > ALLONES ? (w & MAXCNT) * MAXBITS : MAXBITS);
+    }
+} // ibis::bitvector::skipIndex::skipIndex
+
+/// Find the last entry of the table at or before bit @c i.  Set @c off to
+/// its word offset and @c pos to the position of its first bit.
+void ibis::bitvector::skipIndex::locate(word_t i, word_t &off,
+                                        word_t &pos) const {
+    off = 0;
+    pos = 0;
+    if (starts.empty() || i < starts[0])
+        return;
+    array_t<word_t>::const_iterator it =
+        std::upper_bound(starts.begin(), starts.end(), i);
+    const size_t k = (it - starts.begin()) - 1;
+    off = offsets[k];
+    pos = starts[k];
+} // ibis::bitvector::skipIndex::locate
+
+/// Return the value of bit @c i.  It returns 0 if @c i is beyond the end
+/// of the bitvector.
+int ibis::bitvector::skipIndex::getBit(word_t i) const {
+    if (i >= bv.size())
+        return 0;
+
+    word_t off, pos;
+    locate(i, off, pos);
+    for (array_t<word_t>::const_iterator it = bv.m_vec.begin() + off;
+         it < bv.m_vec.end(); ++ it) {
+        if (*it > ALLONES) { // a fill
+            const word_t len = (*it & MAXCNT) * MAXBITS;
+            if (i < pos + len)
+                return (*it >= HEADER1);
+            pos += len;
+        }
+        else if (i < pos + MAXBITS) {
+            return ((*it >> (SECONDBIT - (i - pos))) & 1U);
+        }
+        else {
+            pos += MAXBITS;
+        }
+    }
+    return ((bv.active.val >> (bv.active.nbits - (i - pos) - 1)) & 1U);
+} // ibis::bitvector::skipIndex::getBit
+
+/// Extract the bits in the range [begin, end) into @c res.  The scan
+/// starts from the closest entry of the table.
+void ibis::bitvector::skipIndex::slice(word_t begin, word_t end,
+                                       ibis::bitvector &res) const {
+    word_t off, pos;
+    locate(begin, off, pos);
+    bv.slice_words(off, pos, begin, end, res);
+} // ibis::bitvector::skipIndex::slice
+
 /// Remove the bits in the range of [i, j).
 /// The bit positions are counted from 0.  The first position @c i is erased,
 /// but not the last position @c j.
@@ -1017,54 +1413,12 @@ void ibis::bitvector::erase(ibis::bitvector::word_t i,
 
     // use copy-and-swap approach, the result bitvector is res
     ibis::bitvector res;
-    if (i > 0) { // copy the leading part to res
-        const_iterator ip = const_cast<const ibis::bitvector*>(this)->begin();
-        ip += i;
-        array_t<word_t>::const_iterator cit = m_vec.begin();
-        while (cit < ip.it) {
-            res.m_vec.push_back(*cit);
-            ++ cit;
-        }
-        res.nbits = i - ip.ind;
-        if (ip.compressed) {
-            res.appendFill(ip.fillbit, ip.ind);
-        }
-        else {
-            res.active.val = (ip.literalvalue >> (MAXBITS-ip.ind));
-            res.active.nbits = ip.ind;
-        }
-    }
-
-    if (j < nbits) { // copy the back half of m_vec
-        const_iterator iq = const_cast<const ibis::bitvector*>(this)->begin();
-        iq += j;
-        // copy second half of iq.it
-        if (iq.compressed) {
-            res.appendFill(iq.fillbit, iq.nbits-iq.ind);
-            //for (word_t ii=iq.ind; ii<iq.nbits; ++ii) {
-            //res += iq.fillbit;
-            //}
-        }
-        else {
-            for (long ii=(iq.nbits-iq.ind-1); ii>=0; --ii) {
-                res += (1 & (iq.literalvalue >> ii));
-            }
-        }
-        // copy the remaining whole words
-        ++ (iq.it);
-        while (iq.it < m_vec.end()) {
-            res.appendWord(*(iq.it));
-            ++ (iq.it);
-        }
-        // copy the active word
-        for (long ii = ((long)active.nbits-1); ii >= 0; -- ii) {
-            res += (int) ((active.val >> ii) & 1);
-        }
-    }
-    else if (j < nbits+active.nbits) { // only something from active word
-        for (long ii = (long)(active.nbits-j+nbits-1); ii >= 0; -- ii) {
-            res += (int) ((active.val >> ii) & 1);
-        }
+    if (i > 0) // copy the leading part to res
+        slice(0, i, res);
+    if (j < size()) { // append the trailing part
+        ibis::bitvector tail;
+        slice(j, size(), tail);
+        res += tail;
     }
     if (size() != res.size()+(j-i)) {
         LOGGER(ibis::gVerbose >= 0)
@@ -1113,7 +1467,7 @@ ibis::bitvector::count(const ibis::bitvector& mask) const {
         cnt = mask.nset + cnt_ones(active.val & mask.active.val);
     }
     else if (mask.all1s()) {
-        if (nbits == 0 && ! m_vec.empty())
+        if (nset == 0 && ! m_vec.empty())
             nbits = do_cnt();
         cnt = nset + cnt_ones(active.val & mask.active.val);
     }
@@ -1946,6 +2300,208 @@ bool ibis::bitvector::operator<(const ibis::bitvector &rhs) const {
     return (active.val < rhs.active.val);
 } // ibis::bitvector::operator<
 
+/// Replace the content of this bitvector with the bitwise OR of all
+/// bitvectors in @c pile.  Instead of combining the bitvectors two at a
+/// time, all of them are scanned together and the result is produced in
+/// a single pass without any intermediate bitvector.  The inputs sitting
+/// in fills of 0s are kept out of the way, so the cost is proportional to
+/// the number of literal words and fills of 1s in the input bitvectors.
+///
+/// @note Null pointers in @c pile are skipped.  The array @c pile may
+/// contain this bitvector itself.
+void ibis::bitvector::orMany(const array_t<ibis::bitvector*>& pile) {
+    (void) combine_many(pile, 1, this);
+} // ibis::bitvector::orMany
+
+/// Replace the content of this bitvector with the bitwise AND of all
+/// bitvectors in @c pile.  This is the counterpart of orMany, where the
+/// inputs sitting in fills of 1s are kept out of the way.
+///
+/// @note Null pointers in @c pile are skipped.  The array @c pile may
+/// contain this bitvector itself.
+void ibis::bitvector::andMany(const array_t<ibis::bitvector*>& pile) {
+    (void) combine_many(pile, 0, this);
+} // ibis::bitvector::andMany
+
+/// Count the number of bits set in the bitwise OR of all bitvectors in @c
+/// pile without producing the result.  This walks the inputs the same way
+/// as orMany, but the fills of 1s and the literal words are only counted.
+ibis::bitvector::word_t
+ibis::bitvector::countOr(const array_t<ibis::bitvector*>& pile) {
+    return combine_many(pile, 1, 0);
+} // ibis::bitvector::countOr
+
+/// Count the number of bits set in the bitwise AND of all bitvectors in
+/// @c pile without producing the result.
+ibis::bitvector::word_t
+ibis::bitvector::countAnd(const array_t<ibis::bitvector*>& pile) {
+    return combine_many(pile, 0, 0);
+} // ibis::bitvector::countAnd
+
+/// The N-way merge behind orMany (@c fillBit = 1) and andMany (@c fillBit
+/// = 0).  A fill of @c fillBit in any input determines the result, the
+/// fills of the other bit do not change the result.  The cursors are kept
+/// on a heap ordered by the position of their next run of interest.
+///
+/// The result is placed in @c out.  If @c out is nil, the result is not
+/// produced, only the number of bits set in it is computed.  The return
+/// value is the number of bits set in the result when @c out is nil, and
+/// 0 otherwise.
+ibis::bitvector::word_t
+ibis::bitvector::combine_many(const array_t<ibis::bitvector*>& pile,
+                              int fillBit, ibis::bitvector* out) {
+    const ibis::bitvector *first = 0;
+    uint32_t nin = 0;
+    bool samesize = true;
+    for (uint32_t i = 0; i < pile.size(); ++ i) {
+        if (pile[i] != 0) {
+            ++ nin;
+            if (first == 0)
+                first = pile[i];
+            else if (pile[i]->size() != first->size())
+                samesize = false;
+        }
+    }
+    if (first == 0) {
+        if (out != 0)
+            out->clear();
+        return 0;
+    }
+    if (nin == 1 || ! samesize) {
+        // fall back to the pairwise operations, which also take care of
+        // the bitvectors of different sizes
+        ibis::bitvector res(*first);
+        for (uint32_t i = 0; i < pile.size(); ++ i) {
+            if (pile[i] != 0 && pile[i] != first) {
+                if (fillBit != 0)
+                    res |= *(pile[i]);
+                else
+                    res &= *(pile[i]);
+            }
+        }
+        if (out == 0)
+            return res.cnt();
+        out->swap(res);
+        return 0;
+    }
+
+    const word_t nw = first->size() / MAXBITS; // number of whole words
+    const word_t nact = first->active.nbits;
+    word_t act = (fillBit != 0 ? 0 : (1U << nact) - 1);
+    std::vector<many_cursor> cur;
+    std::vector<unsigned> heap;
+    cur.reserve(nin);
+    heap.reserve(nin);
+    for (uint32_t i = 0; i < pile.size(); ++ i) {
+        if (pile[i] == 0) continue;
+
+        if (fillBit != 0)
+            act |= pile[i]->active.val;
+        else
+            act &= pile[i]->active.val;
+        many_cursor c;
+        c.it = pile[i]->m_vec.begin();
+        c.end = pile[i]->m_vec.end();
+        c.start = 0;
+        c.nWords = 0;
+        c.isFill = false;
+        if (c.load(fillBit)) {
+            heap.push_back(cur.size());
+            cur.push_back(c);
+        }
+    }
+    const many_cursor_greater cmp(cur);
+    std::make_heap(heap.begin(), heap.end(), cmp);
+
+    ibis::bitvector res;
+    word_t nset1 = 0; // the number of 1s in the result, if out is nil
+    std::vector<unsigned> at; // the cursors at the current position
+    at.reserve(nin);
+    word_t pos = 0; // the number of words in the result
+    while (! heap.empty()) {
+        const word_t next = cur[heap.front()].start;
+        if (next > pos) { // no input affects the result before next
+            if (out != 0)
+                res.append_fill_words(! fillBit, next - pos);
+            else if (fillBit == 0)
+                nset1 += (next - pos) * MAXBITS;
+            pos = next;
+        }
+
+        // take out all cursors at pos, and find the end of the longest
+        // fill of fillBit among them
+        word_t stop = pos;
+        at.clear();
+        while (! heap.empty() && cur[heap.front()].start == pos) {
+            const many_cursor &c = cur[heap.front()];
+            if (c.isFill && c.start + c.nWords > stop)
+                stop = c.start + c.nWords;
+            at.push_back(heap.front());
+            std::pop_heap(heap.begin(), heap.end(), cmp);
+            heap.pop_back();
+        }
+
+        if (stop > pos) { // the result is a fill of fillBit
+            // the fills may overlap with the runs that start later
+            while (! heap.empty() && cur[heap.front()].start < stop) {
+                const many_cursor &c = cur[heap.front()];
+                if (c.isFill && c.start + c.nWords > stop)
+                    stop = c.start + c.nWords;
+                at.push_back(heap.front());
+                std::pop_heap(heap.begin(), heap.end(), cmp);
+                heap.pop_back();
+            }
+            if (out != 0)
+                res.append_fill_words(fillBit, stop - pos);
+            else if (fillBit != 0)
+                nset1 += (stop - pos) * MAXBITS;
+            pos = stop;
+            for (unsigned j = 0; j < at.size(); ++ j) {
+                if (cur[at[j]].advance(pos, fillBit)) {
+                    heap.push_back(at[j]);
+                    std::push_heap(heap.begin(), heap.end(), cmp);
+                }
+            }
+        }
+        else { // all cursors at pos are on literal words
+            word_t w = (fillBit != 0 ? 0 : ALLONES);
+            for (unsigned j = 0; j < at.size(); ++ j) {
+                many_cursor &c = cur[at[j]];
+                if (fillBit != 0)
+                    w |= *(c.it);
+                else
+                    w &= *(c.it);
+                ++ c.start;
+                ++ c.it;
+                if (c.load(fillBit)) {
+                    heap.push_back(at[j]);
+                    std::push_heap(heap.begin(), heap.end(), cmp);
+                }
+            }
+            if (out != 0) {
+                res.active.val = w;
+                res.append_active();
+            }
+            else {
+                nset1 += res.cnt_ones(w);
+            }
+            ++ pos;
+        }
+    }
+    if (out == 0) {
+        if (nw > pos && fillBit == 0)
+            nset1 += (nw - pos) * MAXBITS;
+        return nset1 + res.cnt_ones(act);
+    }
+
+    if (nw > pos)
+        res.append_fill_words(! fillBit, nw - pos);
+    res.active.val = act;
+    res.active.nbits = nact;
+    out->swap(res);
+    return 0;
+} // ibis::bitvector::combine_many
+
 /// Print each word in bitvector on a line.
 std::ostream& ibis::bitvector::print(std::ostream& o) const {
     if (! m_vec.empty()) {
@@ -2036,7 +2592,10 @@ void ibis::bitvector::read(const char * fn) {
         return;
     }
 
-    if (m_vec.size() > 1) { // read a file correctly
+    if (m_vec.size() > 1 && m_vec.back() >= WAH64TAG) {
+        readTagged(); // one of the alternative serialized forms
+    }
+    else if (m_vec.size() > 1) { // read a file correctly
         if (m_vec.back() > 0) { // has active bits
             active.nbits = m_vec.back();
             m_vec.pop_back();
@@ -2277,6 +2836,210 @@ void ibis::bitvector::write(int out) const {
 #endif
 } // ibis::bitvector::write
 
+/// Write the bit vector to an open file in the 64-bit WAH format.  The
+/// bits are regrouped into 63-bit literal words and 64-bit fill words as
+/// in ibis::bitvector64, followed by the word WAH64TAG.  The constructors
+/// and read recognize the tag and convert the bits back to this format,
+/// so the result can be used wherever the output of write is expected.
+void ibis::bitvector::writeWAH64(int out) const {
+    if (out < 0)
+        return;
+
+    array_t<ibis::bitvector64::word_t> arr;
+    ibis::bitvector64(*this).write(arr);
+    const long n = sizeof(ibis::bitvector64::word_t) * arr.size();
+    long ierr = UnixWrite(out, (const void*)arr.begin(), n);
+    ierr += UnixWrite(out, (const void*)&WAH64TAG, sizeof(word_t));
+    if (ierr != n + (long)sizeof(word_t)) {
+        LOGGER(ibis::gVerbose > 0)
+            << "Warning -- bitvector::writeWAH64 only wrote " << ierr
+            << " out of " << n + sizeof(word_t) << " bytes to open file "
+            << out;
+        throw "bitvector::writeWAH64 failed to write all bytes"
+            IBIS_FILE_LINE;
+    }
+} // ibis::bitvector::writeWAH64
+
+/// Write the bit vector to an open file in the most compact of three
+/// forms: the usual WAH words as produced by write, a sorted list of the
+/// positions of 1s followed by the word ARRAYTAG, or a list of runs of 1s
+/// (the starting position and the length of each run) followed by the
+/// word RUNTAG.  The last two forms are much smaller than the WAH words
+/// for bit vectors with a few scattered 1s or a few long runs of 1s,
+/// which are common in the indexes of high-cardinality columns.  The
+/// constructors and read recognize the tags and convert the content back
+/// to WAH words.
+void ibis::bitvector::writeHybrid(int out) const {
+    if (out < 0)
+        return;
+
+    const word_t nwah = m_vec.size() + 1 + (active.nbits > 0);
+    const word_t nset1 = cnt();
+    const word_t nruns = numRuns();
+    if (nset1 + 2 >= nwah && 2 * nruns + 2 >= nwah) {
+        write(out);
+        return;
+    }
+
+    array_t<word_t> arr;
+    word_t tag;
+    if (nset1 <= 2 * nruns) {
+        tag = ARRAYTAG;
+        arr.reserve(nset1 + 2);
+        for (indexSet is = firstIndexSet(); is.nIndices() > 0; ++ is) {
+            const word_t *ii = is.indices();
+            if (is.isRange()) {
+                for (word_t j = ii[0]; j < ii[1]; ++ j)
+                    arr.push_back(j);
+            }
+            else {
+                for (word_t j = 0; j < is.nIndices(); ++ j)
+                    arr.push_back(ii[j]);
+            }
+        }
+    }
+    else {
+        tag = RUNTAG;
+        arr.reserve(2 * nruns + 2);
+        word_t start = 0, last = 0; // the current run is [start, last)
+        for (indexSet is = firstIndexSet(); is.nIndices() > 0; ++ is) {
+            const word_t *ii = is.indices();
+            const word_t nind = (is.isRange() ? 1 : is.nIndices());
+            for (word_t j = 0; j < nind; ++ j) {
+                const word_t b0 = (is.isRange() ? ii[0] : ii[j]);
+                const word_t b1 = (is.isRange() ? ii[1] : ii[j] + 1);
+                if (b0 == last) {
+                    last = b1;
+                }
+                else {
+                    if (last > start) {
+                        arr.push_back(start);
+                        arr.push_back(last - start);
+                    }
+                    start = b0;
+                    last = b1;
+                }
+            }
+        }
+        if (last > start) {
+            arr.push_back(start);
+            arr.push_back(last - start);
+        }
+    }
+    arr.push_back(size());
+    arr.push_back(tag);
+
+    const long n = sizeof(word_t) * arr.size();
+    const long ierr = UnixWrite(out, (const void*)arr.begin(), n);
+    if (ierr != n) {
+        LOGGER(ibis::gVerbose > 0)
+            << "Warning -- bitvector::writeHybrid only wrote " << ierr
+            << " out of " << n << " bytes to open file " << out;
+        throw "bitvector::writeHybrid failed to write all bytes"
+            IBIS_FILE_LINE;
+    }
+} // ibis::bitvector::writeHybrid
+
+/// Count the number of runs of 1s.  Two runs are separated by at least
+/// one 0 bit.
+ibis::bitvector::word_t ibis::bitvector::numRuns() const {
+    word_t nr = 0;
+    word_t prev = 0; // the last bit of the previous word
+    for (array_t<word_t>::const_iterator it = m_vec.begin();
+         it != m_vec.end(); ++ it) {
+        if (*it > ALLONES) {
+            if (*it >= HEADER1) {
+                nr += (prev == 0);
+                prev = 1;
+            }
+            else {
+                prev = 0;
+            }
+        }
+        else {
+            // a 1 starts a run if the bit before it is 0; the bits are
+            // ordered from the most significant one
+            nr += cnt_ones(*it & ~((*it >> 1) | (prev << (MAXBITS-1))));
+            prev = (*it & 1);
+        }
+    }
+    if (active.nbits > 0) {
+        const word_t w = (active.val << (MAXBITS - active.nbits));
+        nr += cnt_ones(w & ~((w >> 1) | (prev << (MAXBITS-1))));
+    }
+    return nr;
+} // ibis::bitvector::numRuns
+
+/// Decode the content of m_vec written by writeWAH64 or writeHybrid.  The
+/// last word of m_vec identifies the form used, the words in m_vec are
+/// replaced with the equivalent WAH words.
+void ibis::bitvector::readTagged() {
+    if (m_vec.back() == WAH64TAG) {
+        readWAH64();
+        return;
+    }
+
+    array_t<word_t> raw;
+    raw.swap(m_vec); // m_vec may be a read-only view of a file
+    clear();
+    const word_t tag = raw.back();
+    const word_t nb = raw[raw.size()-2];
+    array_t<word_t>::const_iterator it = raw.begin();
+    array_t<word_t>::const_iterator end = raw.end() - 2;
+    word_t pos = 0; // number of bits decoded so far
+    if (tag == ARRAYTAG) {
+        for (; it < end && *it >= pos && *it < nb; ++ it) {
+            appendFill(0, *it - pos);
+            operator+=(1);
+            pos = *it + 1;
+        }
+    }
+    else if (tag == RUNTAG && ((end - it) & 1) == 0) {
+        for (; it < end && it[0] >= pos && it[0] <= nb && it[1] <= nb - it[0];
+             it += 2) {
+            appendFill(0, it[0] - pos);
+            appendFill(1, it[1]);
+            pos = it[0] + it[1];
+        }
+    }
+    else {
+        LOGGER(ibis::gVerbose > 0)
+            << "Warning -- the serialized version of bitvector "
+            "contains an unexpected last word (" << tag << ')';
+        return;
+    }
+    if (it < end) {
+        LOGGER(ibis::gVerbose > 0)
+            << "Warning -- bitvector::readTagged found an out of order "
+            "position (" << *it << ") in a serialized bitvector of " << nb
+            << " bits";
+        clear();
+        return;
+    }
+    appendFill(0, nb - pos);
+} // ibis::bitvector::readTagged
+
+/// Decode the content of m_vec written by writeWAH64.  The words in m_vec
+/// are replaced with the equivalent 32-bit WAH words.
+void ibis::bitvector::readWAH64() {
+    array_t<word_t> raw;
+    raw.swap(m_vec); // m_vec may be a read-only view of a file
+    clear();
+    if ((raw.size() & 1) == 0) {
+        LOGGER(ibis::gVerbose > 0)
+            << "Warning -- bitvector::readWAH64 expects an odd number of "
+            "words, but got " << raw.size();
+        return;
+    }
+
+    const size_t nw = (raw.size() - 1) / 2;
+    array_t<ibis::bitvector64::word_t> arr(nw);
+    (void) memcpy(arr.begin(), raw.begin(),
+                  nw * sizeof(ibis::bitvector64::word_t));
+    ibis::bitvector64 tmp(arr);
+    tmp.copyTo(*this);
+} // ibis::bitvector::readWAH64
+
 /// Write the bit vector to an array_t<word_t>.  The serialized version
 /// of this bit vector may be passed to another I/O function or sent
 /// through networks.
@@ -2415,6 +3178,26 @@ ibis::bitvector::count_c1(const ibis::bitvector& mask) const {
     return cnt;
 } // ibis::bitvector::count_c1
 
+/// Combine @c n pairs of literal words from @c a and @c b with the
+/// operation @c op and append the results.  The active word is assumed to
+/// be empty.  Results that are all 0s or all 1s are merged into fills by
+/// append_active.
+void ibis::bitvector::append_literals(int op, const word_t* a,
+                                      const word_t* b, word_t n) {
+    word_t buf[128];
+    while (n > 0) {
+        const word_t nb = (n <= 128 ? n : 128);
+        ibis_wah_block(op, buf, a, b, nb);
+        for (word_t j = 0; j < nb; ++ j) {
+            active.val = buf[j];
+            append_active();
+        }
+        a += nb;
+        b += nb;
+        n -= nb;
+    }
+} // ibis::bitvector::append_literals
+
 // bitwise and (&) operation -- both operands may contain compressed words
 void ibis::bitvector::and_c2(const ibis::bitvector& rhs,
                              ibis::bitvector& res) const {
@@ -2455,6 +3238,8 @@ void ibis::bitvector::and_c2(const ibis::bitvector& rhs,
     }
     else if (m_vec.size() > 1) {
         run x, y;
+        word_t nlit = 0; // number of literal words in the current run
+        const word_t *xlit = 0;
         x.it = m_vec.begin();
         y.it = rhs.m_vec.begin();
         while (x.it < m_vec.end()) { // go through all words in m_vec
@@ -2505,12 +3290,24 @@ void ibis::bitvector::and_c2(const ibis::bitvector& rhs,
                     y.it += (y.nWords == 0);
                 }
             }
+            else if (nlit >= 32) { // the rest of long runs of literals
+                const size_t nl = ibis_wah_literals
+                    (x.it, m_vec.end(), y.it, rhs.m_vec.end());
+                res.append_literals(IBIS_WAH_AND, x.it, y.it, nl);
+                x.nWords = 0;
+                y.nWords = 0;
+                x.it += nl;
+                y.it += nl;
+                nlit = 0;
+            }
             else { // both words are not compressed
                 res.active.val = *(x.it) & *(y.it);
                 res.append_active();
                 x.nWords = 0;
                 y.nWords = 0;
+                nlit = (x.it == xlit ? nlit + 1 : 0);
                 ++ x.it;
+                xlit = x.it;
                 ++ y.it;
             }
         } // while (x.it < m_vec.end())
@@ -2657,6 +3454,8 @@ void ibis::bitvector::and_d2(const ibis::bitvector& rhs,
     }
     else if (m_vec.size() > 1) { // more than one word in *this
         run x, y;
+        word_t nlit = 0; // number of literal words in the current run
+        const word_t *xlit = 0;
         res.nset = 0;
         x.it = m_vec.begin();
         y.it = rhs.m_vec.begin();
@@ -2701,11 +3500,24 @@ void ibis::bitvector::and_d2(const ibis::bitvector& rhs,
                     y.it += (y.nWords == 0);
                 }
             }
+            else if (nlit >= 32) { // the rest of long runs of literals
+                const size_t nl = ibis_wah_literals
+                    (x.it, m_vec.end(), y.it, rhs.m_vec.end());
+                ibis_wah_block(IBIS_WAH_AND, ir, x.it, y.it, nl);
+                x.nWords = 0;
+                y.nWords = 0;
+                x.it += nl;
+                y.it += nl;
+                ir += nl;
+                nlit = 0;
+            }
             else { // both words are not compressed
                 *ir = *x.it & *y.it;
                 x.nWords = 0;
                 y.nWords = 0;
+                nlit = (x.it == xlit ? nlit + 1 : 0);
                 ++ x.it;
+                xlit = x.it;
                 ++ y.it;
                 ++ ir;
             }
@@ -2776,18 +3588,28 @@ void ibis::bitvector::and_d1(const ibis::bitvector& rhs) {
         array_t<word_t>::iterator i0 = m_vec.begin();
         array_t<word_t>::const_iterator i1 = rhs.m_vec.begin();
         word_t s0;
+        word_t nlit = 0; // number of literal words in the current run
         nset = 0;
         while (i1 != rhs.m_vec.end()) { // go through all words in m_vec
             if (*i1 > ALLONES) { // i1 is compressed
+                nlit = 0;
                 s0 = ((*i1) & MAXCNT);
                 if ((*i1) < HEADER1) { // set literal words to zero
                     memset(i0, 0, sizeof(word_t)*s0);
                 }
                 i0 += s0;
             }
-            else { // both words are not compressed
+            else if (nlit >= 32) { // the rest of a long run of literals
+                const size_t nl = ibis_wah_literals(i1, rhs.m_vec.end());
+                ibis_wah_block(IBIS_WAH_AND, i0, i0, i1, nl);
+                i0 += nl;
+                i1 += nl - 1;
+                nlit = 0;
+            }
+            else { // a single literal word
                 *i0 &= *i1;
                 ++ i0;
+                ++ nlit;
             }
             ++ i1;
         } // while (i1 != rhs.m_vec.end())
@@ -2814,12 +3636,8 @@ void ibis::bitvector::and_d1(const ibis::bitvector& rhs) {
 void ibis::bitvector::and_c0(const ibis::bitvector& rhs) {
     nset = 0;
     m_vec.nosharing(); // make sure *this is not shared!
-    array_t<word_t>::iterator i0 = m_vec.begin();
-    array_t<word_t>::const_iterator i1 = rhs.m_vec.begin();
-    while (i0 != m_vec.end()) { // go through all words in m_vec
-        *i0 &= *i1;
-        i0++; i1++;
-    } // while (i0 != m_vec.end())
+    ibis_wah_block(IBIS_WAH_AND, m_vec.begin(), m_vec.begin(),
+                   rhs.m_vec.begin(), m_vec.size());
 
     // the last thing -- work with the two active_words
     active.val &= rhs.active.val;
@@ -2869,6 +3687,8 @@ void ibis::bitvector::or_c2(const ibis::bitvector& rhs,
     }
     else if (m_vec.size() > 1) {
         run x, y;
+        word_t nlit = 0; // number of literal words in the current run
+        const word_t *xlit = 0;
         x.it = m_vec.begin();
         y.it = rhs.m_vec.begin();
         while (x.it < m_vec.end()) {    // go through all words in m_vec
@@ -2923,12 +3743,24 @@ void ibis::bitvector::or_c2(const ibis::bitvector& rhs,
                     y.it += (y.nWords == 0);
                 }
             }
+            else if (nlit >= 32) { // the rest of long runs of literals
+                const size_t nl = ibis_wah_literals
+                    (x.it, m_vec.end(), y.it, rhs.m_vec.end());
+                res.append_literals(IBIS_WAH_OR, x.it, y.it, nl);
+                x.nWords = 0;
+                y.nWords = 0;
+                x.it += nl;
+                y.it += nl;
+                nlit = 0;
+            }
             else { // both words are not compressed
                 res.active.val = *x.it | *y.it;
                 res.append_active();
                 x.nWords = 0;
                 y.nWords = 0;
+                nlit = (x.it == xlit ? nlit + 1 : 0);
                 ++ x.it;
+                xlit = x.it;
                 ++ y.it;
             }
         } // while (x.it < m_vec.end())
@@ -3092,6 +3924,8 @@ void ibis::bitvector::or_d2(const ibis::bitvector& rhs,
     }
     else if (m_vec.size() > 1) { // more than one word in *this
         run x, y;
+        word_t nlit = 0; // number of literal words in the current run
+        const word_t *xlit = 0;
         res.nset = 0;
         x.it = m_vec.begin();
         y.it = rhs.m_vec.begin();
@@ -3131,11 +3965,24 @@ void ibis::bitvector::or_d2(const ibis::bitvector& rhs,
                     res.copy_fill(ir, y);
                 }
             }
+            else if (nlit >= 32) { // the rest of long runs of literals
+                const size_t nl = ibis_wah_literals
+                    (x.it, m_vec.end(), y.it, rhs.m_vec.end());
+                ibis_wah_block(IBIS_WAH_OR, ir, x.it, y.it, nl);
+                x.nWords = 0;
+                y.nWords = 0;
+                x.it += nl;
+                y.it += nl;
+                ir += nl;
+                nlit = 0;
+            }
             else { // both words are not compressed
                 *ir = *x.it | *y.it;
                 x.nWords = 0;
                 y.nWords = 0;
+                nlit = (x.it == xlit ? nlit + 1 : 0);
                 ++ x.it;
+                xlit = x.it;
                 ++ y.it;
                 ++ ir;
             }
@@ -3206,9 +4053,11 @@ void ibis::bitvector::or_d1(const ibis::bitvector& rhs) {
         array_t<word_t>::iterator i0 = m_vec.begin();
         array_t<word_t>::const_iterator i1 = rhs.m_vec.begin();
         word_t s0;
+        word_t nlit = 0; // number of literal words in the current run
         nset = 0;
         while (i1 != rhs.m_vec.end()) { // go through all words in m_vec
             if (*i1 > ALLONES) { // i1 is compressed
+                nlit = 0;
                 s0 = ((*i1) & MAXCNT);
                 if ((*i1) >= HEADER1) { // the result is all ones
                     array_t<word_t>::const_iterator stp = i0 + s0;
@@ -3221,9 +4070,17 @@ void ibis::bitvector::or_d1(const ibis::bitvector& rhs) {
                     i0 += s0;
                 }
             }
-            else { // both words are not compressed
+            else if (nlit >= 32) { // the rest of a long run of literals
+                const size_t nl = ibis_wah_literals(i1, rhs.m_vec.end());
+                ibis_wah_block(IBIS_WAH_OR, i0, i0, i1, nl);
+                i0 += nl;
+                i1 += nl - 1;
+                nlit = 0;
+            }
+            else { // a single literal word
                 *i0 |= *i1;
                 ++ i0;
+                ++ nlit;
             }
             ++ i1;
         } // while (i1 != rhs.m_vec.end())
@@ -3257,12 +4114,8 @@ void ibis::bitvector::or_c0(const ibis::bitvector& rhs) {
     }
 #endif
     nset = 0;
-    array_t<word_t>::iterator i0 = m_vec.begin();
-    array_t<word_t>::const_iterator i1 = rhs.m_vec.begin();
-    while (i0 != m_vec.end()) { // go through all words in m_vec
-        *i0 |= *i1;
-        i0++; i1++;
-    } // while (i0 != m_vec.end())
+    ibis_wah_block(IBIS_WAH_OR, m_vec.begin(), m_vec.begin(),
+                   rhs.m_vec.begin(), m_vec.size());
 
     // the last thing -- work with the two active_words
     active.val |= rhs.active.val;
@@ -3281,6 +4134,8 @@ void ibis::bitvector::or_c0(const ibis::bitvector& rhs) {
 void ibis::bitvector::xor_c2(const ibis::bitvector& rhs,
                              ibis::bitvector& res) const {
     run x, y;
+    word_t nlit = 0; // number of literal words in the current run
+    const word_t *xlit = 0;
     res.clear();
     x.it = m_vec.begin();
     y.it = rhs.m_vec.begin();
@@ -3314,12 +4169,24 @@ void ibis::bitvector::xor_c2(const ibis::bitvector& rhs,
                 res.copy_runsn(x, y.nWords);
             y.it += (y.nWords == 0);
         }
+        else if (nlit >= 32) { // the rest of long runs of literals
+            const size_t nl = ibis_wah_literals
+                (x.it, m_vec.end(), y.it, rhs.m_vec.end());
+            res.append_literals(IBIS_WAH_XOR, x.it, y.it, nl);
+            x.nWords = 0;
+            y.nWords = 0;
+            x.it += nl;
+            y.it += nl;
+            nlit = 0;
+        }
         else { // both words are not compressed
             res.active.val = *x.it ^ *y.it;
             res.append_active();
             x.nWords = 0;
             y.nWords = 0;
+            nlit = (x.it == xlit ? nlit + 1 : 0);
             ++ x.it;
+            xlit = x.it;
             ++ y.it;
         }
     } // while (x.it < m_vec.end())
@@ -3441,6 +4308,8 @@ void ibis::bitvector::xor_d2(const ibis::bitvector& rhs,
     }
     else if (m_vec.size() > 1) { // more than one word in *this
         run x, y;
+        word_t nlit = 0; // number of literal words in the current run
+        const word_t *xlit = 0;
         res.nset = 0;
         x.it = m_vec.begin();
         y.it = rhs.m_vec.begin();
@@ -3479,11 +4348,24 @@ void ibis::bitvector::xor_d2(const ibis::bitvector& rhs,
                 }
                 y.it += (y.nWords == 0);
             }
+            else if (nlit >= 32) { // the rest of long runs of literals
+                const size_t nl = ibis_wah_literals
+                    (x.it, m_vec.end(), y.it, rhs.m_vec.end());
+                ibis_wah_block(IBIS_WAH_XOR, ir, x.it, y.it, nl);
+                x.nWords = 0;
+                y.nWords = 0;
+                x.it += nl;
+                y.it += nl;
+                ir += nl;
+                nlit = 0;
+            }
             else { // both words are not compressed
                 *ir = *x.it ^ *y.it;
                 x.nWords = 0;
                 y.nWords = 0;
+                nlit = (x.it == xlit ? nlit + 1 : 0);
                 ++ x.it;
+                xlit = x.it;
                 ++ y.it;
                 ++ ir;
             }
@@ -3554,10 +4436,12 @@ void ibis::bitvector::xor_d1(const ibis::bitvector& rhs) {
     else if (rhs.m_vec.size() > 1) {
         nset = 0;
         word_t s0;
+        word_t nlit = 0; // number of literal words in the current run
         array_t<word_t>::iterator i0 = m_vec.begin();
         array_t<word_t>::const_iterator i1 = rhs.m_vec.begin();
         while (i1 != rhs.m_vec.end()) { // go through all words in m_vec
             if (*i1 > ALLONES) { // i1 is compressed
+                nlit = 0;
                 s0 = ((*i1) & MAXCNT);
                 if ((*i1) >= HEADER1) { // the result is the complement of i0
                     array_t<word_t>::const_iterator stp = i0 + s0;
@@ -3570,9 +4454,17 @@ void ibis::bitvector::xor_d1(const ibis::bitvector& rhs) {
                     i0 += s0;
                 }
             }
-            else { // both words are not compressed
+            else if (nlit >= 32) { // the rest of a long run of literals
+                const size_t nl = ibis_wah_literals(i1, rhs.m_vec.end());
+                ibis_wah_block(IBIS_WAH_XOR, i0, i0, i1, nl);
+                i0 += nl;
+                i1 += nl - 1;
+                nlit = 0;
+            }
+            else { // a single literal word
                 *i0 ^= *i1;
                 ++ i0;
+                ++ nlit;
             }
             ++ i1;
         } // while (i1 != rhs.m_vec.end())
@@ -3599,12 +4491,8 @@ void ibis::bitvector::xor_d1(const ibis::bitvector& rhs) {
 void ibis::bitvector::xor_c0(const ibis::bitvector& rhs) {
     m_vec.nosharing(); // make sure *this is not shared!
     nset = 0;
-    array_t<word_t>::iterator i0 = m_vec.begin();
-    array_t<word_t>::const_iterator i1 = rhs.m_vec.begin();
-    while (i0 != m_vec.end()) { // go through all words in m_vec
-        *i0 ^= *i1;
-        i0++; i1++;
-    } // while (i0 != m_vec.end())
+    ibis_wah_block(IBIS_WAH_XOR, m_vec.begin(), m_vec.begin(),
+                   rhs.m_vec.begin(), m_vec.size());
 
     // the last thing -- work with the two active_words
     active.val ^= rhs.active.val;
@@ -3663,6 +4551,8 @@ void ibis::bitvector::minus_c2(const ibis::bitvector& rhs,
     }
     else if (m_vec.size() > 1) {
         run x, y;
+        word_t nlit = 0; // number of literal words in the current run
+        const word_t *xlit = 0;
         x.it = m_vec.begin();
         y.it = rhs.m_vec.begin();
         while (x.it < m_vec.end()) {    // go through all words in m_vec
@@ -3706,12 +4596,24 @@ void ibis::bitvector::minus_c2(const ibis::bitvector& rhs,
                     ++ y.it;
                 }
             }
+            else if (nlit >= 32) { // the rest of long runs of literals
+                const size_t nl = ibis_wah_literals
+                    (x.it, m_vec.end(), y.it, rhs.m_vec.end());
+                res.append_literals(IBIS_WAH_MINUS, x.it, y.it, nl);
+                x.nWords = 0;
+                y.nWords = 0;
+                x.it += nl;
+                y.it += nl;
+                nlit = 0;
+            }
             else { // both words are not compressed
                 res.active.val = *x.it & ~(*y.it);
                 res.append_active();
                 x.nWords = 0;
                 y.nWords = 0;
+                nlit = (x.it == xlit ? nlit + 1 : 0);
                 ++ x.it;
+                xlit = x.it;
                 ++ y.it;
             }
         } // while (x.it < m_vec.end())
@@ -3913,6 +4815,8 @@ void ibis::bitvector::minus_d2(const ibis::bitvector& rhs,
     }
     else if (m_vec.size() > 1) { // more than one word in *this
         run x, y;
+        word_t nlit = 0; // number of literal words in the current run
+        const word_t *xlit = 0;
         res.nset = 0;
         x.it = m_vec.begin();
         y.it = rhs.m_vec.begin();
@@ -3954,11 +4858,24 @@ void ibis::bitvector::minus_d2(const ibis::bitvector& rhs,
                     res.copy_fill(ir, y);
                 }
             }
+            else if (nlit >= 32) { // the rest of long runs of literals
+                const size_t nl = ibis_wah_literals
+                    (x.it, m_vec.end(), y.it, rhs.m_vec.end());
+                ibis_wah_block(IBIS_WAH_MINUS, ir, x.it, y.it, nl);
+                x.nWords = 0;
+                y.nWords = 0;
+                x.it += nl;
+                y.it += nl;
+                ir += nl;
+                nlit = 0;
+            }
             else { // both words are not compressed
                 *ir = *x.it & ~*y.it;
                 x.nWords = 0;
                 y.nWords = 0;
+                nlit = (x.it == xlit ? nlit + 1 : 0);
                 ++ x.it;
+                xlit = x.it;
                 ++ y.it;
                 ++ ir;
             }
@@ -4023,19 +4940,29 @@ void ibis::bitvector::minus_d1(const ibis::bitvector& rhs) {
     else if (rhs.m_vec.size() > 1) {
         nset = 0;
         word_t s0;
+        word_t nlit = 0; // number of literal words in the current run
         array_t<word_t>::iterator i0 = m_vec.begin();
         array_t<word_t>::const_iterator i1 = rhs.m_vec.begin();
         while (i1 != rhs.m_vec.end()) { // go through all words in m_vec
             if (*i1 > ALLONES) { // i1 is compressed
+                nlit = 0;
                 s0 = ((*i1) & MAXCNT);
                 if ((*i1) >= HEADER1) { // the result is 0
                     memset(i0, 0, sizeof(word_t)*s0);
                 }
                 i0 += s0;
             }
-            else { // both words are not compressed
+            else if (nlit >= 32) { // the rest of a long run of literals
+                const size_t nl = ibis_wah_literals(i1, rhs.m_vec.end());
+                ibis_wah_block(IBIS_WAH_MINUS, i0, i0, i1, nl);
+                i0 += nl;
+                i1 += nl - 1;
+                nlit = 0;
+            }
+            else { // a single literal word
                 *i0 &= ~*i1;
                 ++ i0;
+                ++ nlit;
             }
             ++ i1;
         } // while (i1 != rhs.m_vec.end())
@@ -4062,13 +4989,8 @@ void ibis::bitvector::minus_d1(const ibis::bitvector& rhs) {
 void ibis::bitvector::minus_c0(const ibis::bitvector& rhs) {
     nset = 0;
     m_vec.nosharing(); // make sure *this is not shared!
-    array_t<word_t>::iterator i0 = m_vec.begin();
-    array_t<word_t>::const_iterator i1 = rhs.m_vec.begin();
-    while (i0 != m_vec.end()) { // go through all words in m_vec
-        *i0 &= ~(*i1);
-        i0++;
-        i1++;
-    } // while (i0 != m_vec.end())
+    ibis_wah_block(IBIS_WAH_MINUS, m_vec.begin(), m_vec.begin(),
+                   rhs.m_vec.begin(), m_vec.size());
 
     // the last thing -- work with the two active_words
     active.val &= ~(rhs.active.val);
@@ -4589,6 +5511,189 @@ ibis::bitvector::indexSet& ibis::bitvector::indexSet::operator++() {
     return *this;
 } // ibis::bitvector::indexSet::operator++
 
+/// The number of leading zero bits in a nonzero word.
+static inline unsigned ibis_wah_clz(ibis::bitvector::word_t w) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clz(w);
+#else
+    unsigned n = 0;
+    while ((w & 0x80000000U) == 0) {
+        ++ n;
+        w <<= 1;
+    }
+    return n;
+#endif
+} // ibis_wah_clz
+
+/// Start decoding the bitvector @c bv from its first bit.
+void ibis::bitvector::decoder::init(const ibis::bitvector &bv) {
+    it = bv.m_vec.begin();
+    end = bv.m_vec.end();
+    active = &(bv.active);
+    next = 0;
+    first = 0;
+    last = 0;
+    base = 0;
+    lit = 0;
+} // ibis::bitvector::decoder::init
+
+/// Move to the next word containing any 1s.  Either sets the pending range
+/// [first, last) or the literal bits lit.  Returns false at the end of the
+/// bitvector.
+bool ibis::bitvector::decoder::load() {
+    while (it < end) {
+        const word_t w = *it;
+        ++ it;
+        if (w > ALLONES) { // a fill
+            const word_t len = (w & MAXCNT) * MAXBITS;
+            if (w >= HEADER1) {
+                first = next;
+                last = next + len;
+                next += len;
+                return true;
+            }
+            next += len;
+        }
+        else if (w == ALLONES) {
+            first = next;
+            last = next + MAXBITS;
+            next += MAXBITS;
+            return true;
+        }
+        else if (w != 0) {
+            base = next;
+            lit = w;
+            next += MAXBITS;
+            return true;
+        }
+        else {
+            next += MAXBITS;
+        }
+    }
+    if (active != 0) {
+        const active_word *act = active;
+        active = 0;
+        if (act->nbits > 0 && act->val != 0) {
+            // line up the first bit of the active word with the first bit
+            // of a literal word
+            base = next;
+            lit = (act->val << (MAXBITS - act->nbits));
+            next += act->nbits;
+            return true;
+        }
+    }
+    return false;
+} // ibis::bitvector::decoder::load
+
+/// Write the positions of the next (at most) @c nbuf bits that are 1 to @c
+/// buf.  Returns the number of positions written.  A return value of 0
+/// indicates the end of the bitvector.
+ibis::bitvector::word_t
+ibis::bitvector::decoder::positions(word_t *buf, word_t nbuf) {
+    word_t cnt = 0;
+    while (cnt < nbuf) {
+        if (first < last) { // a run of 1s
+            word_t stop = last;
+            if (stop - first > nbuf - cnt)
+                stop = first + (nbuf - cnt);
+            for (word_t j = first; j < stop; ++ j, ++ cnt)
+                buf[cnt] = j;
+            first = stop;
+        }
+        else if (lit != 0) { // the bit at 2^30 is the first of the word
+            while (lit != 0 && cnt < nbuf) {
+                const unsigned z = ibis_wah_clz(lit);
+                buf[cnt] = base + z - 1;
+                ++ cnt;
+                lit ^= (0x80000000U >> z);
+            }
+        }
+        else if (! load()) {
+            break;
+        }
+    }
+    return cnt;
+} // ibis::bitvector::decoder::positions
+
+/// Write the next (at most) @c nbuf ranges of bits that are 1 to @c starts
+/// and @c ends.  The bits in range j are [starts[j], ends[j]).  Returns the
+/// number of ranges written.  A return value of 0 indicates the end of the
+/// bitvector.
+ibis::bitvector::word_t
+ibis::bitvector::decoder::ranges(word_t *starts, word_t *ends, word_t nbuf) {
+    word_t cnt = 0;
+    if (nbuf == 0)
+        return cnt;
+    while (true) {
+        if (first < last) { // a run of 1s
+            if (cnt > 0 && ends[cnt-1] == first) {
+                ends[cnt-1] = last;
+            }
+            else if (cnt < nbuf) {
+                starts[cnt] = first;
+                ends[cnt] = last;
+                ++ cnt;
+            }
+            else {
+                break;
+            }
+            first = last;
+        }
+        else if (lit != 0) {
+            // the leading zeros of lit give the start of the next run of
+            // 1s, and the leading zeros of the complement of the
+            // remaining bits give its length
+            const unsigned z = ibis_wah_clz(lit);
+            const unsigned len = ibis_wah_clz(~(lit << z));
+            const word_t s0 = base + z - 1;
+            if (cnt > 0 && ends[cnt-1] == s0) {
+                ends[cnt-1] = s0 + len;
+            }
+            else if (cnt < nbuf) {
+                starts[cnt] = s0;
+                ends[cnt] = s0 + len;
+                ++ cnt;
+            }
+            else {
+                break;
+            }
+            lit = (z + len < 32 ? lit & (0xFFFFFFFFU >> (z + len)) : 0);
+        }
+        else if (! load()) {
+            break;
+        }
+    }
+    return cnt;
+} // ibis::bitvector::decoder::ranges
+
+/// Append the current word to the output, followed by the words of 0s
+/// needed to reach the word containing position @c pos.
+void ibis::bitvector::builder::advance(word_t pos) {
+    out.active.val = word;
+    out.append_active();
+    start += MAXBITS;
+    word = 0;
+    const word_t nw = (pos - start) / MAXBITS;
+    if (nw > 0) {
+        out.append_fill_words(0, nw);
+        start += nw * MAXBITS;
+    }
+} // ibis::bitvector::builder::advance
+
+/// Complete the output bitvector with @c nb bits.  The positions marked
+/// with setBit must all be less than @c nb.  The builder should not be
+/// used after this function.
+void ibis::bitvector::builder::finish(word_t nb) {
+    if (nb >= start + MAXBITS) {
+        advance(nb);
+    }
+    const word_t nact = nb - start;
+    if (nact > 0) {
+        out.active.val = (word >> (MAXBITS - nact));
+        out.active.nbits = nact;
+    }
+} // ibis::bitvector::builder::finish
+
 /// \code
 /// res[jj*bits2.size()+ii] = bits1[jj] & bits2[ii]
 /// \endcode
@@ -8,6 +8,7 @@
 /// Definition of Word-Aligned Hybrid code.
 
 #include "array_t.h"	// alternative to std::vector
+#include <vector>	// std::vector
 
 #if defined(_MSC_VER) && defined(_WIN32)
 //disable warnings on extern before template instantiation
@@ -117,8 +118,17 @@ public:
     /// bitvector.
     bitvector* operator-(const bitvector&) const;
     bool operator<(const bitvector&) const;
+    ///@brief Perform bitwise OR on many bitvectors in one pass.
+    void orMany(const array_t<bitvector*>& pile);
+    ///@brief Perform bitwise AND on many bitvectors in one pass.
+    void andMany(const array_t<bitvector*>& pile);
+    ///@brief Count the bits set in the bitwise OR of many bitvectors.
+    static word_t countOr(const array_t<bitvector*>& pile);
+    ///@brief Count the bits set in the bitwise AND of many bitvectors.
+    static word_t countAnd(const array_t<bitvector*>& pile);
 
     void subset(const bitvector& mask, bitvector& res) const;
+    void slice(word_t begin, word_t end, bitvector& res) const;
     word_t count(const bitvector& mask) const;
 
     // I/O functions.
@@ -126,6 +136,8 @@ public:
     void write(const char *fn) const;
     void write(int fdes) const;
     void write(array_t<word_t>& arr) const;
+    void writeWAH64(int fdes) const;
+    void writeHybrid(int fdes) const;
 
     void compress();
     void decompress();
@@ -182,8 +194,20 @@ public:
     /// An iterator over the positions that are one.
     class pit;
 
+    /// Decode the positions that are one in batches.
+    class decoder;
+
+    /// Build a bitvector from positions that are one in increasing order.
+    class builder;
+
+    /// A sparse table for locating bit positions in the compressed words.
+    class skipIndex;
+
     // give accesses to some friends
     friend class indexSet;
+    friend class decoder;
+    friend class builder;
+    friend class skipIndex;
     friend class iterator;
     friend class const_iterator;
 
@@ -200,6 +224,9 @@ private:
     static const word_t HEADER1;
     static const word_t ALLONES;
     static const word_t MAXCNT;
+    static const word_t WAH64TAG;
+    static const word_t ARRAYTAG;
+    static const word_t RUNTAG;
 
     /// @brief The struct active_word stores the last few bits that do not
     /// fill a whole word.
@@ -259,8 +286,33 @@ private:
 	    }
 	};
     };
+    /// @brief A cursor over the runs of one input of orMany and andMany.
+    ///
+    /// It skips over the fills that do not affect the result, i.e., fills
+    /// of 0s for OR and fills of 1s for AND, and keeps the position of the
+    /// current run measured in words.
+    struct many_cursor {
+	array_t<word_t>::const_iterator it;
+	array_t<word_t>::const_iterator end;
+	word_t start; ///!< Position of the current run (in words).
+	word_t nWords;///!< Number of words left in the current run.
+	bool isFill;  ///!< Is the current run a fill?
+
+	inline bool load(int fillBit);
+	inline bool advance(word_t pos, int fillBit);
+    };
+    /// Order the cursors so that the one with the smallest position is
+    /// at the top of a heap.
+    struct many_cursor_greater {
+	const std::vector<many_cursor>& cur;
+	many_cursor_greater(const std::vector<many_cursor>& c) : cur(c) {}
+	bool operator()(unsigned i, unsigned j) const {
+	    return (cur[i].start > cur[j].start);
+	}
+    };
     friend struct run;
     friend struct active_word;
+    friend struct many_cursor;
 
     // member variables of bitvector class
     mutable word_t nbits;	///!< Number of bits in @c m_vec.
@@ -312,6 +364,16 @@ private:
     void copy_comp(array_t<word_t>& tmp) const;
     inline void append_active();
     inline void append_counter(int val, word_t cnt);
+    void append_literals(int op, const word_t* a, const word_t* b, word_t n);
+    inline void append_fill_words(int val, word_t cnt);
+    inline void append_bits(word_t v, word_t n);
+    void slice_words(word_t off, word_t pos, word_t begin, word_t end,
+		     bitvector& res) const;
+    static word_t combine_many(const array_t<bitvector*>& pile,
+                               int fillBit, bitvector* out);
+    void readTagged();
+    void readWAH64();
+    word_t numRuns() const;
     inline word_t cnt_ones(word_t) const; // number of ones in a word
     inline word_t cnt_bits(word_t) const; // number of bits in a word
     word_t do_cnt() const throw ();
@@ -541,6 +603,106 @@ private:
     ibis::bitvector::indexSet iset;
 }; // class ibis::bitvector::pit
 
+/// Decode the positions of the bits that are 1 into a buffer supplied by
+/// the caller.  Unlike indexSet, which produces the positions of one
+/// compressed word at a time, each call to positions or ranges fills as
+/// much of the buffer as possible.  The positions are extracted with one
+/// bit scan per bit that is 1, and the fills of 1s are produced without
+/// looking at individual bits.
+///
+/// The ranges mode produces the bits that are 1 as ranges [start, end),
+/// where consecutive bits that are 1 are merged into one range even if
+/// they come from different compressed words.  A range may still be split
+/// between two calls to ranges.
+///
+/// @note The bitvector must not be modified while it is being decoded.
+class ibis::bitvector::decoder {
+public:
+    decoder() : it(0), end(0), active(0), next(0), first(0), last(0),
+                base(0), lit(0) {}
+    explicit decoder(const ibis::bitvector &bv) {init(bv);}
+    void init(const ibis::bitvector &bv);
+
+    word_t positions(word_t *buf, word_t nbuf);
+    word_t ranges(word_t *starts, word_t *ends, word_t nbuf);
+
+private:
+    array_t<word_t>::const_iterator it;  ///!< The next word to decode.
+    array_t<word_t>::const_iterator end; ///!< The end of the words.
+    const active_word* active; ///!< The active word, nil once decoded.
+    word_t next;  ///!< The position of the first bit of the word at it.
+    word_t first; ///!< The first position of the pending range of 1s.
+    word_t last;  ///!< The end of the pending range of 1s.
+    word_t base;  ///!< The position of the first bit of lit.
+    word_t lit;   ///!< The bits of a literal word not yet decoded.
+
+    bool load();
+}; // class ibis::bitvector::decoder
+
+/// Build a bitvector one bit at a time from the positions of the bits
+/// that are 1.  The positions must be given in increasing order.  The bits
+/// of the current word are accumulated in a register and each word is
+/// appended to the output in compressed form as soon as it is complete,
+/// therefore the output never needs to be decompressed or compressed as a
+/// whole.  This is meant for scans that check the rows in order, where
+/// calling bitvector::setBit on every hit is expensive.
+///
+/// The output bitvector is cleared by the constructor and is not valid
+/// until finish is called.
+class ibis::bitvector::builder {
+public:
+    explicit builder(ibis::bitvector &bv) : out(bv), start(0), word(0) {
+	out.clear();
+    }
+
+    inline void setBit(word_t pos);
+    inline void setWord(word_t pos, word_t lit);
+    void finish(word_t nb);
+
+private:
+    ibis::bitvector &out; ///!< The bitvector being built.
+    word_t start; ///!< The position of the first bit of word.
+    word_t word;  ///!< The bits of the current word, first bit at 2^30.
+
+    void advance(word_t pos);
+
+    builder(const builder&); // no copying
+    builder& operator=(const builder&);
+}; // class ibis::bitvector::builder
+
+/// A sparse table that maps bit positions to the compressed words
+/// containing them.  The table records the first bit position of every
+/// stride-th compressed word, so that a bit can be located with a binary
+/// search followed by a scan of at most @c stride words, instead of a
+/// scan from the beginning of the bitvector.  This supports getBit in
+/// O(log n) time and the extraction of a range of rows with slice in time
+/// proportional to the size of the range, which in turn allows a large
+/// bitvector to be split into row-range segments for concurrent
+/// processing.
+///
+/// The table is built once by the constructor, and it refers to the
+/// bitvector it was built for.  It becomes invalid when the bitvector is
+/// modified.
+class ibis::bitvector::skipIndex {
+public:
+    explicit skipIndex(const ibis::bitvector &bv, word_t stride=128);
+
+    int getBit(word_t i) const;
+    void slice(word_t begin, word_t end, ibis::bitvector &res) const;
+    /// Number of entries in the table.
+    size_t size() const {return starts.size();}
+
+private:
+    const ibis::bitvector &bv; ///!< The bitvector indexed.
+    array_t<word_t> starts;    ///!< The first bit of the word at offsets[k].
+    array_t<word_t> offsets;   ///!< Offsets of words in bv.m_vec.
+
+    void locate(word_t i, word_t &off, word_t &pos) const;
+
+    skipIndex(const skipIndex&); // no copying
+    skipIndex& operator=(const skipIndex&);
+}; // class ibis::bitvector::skipIndex
+
 /// Explicitly set the size of the bitvector.  This is intended to be used
 /// by indexing functions to avoid counting the number of bits.  Caller is
 /// responsible for ensuring the size assigned is actually correct.  It
@@ -759,6 +921,95 @@ inline void ibis::bitvector::append_counter(int val, word_t cnt) {
     }
 } // ibis::bitvector::append_counter
 
+/// Append @c cnt words of the fill bit @c val when the active word is
+/// empty.  Nothing is appended if @c cnt is 0.
+inline void ibis::bitvector::append_fill_words(int val, word_t cnt) {
+    if (cnt > 1) {
+	append_counter(val, cnt);
+    }
+    else if (cnt == 1) {
+	active.val = (val != 0 ? ALLONES : 0);
+	append_active();
+    }
+} // ibis::bitvector::append_fill_words
+
+/// Append the @c n lowest bits of @c v as literal bits, the most
+/// significant of them first.  It requires @c n to be no more than
+/// MAXBITS and the other bits of @c v to be 0.
+inline void ibis::bitvector::append_bits(word_t v, word_t n) {
+    if (active.nbits + n < MAXBITS) {
+	active.val = (active.val << n) | v;
+	active.nbits += n;
+    }
+    else { // fill up the active word and start a new one
+	const word_t r = active.nbits + n - MAXBITS;
+	active.val = (active.val << (n - r)) | (v >> r);
+	append_active();
+	active.val = v & ((1U << r) - 1);
+	active.nbits = r;
+    }
+} // ibis::bitvector::append_bits
+
+/// Mark the bit at position @c pos as 1.  The value of @c pos must not be
+/// less than the value given in the previous call.
+inline void ibis::bitvector::builder::setBit(word_t pos) {
+    if (pos >= start + MAXBITS)
+	advance(pos);
+    word |= (1U << (start + MAXBITS - 1 - pos));
+} // ibis::bitvector::builder::setBit
+
+/// Mark the bits of a whole literal word.  The position @c pos must be a
+/// multiple of bitsPerLiteral() and not less than the position given in
+/// the previous call.  The bits of @c lit are for rows @c pos through
+/// pos+bitsPerLiteral()-1, with the first row at 2^30.
+inline void ibis::bitvector::builder::setWord(word_t pos, word_t lit) {
+    if (pos >= start + MAXBITS)
+	advance(pos);
+    word |= lit;
+} // ibis::bitvector::builder::setWord
+
+/// Move to the next run that is either a literal word or a fill of
+/// @c fillBit, skipping over the fills of the other bit.  Return false if
+/// there is no more such run.
+inline bool ibis::bitvector::many_cursor::load(int fillBit) {
+    while (it < end) {
+	if (*it > ALLONES) {
+	    const word_t n = (*it & MAXCNT);
+	    if ((*it >= HEADER1) == (fillBit != 0)) {
+		nWords = n;
+		isFill = true;
+		return true;
+	    }
+	    start += n;
+	    ++ it;
+	}
+	else {
+	    nWords = 1;
+	    isFill = false;
+	    return true;
+	}
+    }
+    return false;
+} // ibis::bitvector::many_cursor::load
+
+/// Skip forward to the word at position @c pos, a fill may be partially
+/// consumed.  Return false if there is no more run of interest.
+inline bool
+ibis::bitvector::many_cursor::advance(word_t pos, int fillBit) {
+    while (start < pos) {
+	if (start + nWords > pos) {
+	    nWords -= (pos - start);
+	    start = pos;
+	    return true;
+	}
+	start += nWords;
+	++ it;
+	if (! load(fillBit))
+	    return false;
+    }
+    return true;
+} // ibis::bitvector::many_cursor::advance
+
 /// Append a single bit.  The incoming value must be 0 or 1.
 inline ibis::bitvector& ibis::bitvector::operator+=(int b) {
     active.append(b);
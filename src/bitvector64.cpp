@@ -66,6 +66,73 @@ ibis::bitvector64::bitvector64(const char* file) : nbits(0), nset(0) {
     try {read(file);} catch(...) {/*return empty bitvector64*/}
 } // ctor from file
 
+/// Construct a bitvector64 with the same bits as the 32-bit bitvector @c
+/// bv.  The 31-bit literal words of @c bv are regrouped into 63-bit
+/// literal words and its fills are merged into 64-bit fill words.
+ibis::bitvector64::bitvector64(const ibis::bitvector& bv)
+    : nbits(0), nset(0) {
+    array_t<ibis::bitvector::word_t> arr;
+    bv.write(arr); // the words of bv followed by the active word
+    const ibis::bitvector::word_t anb = arr.back();
+    arr.pop_back();
+    ibis::bitvector::word_t aval = 0;
+    if (anb > 0) {
+        aval = arr.back();
+        arr.pop_back();
+    }
+
+    const unsigned nb = ibis::bitvector::bitsPerLiteral();
+    const ibis::bitvector::word_t cntmask = (1U << (nb - 1)) - 1;
+    for (size_t j = 0; j < arr.size(); ++ j) {
+        if (arr[j] >> nb) { // a fill word
+            appendFill((arr[j] >> (nb - 1)) & 1,
+                       static_cast<word_t>(arr[j] & cntmask) * nb);
+        }
+        else { // a literal word
+            append_bits(arr[j], nb);
+        }
+    }
+    if (anb > 0)
+        append_bits(aval, anb);
+    nset = 0;
+} // ctor from bitvector
+
+/// Copy the bits into the 32-bit bitvector @c bv.  The existing content of
+/// @c bv is replaced.  It throws an exception if this bitvector64 has more
+/// bits than a 32-bit bitvector can hold.
+void ibis::bitvector64::copyTo(ibis::bitvector& bv) const {
+    const unsigned nb = ibis::bitvector::bitsPerLiteral();
+    const ibis::bitvector::word_t lmask = (1U << nb) - 1;
+    bv.clear();
+    if (size() > 0xFFFFFFFFU)
+        throw "bitvector64::copyTo can not fit the bits into a bitvector"
+            IBIS_FILE_LINE;
+
+    for (array_t<word_t>::const_iterator it = m_vec.begin();
+         it != m_vec.end(); ++ it) {
+        if (*it > ALLONES) { // a fill word
+            bv.appendFill(*it >= HEADER1, static_cast<ibis::bitvector::word_t>
+                          ((*it & MAXCNT) * MAXBITS));
+        }
+        else { // a literal word, 63 = 31 + 31 + 1 bits
+            bv.appendWord(static_cast<ibis::bitvector::word_t>(*it >> 32));
+            bv.appendWord(static_cast<ibis::bitvector::word_t>(*it >> 1)
+                          & lmask);
+            bv += static_cast<int>(*it & 1);
+        }
+    }
+    unsigned n = active.nbits;
+    while (n >= nb) {
+        n -= nb;
+        bv.appendWord(static_cast<ibis::bitvector::word_t>(active.val >> n)
+                      & lmask);
+    }
+    while (n > 0) {
+        -- n;
+        bv += static_cast<int>((active.val >> n) & 1);
+    }
+} // ibis::bitvector64::copyTo
+
 // set a bitvector64 to contain n bits of val
 void ibis::bitvector64::set(int val, word_t n) {
     clear(); // clear the current content
@@ -62,6 +62,8 @@ public:
 	active(bv.active), m_vec(bv.m_vec) {};
     bitvector64(const array_t<word_t>& arr);
     bitvector64(const char* file); ///!< Read the content of the named file.
+    explicit bitvector64(const ibis::bitvector& bv);
+    void copyTo(ibis::bitvector& bv) const;
     inline bitvector64& operator=(const bitvector64& bv); ///!<@note Deep copy.
     inline bitvector64& copy(const bitvector64& bv);      ///!<@note Deep copy.
     inline bitvector64& swap(bitvector64& bv);
@@ -313,6 +315,7 @@ private:
     void copy_comp(array_t<word_t>& tmp) const;
     inline void append_active();
     inline void append_counter(int val, word_t cnt);
+    inline void append_bits(word_t v, unsigned n);
     inline unsigned cnt_ones(word_t) const; // number of 1s in a literal word
     inline word_t cnt_bits(word_t) const; // number of bits in a word
     word_t do_cnt() const; // count the number of bits and number of ones
@@ -573,6 +576,22 @@ inline void ibis::bitvector64::append_counter(int val, word_t cnt) {
     }
 } // ibis::bitvector64::append_counter
 
+/// Append the @c n lowest bits of @c v as literal bits, the most
+/// significant of them first.  It requires @c n to be less than MAXBITS.
+inline void ibis::bitvector64::append_bits(word_t v, unsigned n) {
+    if (active.nbits + n < MAXBITS) {
+	active.val = (active.val << n) | v;
+	active.nbits += n;
+    }
+    else { // fill up the active word and start a new one
+	const unsigned r = active.nbits + n - MAXBITS;
+	active.val = (active.val << (n - r)) | (v >> r);
+	append_active();
+	active.val = v & ((static_cast<word_t>(1) << r) - 1);
+	active.nbits = r;
+    }
+} // ibis::bitvector64::append_bits
+
 /// Append a single bit
 inline ibis::bitvector64& ibis::bitvector64::operator+=(int b) {
     active.append(b);
@@ -2766,6 +2766,8 @@ int ibis::bord::backup(const char* dir, const char* tname,
                 "file \"" << dict << "\", ierr = " << ierr;
             cnm += ".int";
         }
+        ibis::column::removeZoneMap(cnm.c_str());
+        ibis::column::removeEncoded(cnm.c_str());
         int fdes = UnixOpen(cnm.c_str(), OPEN_WRITEADD, OPEN_FILEMODE);
         if (fdes < 0) {
             LOGGER(ibis::gVerbose >= 0)
@@ -6804,19 +6806,15 @@ ibis::bord::column::selectBytes(const ibis::bitvector &mask) const {
             i = nprop;
         }
         else if (nprop >= mask.size()) { // no need to check loop bounds
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -6969,19 +6967,15 @@ ibis::bord::column::selectShorts(const ibis::bitvector &mask) const {
             i = nprop;
         }
         else if (nprop >= mask.size()) { // no need to check loop bounds
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -7021,19 +7015,15 @@ ibis::bord::column::selectShorts(const ibis::bitvector &mask) const {
         const uint32_t nprop = prop.size();
         ibis::bitvector::indexSet index = mask.firstIndexSet();
         if (nprop >= mask.size()) { // no need to check loop bounds
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -7073,19 +7063,15 @@ ibis::bord::column::selectShorts(const ibis::bitvector &mask) const {
         const uint32_t nprop = prop.size();
         ibis::bitvector::indexSet index = mask.firstIndexSet();
         if (nprop >= mask.size()) { // no need to check loop bounds
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -7299,30 +7285,21 @@ ibis::bord::column::selectInts(const ibis::bitvector &mask) const {
 #if DEBUG+0 > 0 || _DEBUG+0 > 0
             logMessage("DEBUG", "entering unchecked loops");
 #endif
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
 #if DEBUG+0 > 0 || _DEBUG+0 > 0
                     logMessage("DEBUG", "copying range [%lu, %lu), i=%lu",
-                               static_cast<long unsigned>(*idx0),
-                               static_cast<long unsigned>(idx0[1]),
+                               static_cast<long unsigned>(starts[k]),
+                               static_cast<long unsigned>(ends[k]),
                                static_cast<long unsigned>(i));
 #endif
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-#if DEBUG+0 > 0 || _DEBUG+0 > 0
-                        logMessage("DEBUG", "copying value %lu to i=%lu",
-                                   static_cast<long unsigned>(idx0[j]),
-                                   static_cast<long unsigned>(i));
-#endif
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -7377,19 +7354,15 @@ ibis::bord::column::selectInts(const ibis::bitvector &mask) const {
         const uint32_t nprop = prop.size();
         ibis::bitvector::indexSet index = mask.firstIndexSet();
         if (nprop >= mask.size()) { // no need to check loop bounds
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -7429,19 +7402,15 @@ ibis::bord::column::selectInts(const ibis::bitvector &mask) const {
         const uint32_t nprop = prop.size();
         ibis::bitvector::indexSet index = mask.firstIndexSet();
         if (nprop >= mask.size()) { // no need to check loop bounds
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -7481,19 +7450,15 @@ ibis::bord::column::selectInts(const ibis::bitvector &mask) const {
         const uint32_t nprop = prop.size();
         ibis::bitvector::indexSet index = mask.firstIndexSet();
         if (nprop >= mask.size()) { // no need to check loop bounds
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -7533,19 +7498,15 @@ ibis::bord::column::selectInts(const ibis::bitvector &mask) const {
         const uint32_t nprop = prop.size();
         ibis::bitvector::indexSet index = mask.firstIndexSet();
         if (nprop >= mask.size()) { // no need to check loop bounds
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -7834,30 +7795,21 @@ ibis::bord::column::selectLongs(const ibis::bitvector& mask) const {
 #if DEBUG+0 > 0 || _DEBUG+0 > 0
             logMessage("DEBUG", "entering unchecked loops");
 #endif
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
 #if DEBUG+0 > 0 || _DEBUG+0 > 0
                     logMessage("DEBUG", "copying range [%lu, %lu), i=%lu",
-                               static_cast<long unsigned>(*idx0),
-                               static_cast<long unsigned>(idx0[1]),
+                               static_cast<long unsigned>(starts[k]),
+                               static_cast<long unsigned>(ends[k]),
                                static_cast<long unsigned>(i));
 #endif
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-#if DEBUG+0 > 0 || _DEBUG+0 > 0
-                        logMessage("DEBUG", "copying value %lu to i=%lu",
-                                   static_cast<long unsigned>(idx0[j]),
-                                   static_cast<long unsigned>(i));
-#endif
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -7921,30 +7873,21 @@ ibis::bord::column::selectLongs(const ibis::bitvector& mask) const {
 #if DEBUG+0 > 0 || _DEBUG+0 > 0
             logMessage("DEBUG", "entering unchecked loops");
 #endif
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
 #if DEBUG+0 > 0 || _DEBUG+0 > 0
                     logMessage("DEBUG", "copying range [%lu, %lu), i=%lu",
-                               static_cast<long unsigned>(*idx0),
-                               static_cast<long unsigned>(idx0[1]),
+                               static_cast<long unsigned>(starts[k]),
+                               static_cast<long unsigned>(ends[k]),
                                static_cast<long unsigned>(i));
 #endif
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-#if DEBUG+0 > 0 || _DEBUG+0 > 0
-                        logMessage("DEBUG", "copying value %lu to i=%lu",
-                                   static_cast<long unsigned>(idx0[j]),
-                                   static_cast<long unsigned>(i));
-#endif
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -8007,30 +7950,21 @@ ibis::bord::column::selectLongs(const ibis::bitvector& mask) const {
 #if DEBUG+0 > 0 || _DEBUG+0 > 0
             logMessage("DEBUG", "entering unchecked loops");
 #endif
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
 #if DEBUG+0 > 0 || _DEBUG+0 > 0
                     logMessage("DEBUG", "copying range [%lu, %lu), i=%lu",
-                               static_cast<long unsigned>(*idx0),
-                               static_cast<long unsigned>(idx0[1]),
+                               static_cast<long unsigned>(starts[k]),
+                               static_cast<long unsigned>(ends[k]),
                                static_cast<long unsigned>(i));
 #endif
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-#if DEBUG+0 > 0 || _DEBUG+0 > 0
-                        logMessage("DEBUG", "copying value %lu to i=%lu",
-                                   static_cast<long unsigned>(idx0[j]),
-                                   static_cast<long unsigned>(i));
-#endif
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -8086,19 +8020,15 @@ ibis::bord::column::selectLongs(const ibis::bitvector& mask) const {
         const uint32_t nprop = prop.size();
         ibis::bitvector::indexSet index = mask.firstIndexSet();
         if (nprop >= mask.size()) { // no need to check loop bounds
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -8139,19 +8069,15 @@ ibis::bord::column::selectLongs(const ibis::bitvector& mask) const {
         const uint32_t nprop = prop.size();
         ibis::bitvector::indexSet index = mask.firstIndexSet();
         if (nprop >= mask.size()) { // no need to check loop bounds
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -8192,19 +8118,15 @@ ibis::bord::column::selectLongs(const ibis::bitvector& mask) const {
         const uint32_t nprop = prop.size();
         ibis::bitvector::indexSet index = mask.firstIndexSet();
         if (nprop >= mask.size()) { // no need to check loop bounds
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -8245,19 +8167,15 @@ ibis::bord::column::selectLongs(const ibis::bitvector& mask) const {
         const uint32_t nprop = prop.size();
         ibis::bitvector::indexSet index = mask.firstIndexSet();
         if (nprop >= mask.size()) { // no need to check loop bounds
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -8334,30 +8252,21 @@ ibis::bord::column::selectULongs(const ibis::bitvector& mask) const {
 #if DEBUG+0 > 0 || _DEBUG+0 > 0
             logMessage("DEBUG", "entering unchecked loops");
 #endif
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
 #if DEBUG+0 > 0 || _DEBUG+0 > 0
                     logMessage("DEBUG", "copying range [%lu, %lu), i=%lu",
-                               static_cast<long unsigned>(*idx0),
-                               static_cast<long unsigned>(idx0[1]),
+                               static_cast<long unsigned>(starts[k]),
+                               static_cast<long unsigned>(ends[k]),
                                static_cast<long unsigned>(i));
 #endif
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-#if DEBUG+0 > 0 || _DEBUG+0 > 0
-                        logMessage("DEBUG", "copying value %lu to i=%lu",
-                                   static_cast<long unsigned>(idx0[j]),
-                                   static_cast<long unsigned>(i));
-#endif
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -8421,30 +8330,21 @@ ibis::bord::column::selectULongs(const ibis::bitvector& mask) const {
 #if DEBUG+0 > 0 || _DEBUG+0 > 0
             logMessage("DEBUG", "entering unchecked loops");
 #endif
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
 #if DEBUG+0 > 0 || _DEBUG+0 > 0
                     logMessage("DEBUG", "copying range [%lu, %lu), i=%lu",
-                               static_cast<long unsigned>(*idx0),
-                               static_cast<long unsigned>(idx0[1]),
+                               static_cast<long unsigned>(starts[k]),
+                               static_cast<long unsigned>(ends[k]),
                                static_cast<long unsigned>(i));
 #endif
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-#if DEBUG+0 > 0 || _DEBUG+0 > 0
-                        logMessage("DEBUG", "copying value %lu to i=%lu",
-                                   static_cast<long unsigned>(idx0[j]),
-                                   static_cast<long unsigned>(i));
-#endif
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -8507,30 +8407,21 @@ ibis::bord::column::selectULongs(const ibis::bitvector& mask) const {
 #if DEBUG+0 > 0 || _DEBUG+0 > 0
             logMessage("DEBUG", "entering unchecked loops");
 #endif
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
 #if DEBUG+0 > 0 || _DEBUG+0 > 0
                     logMessage("DEBUG", "copying range [%lu, %lu), i=%lu",
-                               static_cast<long unsigned>(*idx0),
-                               static_cast<long unsigned>(idx0[1]),
+                               static_cast<long unsigned>(starts[k]),
+                               static_cast<long unsigned>(ends[k]),
                                static_cast<long unsigned>(i));
 #endif
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-#if DEBUG+0 > 0 || _DEBUG+0 > 0
-                        logMessage("DEBUG", "copying value %lu to i=%lu",
-                                   static_cast<long unsigned>(idx0[j]),
-                                   static_cast<long unsigned>(i));
-#endif
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -8586,19 +8477,15 @@ ibis::bord::column::selectULongs(const ibis::bitvector& mask) const {
         const uint32_t nprop = prop.size();
         ibis::bitvector::indexSet index = mask.firstIndexSet();
         if (nprop >= mask.size()) { // no need to check loop bounds
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -8639,19 +8526,15 @@ ibis::bord::column::selectULongs(const ibis::bitvector& mask) const {
         const uint32_t nprop = prop.size();
         ibis::bitvector::indexSet index = mask.firstIndexSet();
         if (nprop >= mask.size()) { // no need to check loop bounds
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -8692,19 +8575,15 @@ ibis::bord::column::selectULongs(const ibis::bitvector& mask) const {
         const uint32_t nprop = prop.size();
         ibis::bitvector::indexSet index = mask.firstIndexSet();
         if (nprop >= mask.size()) { // no need to check loop bounds
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -8745,19 +8624,15 @@ ibis::bord::column::selectULongs(const ibis::bitvector& mask) const {
         const uint32_t nprop = prop.size();
         ibis::bitvector::indexSet index = mask.firstIndexSet();
         if (nprop >= mask.size()) { // no need to check loop bounds
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -8829,19 +8704,15 @@ ibis::bord::column::selectFloats(const ibis::bitvector& mask) const {
             i = nprop;
         }
         else if (nprop >= mask.size()) { // no need to check loop bounds
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
-                    for (uint32_t j = *idx0; j<idx0[1]; ++j, ++i) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // check loop bounds against nprop
@@ -8883,19 +8754,15 @@ ibis::bord::column::selectFloats(const ibis::bitvector& mask) const {
         const uint32_t nprop = prop.size();
         ibis::bitvector::indexSet index = mask.firstIndexSet();
         if (nprop >= mask.size()) { // no need to check loop bounds
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -8936,19 +8803,15 @@ ibis::bord::column::selectFloats(const ibis::bitvector& mask) const {
         const uint32_t nprop = prop.size();
         ibis::bitvector::indexSet index = mask.firstIndexSet();
         if (nprop >= mask.size()) { // no need to check loop bounds
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -8989,19 +8852,15 @@ ibis::bord::column::selectFloats(const ibis::bitvector& mask) const {
         const uint32_t nprop = prop.size();
         ibis::bitvector::indexSet index = mask.firstIndexSet();
         if (nprop >= mask.size()) { // no need to check loop bounds
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -9042,19 +8901,15 @@ ibis::bord::column::selectFloats(const ibis::bitvector& mask) const {
         const uint32_t nprop = prop.size();
         ibis::bitvector::indexSet index = mask.firstIndexSet();
         if (nprop >= mask.size()) { // no need to check loop bounds
-            while (index.nIndices() > 0) {
-                const ibis::bitvector::word_t *idx0 = index.indices();
-                if (index.isRange()) {
-                    for (uint32_t j = *idx0; j < idx0[1]; ++j, ++i) {
+            ibis::bitvector::word_t starts[256], ends[256];
+            ibis::bitvector::decoder dec(mask);
+            for (uint32_t nr = dec.ranges(starts, ends, 256); nr > 0;
+                 nr = dec.ranges(starts, ends, 256)) {
+                for (uint32_t k = 0; k < nr; ++ k) {
+                    for (uint32_t j = starts[k]; j < ends[k]; ++j, ++i) {
                         (*array)[i] = (prop[j]);
                     }
                 }
-                else {
-                    for (uint32_t j = 0; j<index.nIndices(); ++j, ++i) {
-                        (*array)[i] = (prop[idx0[j]]);
-                    }
-                }
-                ++ index;
             }
         }
         else { // need to check loop bounds against nprop
@@ -765,10 +765,12 @@ double ibis::category::estimateCost(const ibis::qString& qstr) const {
         if (idx != 0) {
             ibis::qContinuousRange expr(m_name.c_str(),
                                         ibis::qExpr::OP_EQ, ind);
-            ret = idx->estimateCost(expr);
+            ret = ibis::part::indexCost(idx->estimateCost(expr));
         }
         else { // no index, use the number of rows
-            ret = static_cast<double>(thePart->nRows()) * sizeof(uint32_t);
+            ret = ibis::part::scanCost
+                (static_cast<double>(thePart->nRows()) * sizeof(uint32_t),
+                 thePart->nRows());
         }
     }
     else {
@@ -791,10 +793,12 @@ double ibis::category::estimateCost(const ibis::qAnyString& qstr) const {
                 inds.push_back(jnd);
         }
         ibis::qDiscreteRange expr(m_name.c_str(), inds);
-        ret = idx->estimateCost(expr);
+        ret = ibis::part::indexCost(idx->estimateCost(expr));
     }
     else { // no index, use the number of rows
-        ret = static_cast<double>(thePart->nRows()) * sizeof(uint32_t);
+        ret = ibis::part::scanCost
+            (static_cast<double>(thePart->nRows()) * sizeof(uint32_t),
+             thePart->nRows());
     }
     return ret;
 } // ibis::category::estimateCost
@@ -455,7 +455,8 @@ uint32_t ibis::column::numBins() const {
 
 /// Compute the actual min/max values.  It actually goes through all the
 /// values.  This function reads the data in the active data directory and
-/// modifies the member variables to record the actual min/max.
+/// modifies the member variables to record the actual min/max.  It also
+/// writes the zone map and the encoded copy of the data file.
 void ibis::column::computeMinMax() {
     std::string sname;
     const char* name = dataFileName(sname);
@@ -463,18 +464,25 @@ void ibis::column::computeMinMax() {
         ibis::bitvector msk;
         getNullMask(msk);
         actualMinMax(name, msk, lower, upper, m_sorted);
+        (void) writeZoneMap(name, m_type, msk);
+        (void) writeEncoded(name, m_type);
     }
 } // ibis::column::computeMinMax
 
 /// Compute the actual min/max values.  It actually goes through all the
 /// values.  This function reads the data in the given directory and
-/// modifies the member variables to record the actual min/max.
+/// modifies the member variables to record the actual min/max.  It also
+/// writes the zone map and the encoded copy of the data file.
 void ibis::column::computeMinMax(const char *dir) {
     std::string sname;
     const char* name = dataFileName(sname, dir);
     ibis::bitvector msk;
     getNullMask(msk);
     actualMinMax(name, msk, lower, upper, m_sorted);
+    if (name != 0) {
+        (void) writeZoneMap(name, m_type, msk);
+        (void) writeEncoded(name, m_type);
+    }
 } // ibis::column::computeMinMax
 
 /// Compute the actual min/max of the data in directory @c dir.  Report the
@@ -685,6 +693,1193 @@ void ibis::column::actualMinMax(const char *name, const ibis::bitvector& mask,
     } // switch(m_type)
 } // ibis::column::actualMinMax
 
+/// Compute the minimum, the maximum and the number of nulls of every
+/// block of @c bs rows.  A NaN value is counted as a null because it does
+/// not satisfy any range condition.
+template <typename T>
+static void _ibis_column_zones(const ibis::array_t<T> &vals,
+                               const ibis::bitvector &msk, uint32_t bs,
+                               ibis::array_t<double> &mins,
+                               ibis::array_t<double> &maxs,
+                               ibis::array_t<uint32_t> &nulls) {
+    const uint32_t nb = (vals.size() + bs - 1) / bs;
+    mins.resize(nb);
+    maxs.resize(nb);
+    nulls.resize(nb);
+    for (uint32_t b = 0; b < nb; ++ b) {
+        mins[b] = DBL_MAX;
+        maxs[b] = -DBL_MAX;
+        nulls[b] = (b+1 < nb ? bs : vals.size() - b * bs);
+    }
+
+    ibis::bitvector::word_t starts[256], ends[256];
+    ibis::bitvector::decoder dec(msk);
+    for (uint32_t nrng = dec.ranges(starts, ends, 256); nrng > 0;
+         nrng = dec.ranges(starts, ends, 256)) {
+        for (uint32_t i = 0; i < nrng; ++ i) {
+            uint32_t j = starts[i];
+            const uint32_t end = (ends[i] <= vals.size() ?
+                                  ends[i] : vals.size());
+            while (j < end) {
+                const uint32_t b = j / bs;
+                const uint32_t last = ((b+1) * bs < end ? (b+1) * bs : end);
+                T mn = vals[j], mx = vals[j];
+                uint32_t nvalid = 0;
+                for (; j < last; ++ j) {
+                    const T &v = vals[j];
+                    if (v == v) { // not a NaN
+                        ++ nvalid;
+                        if (v < mn) mn = v;
+                        if (v > mx) mx = v;
+                    }
+                }
+                if (nvalid > 0) {
+                    double dmn = static_cast<double>(mn);
+                    double dmx = static_cast<double>(mx);
+                    if (sizeof(T) > 4 && std::numeric_limits<T>::is_integer) {
+                        // 64-bit integers may be rounded when converted
+                        dmn = ibis::util::decrDouble(dmn);
+                        dmx = ibis::util::incrDouble(dmx);
+                    }
+                    if (mins[b] > dmn)
+                        mins[b] = dmn;
+                    if (maxs[b] < dmx)
+                        maxs[b] = dmx;
+                    nulls[b] -= nvalid;
+                }
+            }
+        }
+    }
+} // _ibis_column_zones
+
+/// Write the zone map of the data file @c fname.  A zone map records the
+/// minimum, the maximum and the number of nulls of every fixed size block
+/// of rows.  It is written to the file named @c fname with the extension
+/// ".zmp", and allows the range conditions on a column without an index
+/// to skip the blocks that can not contain any hits and to accept the
+/// blocks in which all rows are hits, see zoneMapRange.  The mask @c msk
+/// marks the rows with valid values, an empty mask means all values are
+/// valid.
+///
+/// The block size is taken from the parameter zoneMap.blockSize with a
+/// default of 8192.  The zone maps are not written for data files with
+/// fewer than two blocks or if the parameter zoneMap.disable is true.
+///
+/// Returns the number of blocks written, 0 if no zone map is needed and a
+/// negative number to indicate error.
+int ibis::column::writeZoneMap(const char *fname, ibis::TYPE_T t,
+                               const ibis::bitvector &msk) {
+    if (fname == 0 || *fname == 0)
+        return -1;
+    removeZoneMap(fname);
+    if (ibis::gParameters().isTrue("zoneMap.disable"))
+        return 0;
+
+    uint32_t bs = static_cast<uint32_t>
+        (ibis::gParameters().getNumber("zoneMap.blockSize"));
+    if (bs == 0)
+        bs = 8192;
+    const off_t fsize = ibis::util::getFileSize(fname);
+    int elem = 0;
+    switch (t) {
+    case ibis::BYTE:
+    case ibis::UBYTE:
+        elem = 1; break;
+    case ibis::SHORT:
+    case ibis::USHORT:
+        elem = 2; break;
+    case ibis::INT:
+    case ibis::UINT:
+    case ibis::FLOAT:
+        elem = 4; break;
+    case ibis::LONG:
+    case ibis::ULONG:
+    case ibis::DOUBLE:
+        elem = 8; break;
+    default:
+        return 0;
+    }
+    if (fsize < static_cast<off_t>(elem) * bs * 2)
+        return 0;
+
+    const uint32_t nrows = fsize / elem;
+    const off_t nbytes = static_cast<off_t>(nrows) * elem;
+    ibis::bitvector mask;
+    if (msk.size() == nrows)
+        mask.copy(msk);
+    else
+        mask.set(1, nrows);
+
+    ibis::array_t<double> mins, maxs;
+    ibis::array_t<uint32_t> nulls;
+    try {
+        switch (t) {
+        case ibis::BYTE: {
+            ibis::array_t<signed char> vals(fname, 0, nbytes);
+            _ibis_column_zones(vals, mask, bs, mins, maxs, nulls);
+            break;}
+        case ibis::UBYTE: {
+            ibis::array_t<unsigned char> vals(fname, 0, nbytes);
+            _ibis_column_zones(vals, mask, bs, mins, maxs, nulls);
+            break;}
+        case ibis::SHORT: {
+            ibis::array_t<int16_t> vals(fname, 0, nbytes);
+            _ibis_column_zones(vals, mask, bs, mins, maxs, nulls);
+            break;}
+        case ibis::USHORT: {
+            ibis::array_t<uint16_t> vals(fname, 0, nbytes);
+            _ibis_column_zones(vals, mask, bs, mins, maxs, nulls);
+            break;}
+        case ibis::INT: {
+            ibis::array_t<int32_t> vals(fname, 0, nbytes);
+            _ibis_column_zones(vals, mask, bs, mins, maxs, nulls);
+            break;}
+        case ibis::UINT: {
+            ibis::array_t<uint32_t> vals(fname, 0, nbytes);
+            _ibis_column_zones(vals, mask, bs, mins, maxs, nulls);
+            break;}
+        case ibis::FLOAT: {
+            ibis::array_t<float> vals(fname, 0, nbytes);
+            _ibis_column_zones(vals, mask, bs, mins, maxs, nulls);
+            break;}
+        case ibis::LONG: {
+            ibis::array_t<int64_t> vals(fname, 0, nbytes);
+            _ibis_column_zones(vals, mask, bs, mins, maxs, nulls);
+            break;}
+        case ibis::ULONG: {
+            ibis::array_t<uint64_t> vals(fname, 0, nbytes);
+            _ibis_column_zones(vals, mask, bs, mins, maxs, nulls);
+            break;}
+        case ibis::DOUBLE: {
+            ibis::array_t<double> vals(fname, 0, nbytes);
+            _ibis_column_zones(vals, mask, bs, mins, maxs, nulls);
+            break;}
+        default:
+            return 0;
+        }
+    }
+    catch (...) {
+        LOGGER(ibis::gVerbose > 1)
+            << "Warning -- column::writeZoneMap failed to read " << fname;
+        return -2;
+    }
+    if (mins.size() != (nrows + bs - 1) / bs)
+        return -3;
+
+    std::string zfile = fname;
+    zfile += ".zmp";
+    off_t ierr = 0;
+    {
+        int fdes = UnixOpen(zfile.c_str(), OPEN_WRITENEW, OPEN_FILEMODE);
+        if (fdes < 0) {
+            LOGGER(ibis::gVerbose > 1)
+                << "Warning -- column::writeZoneMap failed to open "
+                << zfile << " for writing";
+            return -4;
+        }
+        IBIS_BLOCK_GUARD(UnixClose, fdes);
+#if defined(_WIN32) && defined(_MSC_VER)
+        (void)_setmode(fdes, _O_BINARY);
+#endif
+
+        // header: 8 bytes of signature, the block size, the number of rows
+        const char sig[8] = {'#', 'I', 'B', 'I', 'S', 'Z', 'M', 0};
+        const uint32_t hdr[2] = {bs, nrows};
+        ierr = UnixWrite(fdes, sig, 8);
+        ierr += UnixWrite(fdes, hdr, sizeof(hdr));
+        ierr += UnixWrite(fdes, mins.begin(), sizeof(double) * mins.size());
+        ierr += UnixWrite(fdes, maxs.begin(), sizeof(double) * maxs.size());
+        ierr += UnixWrite(fdes, nulls.begin(),
+                          sizeof(uint32_t) * nulls.size());
+    }
+    if (ierr != static_cast<off_t>(16 + 20 * mins.size())) {
+        LOGGER(ibis::gVerbose > 1)
+            << "Warning -- column::writeZoneMap failed to write "
+            << zfile;
+        (void) remove(zfile.c_str());
+        return -5;
+    }
+    LOGGER(ibis::gVerbose > 4)
+        << "column::writeZoneMap wrote " << mins.size() << " blocks of "
+        << bs << " rows to " << zfile;
+    return mins.size();
+} // ibis::column::writeZoneMap
+
+/// Remove the zone map of the data file @c fname.  This must be called
+/// whenever the content of the data file is changed without writing a new
+/// zone map.
+void ibis::column::removeZoneMap(const char *fname) {
+    if (fname == 0 || *fname == 0)
+        return;
+    std::string zfile = fname;
+    zfile += ".zmp";
+    ibis::fileManager::instance().flushFile(zfile.c_str());
+    (void) remove(zfile.c_str());
+} // ibis::column::removeZoneMap
+
+/// Use the zone map to classify the blocks of rows for the range
+/// condition @c cmp.  On successful completion, the rows in the blocks
+/// where every row satisfies @c cmp are marked 1 in @c sure, and the rows
+/// in the blocks where some rows might satisfy @c cmp are marked 1 in @c
+/// maybe.  Both bitvectors have one bit for each row of the data
+/// partition, and the rows in neither one can not satisfy @c cmp.  Only
+/// the continuous and the discrete ranges are handled.
+///
+/// Returns the number of blocks, or a negative number if there is no
+/// valid zone map to use.
+long ibis::column::zoneMapRange(const ibis::qRange &cmp,
+                                ibis::bitvector &sure,
+                                ibis::bitvector &maybe) const {
+    if (thePart == 0 || thePart->nRows() == 0)
+        return -1;
+    if (cmp.getType() != ibis::qExpr::RANGE &&
+        cmp.getType() != ibis::qExpr::DRANGE)
+        return -1;
+    if (cmp.getType() == ibis::qExpr::RANGE &&
+        static_cast<const ibis::qContinuousRange&>(cmp).leftOperator()
+        == ibis::qExpr::OP_UNDEFINED &&
+        static_cast<const ibis::qContinuousRange&>(cmp).rightOperator()
+        == ibis::qExpr::OP_UNDEFINED)
+        return -1;
+
+    std::string zfile;
+    if (dataFileName(zfile) == 0)
+        return -1;
+    zfile += ".zmp";
+    if (ibis::util::getFileSize(zfile.c_str()) <= 16)
+        return -2;
+
+    ibis::fileManager::storage *st = 0;
+    if (ibis::fileManager::instance().getFile(zfile.c_str(), &st) != 0 ||
+        st == 0 || st->bytes() <= 16)
+        return -3;
+    ibis::array_t<uint32_t> hdr(st, 8, 16);
+    const uint32_t bs = hdr[0];
+    const uint32_t nrows = hdr[1];
+    const uint32_t nb = (bs > 0 ? (nrows + bs - 1) / bs : 0);
+    if (std::strncmp(st->begin(), "#IBISZM", 8) != 0 || bs == 0 ||
+        nrows != thePart->nRows() || st->bytes() != 16 + 20 * nb) {
+        LOGGER(ibis::gVerbose > 2)
+            << "Warning -- column[" << fullname() << "]::zoneMapRange "
+            "will not use " << zfile << " because it is not a valid zone "
+            "map for " << thePart->nRows() << " rows";
+        return -4;
+    }
+    ibis::array_t<double> mins(st, 16, 16 + 8 * nb);
+    ibis::array_t<double> maxs(st, 16 + 8 * nb, 16 + 16 * nb);
+    ibis::array_t<uint32_t> nulls(st, 16 + 16 * nb, 16 + 20 * nb);
+
+    sure.clear();
+    maybe.clear();
+    for (uint32_t b = 0; b < nb; ++ b) {
+        const uint32_t len = (b+1 < nb ? bs : nrows - b * bs);
+        bool skip, all;
+        if (nulls[b] >= len) {
+            skip = true;
+            all = false;
+        }
+        else if (cmp.getType() == ibis::qExpr::RANGE) {
+            const ibis::qContinuousRange &rng =
+                static_cast<const ibis::qContinuousRange&>(cmp);
+            skip = ! rng.overlap(mins[b], maxs[b]);
+            all = (rng.inRange(mins[b]) && rng.inRange(maxs[b]));
+        }
+        else {
+            const ibis::qDiscreteRange &rng =
+                static_cast<const ibis::qDiscreteRange&>(cmp);
+            skip = ! rng.overlap(mins[b], maxs[b]);
+            all = (mins[b] == maxs[b] && rng.inRange(mins[b]));
+        }
+        if (skip) {
+            sure.appendFill(0, len);
+            maybe.appendFill(0, len);
+        }
+        else if (all && nulls[b] == 0) {
+            sure.appendFill(1, len);
+            maybe.appendFill(0, len);
+        }
+        else {
+            sure.appendFill(0, len);
+            maybe.appendFill(1, len);
+        }
+    }
+    return nb;
+} // ibis::column::zoneMapRange
+
+/// Header of a block in the encoded copy of a data file, see
+/// ibis::column::writeEncoded.  The values are stored as their offsets
+/// from the smallest value of the block.
+struct _ibis_column_packHead {
+    uint8_t  method; ///!< 0 = frame of reference, 1 = delta, 2 = run-length
+    uint8_t  width;  ///!< Number of bits of each packed value.
+    uint8_t  cwidth; ///!< Number of bits of each packed run length.
+    uint8_t  pad;
+    uint32_t nent;   ///!< Number of packed values, or number of runs.
+    uint64_t base;   ///!< The smallest value of the block.
+    uint64_t range;  ///!< The largest value minus the smallest value.
+    uint64_t first;  ///!< The first value, for delta encoding.
+    uint64_t dmin;   ///!< The smallest difference, for delta encoding.
+};
+
+/// The number of bits needed to represent @c x.
+static inline unsigned _ibis_column_bits(uint64_t x) {
+    unsigned b = 0;
+    while (x > 0) {
+        ++ b;
+        x >>= 1;
+    }
+    return b;
+} // _ibis_column_bits
+
+/// Number of 64-bit words needed for @c n values of @c w bits each.
+static inline uint64_t _ibis_column_words(uint64_t n, unsigned w) {
+    return (n * w + 63) / 64;
+} // _ibis_column_words
+
+/// Append @c n values of @c w bits each to @c out.  The values are packed
+/// from the least significant bit of each word and may cross the word
+/// boundaries.
+static void _ibis_column_pack(const uint64_t *vals, uint32_t n, unsigned w,
+                              ibis::array_t<uint64_t> &out) {
+    if (w == 0 || n == 0)
+        return;
+
+    const size_t start = out.size();
+    out.resize(start + _ibis_column_words(n, w));
+    std::fill(out.begin()+start, out.end(), 0);
+    uint64_t *words = out.begin() + start;
+    uint64_t bit = 0;
+    for (uint32_t i = 0; i < n; ++ i, bit += w) {
+        const uint64_t j = (bit >> 6);
+        const unsigned off = static_cast<unsigned>(bit & 63);
+        words[j] |= (vals[i] << off);
+        if (off + w > 64)
+            words[j+1] |= (vals[i] >> (64 - off));
+    }
+} // _ibis_column_pack
+
+/// Extract the ith value of @c w bits from the packed words.
+static inline uint64_t _ibis_column_unpack(const uint64_t *words, uint64_t i,
+                                           unsigned w) {
+    if (w == 0)
+        return 0;
+
+    const uint64_t bit = i * w;
+    const uint64_t j = (bit >> 6);
+    const unsigned off = static_cast<unsigned>(bit & 63);
+    uint64_t x = (words[j] >> off);
+    if (off + w > 64)
+        x |= (words[j+1] << (64 - off));
+    return (w < 64 ? (x & ((static_cast<uint64_t>(1) << w) - 1)) : x);
+} // _ibis_column_unpack
+
+/// Extract the first @c n values of @c w bits from the packed words.
+static void _ibis_column_unpack(const uint64_t *words, uint32_t n,
+                                unsigned w, uint64_t *out) {
+    if (w == 0) {
+        std::fill(out, out + n, 0);
+        return;
+    }
+
+    const uint64_t msk = (w < 64 ? (static_cast<uint64_t>(1) << w) - 1 :
+                          ~static_cast<uint64_t>(0));
+    unsigned off = 0;
+    for (uint32_t i = 0; i < n; ++ i) {
+        uint64_t x = (*words >> off);
+        if (off + w > 64)
+            x |= (words[1] << (64 - off));
+        out[i] = (x & msk);
+        off += w;
+        if (off >= 64) {
+            off -= 64;
+            ++ words;
+        }
+    }
+} // _ibis_column_unpack
+
+/// Encode @c n values as one block and append it to @c out.  The block is
+/// encoded in three ways, frame-of-reference, delta and run-length, all
+/// followed by bit-packing, and the smallest one is kept.  The values are
+/// handled as 64-bit words so that the same code works for all integer
+/// types.
+template <typename T>
+static void _ibis_column_packBlock(const T *vals, uint32_t n,
+                                   ibis::array_t<uint64_t> &out) {
+    T vmin = vals[0], vmax = vals[0];
+    uint32_t nruns = 1, runmax = 1, run = 1;
+    for (uint32_t i = 1; i < n; ++ i) {
+        if (vmin > vals[i])
+            vmin = vals[i];
+        else if (vmax < vals[i])
+            vmax = vals[i];
+        if (vals[i] == vals[i-1]) {
+            ++ run;
+        }
+        else {
+            if (runmax < run)
+                runmax = run;
+            run = 1;
+            ++ nruns;
+        }
+    }
+    if (runmax < run)
+        runmax = run;
+
+    _ibis_column_packHead hd;
+    memset(&hd, 0, sizeof(hd));
+    hd.base = static_cast<uint64_t>(static_cast<int64_t>(vmin));
+    hd.range = static_cast<uint64_t>(static_cast<int64_t>(vmax)) - hd.base;
+    hd.first = static_cast<uint64_t>(static_cast<int64_t>(vals[0]));
+    const unsigned width = _ibis_column_bits(hd.range);
+    const uint64_t nfor = _ibis_column_words(n, width);
+    const unsigned cwidth = _ibis_column_bits(runmax - 1);
+    const uint64_t nrle = _ibis_column_words(nruns, width) +
+        _ibis_column_words(nruns, cwidth);
+
+    // the differences between the consecutive values fit in 63 bits
+    // only if the values span less than 2^62
+    int64_t dmin = 0, dmax = 0;
+    uint64_t ndelta = nfor + 1;
+    if (n > 1 && hd.range < (static_cast<uint64_t>(1) << 62)) {
+        dmin = static_cast<int64_t>
+            (static_cast<uint64_t>(static_cast<int64_t>(vals[1])) -
+             static_cast<uint64_t>(static_cast<int64_t>(vals[0])));
+        dmax = dmin;
+        for (uint32_t i = 2; i < n; ++ i) {
+            const int64_t d = static_cast<int64_t>
+                (static_cast<uint64_t>(static_cast<int64_t>(vals[i])) -
+                 static_cast<uint64_t>(static_cast<int64_t>(vals[i-1])));
+            if (dmin > d)
+                dmin = d;
+            else if (dmax < d)
+                dmax = d;
+        }
+        ndelta = _ibis_column_words
+            (n-1, _ibis_column_bits(static_cast<uint64_t>(dmax - dmin)));
+    }
+
+    ibis::array_t<uint64_t> tmp;
+    if (nrle <= nfor && nrle <= ndelta) {
+        hd.method = 2;
+        hd.width = width;
+        hd.cwidth = cwidth;
+        hd.nent = nruns;
+        tmp.reserve(nruns);
+        ibis::array_t<uint64_t> lens;
+        lens.reserve(nruns);
+        uint32_t j = 0;
+        for (uint32_t i = 1; i <= n; ++ i) {
+            if (i == n || vals[i] != vals[j]) {
+                tmp.push_back(static_cast<uint64_t>
+                              (static_cast<int64_t>(vals[j])) - hd.base);
+                lens.push_back(i - j - 1);
+                j = i;
+            }
+        }
+        out.resize(out.size() + sizeof(hd) / sizeof(uint64_t));
+        memcpy(out.end() - sizeof(hd) / sizeof(uint64_t), &hd, sizeof(hd));
+        _ibis_column_pack(tmp.begin(), nruns, width, out);
+        _ibis_column_pack(lens.begin(), nruns, cwidth, out);
+    }
+    else if (ndelta < nfor) {
+        hd.method = 1;
+        hd.width = _ibis_column_bits(static_cast<uint64_t>(dmax - dmin));
+        hd.nent = n - 1;
+        hd.dmin = static_cast<uint64_t>(dmin);
+        tmp.resize(n - 1);
+        for (uint32_t i = 1; i < n; ++ i)
+            tmp[i-1] = static_cast<uint64_t>(static_cast<int64_t>(vals[i])) -
+                static_cast<uint64_t>(static_cast<int64_t>(vals[i-1])) -
+                hd.dmin;
+        out.resize(out.size() + sizeof(hd) / sizeof(uint64_t));
+        memcpy(out.end() - sizeof(hd) / sizeof(uint64_t), &hd, sizeof(hd));
+        _ibis_column_pack(tmp.begin(), n - 1, hd.width, out);
+    }
+    else {
+        hd.method = 0;
+        hd.width = width;
+        hd.nent = n;
+        tmp.resize(n);
+        for (uint32_t i = 0; i < n; ++ i)
+            tmp[i] = static_cast<uint64_t>(static_cast<int64_t>(vals[i])) -
+                hd.base;
+        out.resize(out.size() + sizeof(hd) / sizeof(uint64_t));
+        memcpy(out.end() - sizeof(hd) / sizeof(uint64_t), &hd, sizeof(hd));
+        _ibis_column_pack(tmp.begin(), n, width, out);
+    }
+} // _ibis_column_packBlock
+
+/// Decode the offsets of a block of @c n values from the smallest value
+/// of the block into @c out.
+static void _ibis_column_unpackBlock(const _ibis_column_packHead &hd,
+                                     const uint64_t *words, uint32_t n,
+                                     uint64_t *out) {
+    if (hd.method == 0) {
+        _ibis_column_unpack(words, n, hd.width, out);
+    }
+    else if (hd.method == 1) {
+        _ibis_column_unpack(words, n - 1, hd.width, out + 1);
+        uint64_t v = hd.first - hd.base;
+        out[0] = v;
+        for (uint32_t i = 1; i < n; ++ i) {
+            v += hd.dmin + out[i];
+            out[i] = v;
+        }
+    }
+    else {
+        const uint64_t *lens = words + _ibis_column_words(hd.nent, hd.width);
+        uint32_t i = 0;
+        for (uint32_t j = 0; j < hd.nent && i < n; ++ j) {
+            const uint64_t v = _ibis_column_unpack(words, j, hd.width);
+            const uint64_t len = 1 + _ibis_column_unpack(lens, j, hd.cwidth);
+            for (uint64_t k = 0; k < len && i < n; ++ k, ++ i)
+                out[i] = v;
+        }
+    }
+} // _ibis_column_unpackBlock
+
+/// Mark the rows from @c pos to @c pos+len-1.
+static void _ibis_column_setRun(ibis::bitvector::builder &bld, uint32_t pos,
+                                uint32_t len) {
+    const uint32_t wb = ibis::bitvector::bitsPerLiteral();
+    const uint32_t end = pos + len;
+    for (; pos < end && pos % wb != 0; ++ pos)
+        bld.setBit(pos);
+    for (; pos + wb <= end; pos += wb)
+        bld.setWord(pos, (1U << wb) - 1);
+    for (; pos < end; ++ pos)
+        bld.setBit(pos);
+} // _ibis_column_setRun
+
+/// Mark the rows whose offsets @c vals are between @c lo and lo+span.
+/// The first row is @c row0.  The rows are marked a literal word at a
+/// time to avoid a branch for every row.
+static void _ibis_column_markRows(const uint64_t *vals, uint32_t n,
+                                  uint32_t row0, uint64_t lo, uint64_t span,
+                                  ibis::bitvector::builder &bld) {
+    const uint32_t wb = ibis::bitvector::bitsPerLiteral();
+    uint32_t i = 0;
+    for (; i < n && (row0 + i) % wb != 0; ++ i) {
+        if (vals[i] - lo <= span)
+            bld.setBit(row0 + i);
+    }
+    for (; i + wb <= n; i += wb) {
+        ibis::bitvector::word_t lit = 0;
+        for (uint32_t k = 0; k < wb; ++ k)
+            lit = (lit << 1) | (vals[i+k] - lo <= span);
+        if (lit != 0)
+            bld.setWord(row0 + i, lit);
+    }
+    for (; i < n; ++ i) {
+        if (vals[i] - lo <= span)
+            bld.setBit(row0 + i);
+    }
+} // _ibis_column_markRows
+
+/// Mark the rows of a block whose values minus the smallest value of the
+/// block are between @c lo and @c hi (inclusive).  The comparisons are
+/// carried out on the packed values without converting them back to
+/// their original type, and a run of the run-length encoding is accepted
+/// or rejected as a whole.  The first row of the block is @c row0, @c buf
+/// must have space for @c n values.
+static void _ibis_column_scanBlock(const _ibis_column_packHead &hd,
+                                   const uint64_t *words, uint32_t n,
+                                   uint32_t row0, uint64_t lo, uint64_t hi,
+                                   uint64_t *buf,
+                                   ibis::bitvector::builder &bld) {
+    if (hd.method != 2) {
+        _ibis_column_unpackBlock(hd, words, n, buf);
+        _ibis_column_markRows(buf, n, row0, lo, hi - lo, bld);
+    }
+    else {
+        const uint64_t *lens = words + _ibis_column_words(hd.nent, hd.width);
+        uint32_t i = 0;
+        for (uint32_t j = 0; j < hd.nent && i < n; ++ j) {
+            uint32_t len = 1 + static_cast<uint32_t>
+                (_ibis_column_unpack(lens, j, hd.cwidth));
+            if (len > n - i)
+                len = n - i;
+            if (_ibis_column_unpack(words, j, hd.width) - lo <= hi - lo)
+                _ibis_column_setRun(bld, row0 + i, len);
+            i += len;
+        }
+    }
+} // _ibis_column_scanBlock
+
+/// Does @c v satisfy the parts of @c rng that limit the values from below?
+static bool _ibis_column_above(const ibis::qContinuousRange &rng, double v) {
+    switch (rng.leftOperator()) {
+    case ibis::qExpr::OP_LT:
+        if (! (rng.leftBound() < v)) return false;
+        break;
+    case ibis::qExpr::OP_LE:
+    case ibis::qExpr::OP_EQ:
+        if (! (rng.leftBound() <= v)) return false;
+        break;
+    default:
+        break;
+    }
+    switch (rng.rightOperator()) {
+    case ibis::qExpr::OP_GT:
+        if (! (v > rng.rightBound())) return false;
+        break;
+    case ibis::qExpr::OP_GE:
+    case ibis::qExpr::OP_EQ:
+        if (! (v >= rng.rightBound())) return false;
+        break;
+    default:
+        break;
+    }
+    return true;
+} // _ibis_column_above
+
+/// Does @c v satisfy the parts of @c rng that limit the values from above?
+static bool _ibis_column_below(const ibis::qContinuousRange &rng, double v) {
+    switch (rng.leftOperator()) {
+    case ibis::qExpr::OP_GT:
+        if (! (rng.leftBound() > v)) return false;
+        break;
+    case ibis::qExpr::OP_GE:
+    case ibis::qExpr::OP_EQ:
+        if (! (rng.leftBound() >= v)) return false;
+        break;
+    default:
+        break;
+    }
+    switch (rng.rightOperator()) {
+    case ibis::qExpr::OP_LT:
+        if (! (v < rng.rightBound())) return false;
+        break;
+    case ibis::qExpr::OP_LE:
+    case ibis::qExpr::OP_EQ:
+        if (! (v <= rng.rightBound())) return false;
+        break;
+    default:
+        break;
+    }
+    return true;
+} // _ibis_column_below
+
+/// Translate the range condition into the offsets [lo, hi] from the
+/// smallest value of a block.  Returns 1 if some values of the block
+/// might satisfy the condition, 0 if none could, and -1 if the values of
+/// the block can not be compared exactly as double.
+template <typename T>
+static int _ibis_column_packedBounds(const ibis::qContinuousRange &rng,
+                                     const _ibis_column_packHead &hd,
+                                     uint64_t &lo, uint64_t &hi) {
+    const double vmin = static_cast<double>(static_cast<T>(hd.base));
+    const double vmax = static_cast<double>
+        (static_cast<T>(hd.base + hd.range));
+    if (vmin < -9007199254740992.0 || vmax > 9007199254740992.0)
+        return -1;
+    if (! _ibis_column_above(rng, vmax) || ! _ibis_column_below(rng, vmin))
+        return 0;
+
+    // the smallest offset satisfying the lower limits
+    uint64_t b = 0, e = hd.range;
+    while (b < e) {
+        const uint64_t m = b + (e - b) / 2;
+        if (_ibis_column_above
+            (rng, static_cast<double>(static_cast<T>(hd.base + m))))
+            e = m;
+        else
+            b = m + 1;
+    }
+    lo = b;
+    // the largest offset satisfying the upper limits
+    b = 0;
+    e = hd.range;
+    while (b < e) {
+        const uint64_t m = e - (e - b) / 2;
+        if (_ibis_column_below
+            (rng, static_cast<double>(static_cast<T>(hd.base + m))))
+            b = m;
+        else
+            e = m - 1;
+    }
+    hi = b;
+    return (lo <= hi);
+} // _ibis_column_packedBounds
+
+/// Check the encoded copy of a data file.  Returns the number of blocks if
+/// the file is an encoded copy of a data file with @c nrows values of
+/// type @c t, otherwise a negative number.
+static long _ibis_column_packedCheck(const ibis::fileManager::storage &st,
+                                     uint32_t nrows, ibis::TYPE_T t,
+                                     uint32_t &bs) {
+    if (st.bytes() < 32 || std::strncmp(st.begin(), "#IBISPK", 8) != 0)
+        return -1;
+    const uint32_t *hdr = reinterpret_cast<const uint32_t*>(st.begin() + 8);
+    bs = hdr[0];
+    const uint32_t nb = hdr[3];
+    if (bs == 0 || hdr[1] != nrows || hdr[2] != static_cast<uint32_t>(t) ||
+        nb != (nrows + bs - 1) / bs || st.bytes() < 24 + 8 * (nb + 1))
+        return -2;
+    const uint64_t *offs = reinterpret_cast<const uint64_t*>(st.begin() + 24);
+    if (offs[0] != 24 + 8 * (nb + 1) || offs[nb] != st.bytes())
+        return -3;
+    for (uint32_t b = 0; b < nb; ++ b) {
+        if (offs[b+1] < offs[b] + sizeof(_ibis_column_packHead))
+            return -4;
+    }
+    return nb;
+} // _ibis_column_packedCheck
+
+/// Encode all values of a data file.  The byte offsets of the blocks are
+/// recorded in @c offs, which has one more element than the number of
+/// blocks.
+template <typename T>
+static void _ibis_column_packAll(const ibis::array_t<T> &vals, uint32_t bs,
+                                 ibis::array_t<uint64_t> &offs,
+                                 ibis::array_t<uint64_t> &words) {
+    const uint32_t nb = (vals.size() + bs - 1) / bs;
+    const uint64_t start = 24 + 8 * (nb + 1);
+    offs.resize(nb + 1);
+    words.clear();
+    for (uint32_t b = 0; b < nb; ++ b) {
+        offs[b] = start + 8 * words.size();
+        const uint32_t n = (b+1 < nb ? bs : vals.size() - b * bs);
+        _ibis_column_packBlock(vals.begin() + b * bs, n, words);
+    }
+    offs[nb] = start + 8 * words.size();
+} // _ibis_column_packAll
+
+/// Evaluate the range condition on the blocks of the encoded copy marked
+/// in @c need.
+template <typename T>
+static long _ibis_column_packedScan(const ibis::fileManager::storage &st,
+                                    uint32_t nrows, uint32_t bs,
+                                    const std::vector<bool> &need,
+                                    const ibis::qContinuousRange &rng,
+                                    ibis::bitvector &hits) {
+    const uint64_t *offs = reinterpret_cast<const uint64_t*>(st.begin() + 24);
+    ibis::array_t<uint64_t> buf(bs);
+    ibis::bitvector::builder bld(hits);
+    for (uint32_t b = 0; b < need.size(); ++ b) {
+        if (! need[b])
+            continue;
+
+        const _ibis_column_packHead &hd =
+            *reinterpret_cast<const _ibis_column_packHead*>
+            (st.begin() + offs[b]);
+        uint64_t lo = 0, hi = 0;
+        const int ierr = _ibis_column_packedBounds<T>(rng, hd, lo, hi);
+        if (ierr < 0)
+            return -1;
+        if (ierr == 0)
+            continue;
+
+        const uint32_t n = (b * bs + bs <= nrows ? bs : nrows - b * bs);
+        if (lo == 0 && hi == hd.range) { // every row is a hit
+            _ibis_column_setRun(bld, b * bs, n);
+        }
+        else {
+            _ibis_column_scanBlock
+                (hd, reinterpret_cast<const uint64_t*>(&hd + 1), n, b * bs,
+                 lo, hi, buf.begin(), bld);
+        }
+    }
+    bld.finish(nrows);
+    return 0;
+} // _ibis_column_packedScan
+
+/// Is @c T the type @c t?  Only the integer types are used in the
+/// encoded copies of the data files.
+template <typename T>
+static bool _ibis_column_packedType(ibis::TYPE_T t) {
+    if (! std::numeric_limits<T>::is_integer)
+        return false;
+    switch (t) {
+    case ibis::BYTE:
+        return sizeof(T) == 1 && std::numeric_limits<T>::is_signed;
+    case ibis::UBYTE:
+        return sizeof(T) == 1 && ! std::numeric_limits<T>::is_signed;
+    case ibis::SHORT:
+        return sizeof(T) == 2 && std::numeric_limits<T>::is_signed;
+    case ibis::USHORT:
+        return sizeof(T) == 2 && ! std::numeric_limits<T>::is_signed;
+    case ibis::INT:
+        return sizeof(T) == 4 && std::numeric_limits<T>::is_signed;
+    case ibis::UINT:
+        return sizeof(T) == 4 && ! std::numeric_limits<T>::is_signed;
+    case ibis::LONG:
+        return sizeof(T) == 8 && std::numeric_limits<T>::is_signed;
+    case ibis::ULONG:
+        return sizeof(T) == 8 && ! std::numeric_limits<T>::is_signed;
+    default:
+        return false;
+    }
+} // _ibis_column_packedType
+
+/// Select the values marked 1 in @c mask from the encoded copy of the data
+/// file @c dfn.  Only the blocks containing selected rows are decoded.
+/// Returns the number of values selected, or a negative number if there is
+/// no usable encoded copy.
+template <typename T>
+static long _ibis_column_packedSelect(const char *dfn,
+                                      const ibis::bitvector &mask,
+                                      ibis::array_t<T> &vals) {
+    std::string pfile = dfn;
+    pfile += ".pak";
+    if (ibis::util::getFileSize(pfile.c_str()) <= 24)
+        return -2;
+    ibis::fileManager::storage *st = 0;
+    if (ibis::fileManager::instance().getFile(pfile.c_str(), &st) != 0 ||
+        st == 0)
+        return -3;
+    ibis::array_t<char> guard(st, 0, st->bytes()); // hold on to the storage
+    if (st->bytes() < 24)
+        return -4;
+    const ibis::TYPE_T t = static_cast<ibis::TYPE_T>
+        (reinterpret_cast<const uint32_t*>(st->begin() + 8)[2]);
+    uint32_t bs = 0;
+    if (! _ibis_column_packedType<T>(t) ||
+        _ibis_column_packedCheck(*st, mask.size(), t, bs) < 0)
+        return -5;
+
+    const uint64_t *offs = reinterpret_cast<const uint64_t*>(st->begin() + 24);
+    ibis::array_t<uint64_t> offsets(bs);
+    ibis::array_t<T> buf(bs);
+    uint32_t cur = UINT_MAX; // the block in buf
+    vals.clear();
+    vals.reserve(mask.cnt());
+    ibis::bitvector::word_t starts[256], ends[256];
+    ibis::bitvector::decoder dec(mask);
+    for (uint32_t nrng = dec.ranges(starts, ends, 256); nrng > 0;
+         nrng = dec.ranges(starts, ends, 256)) {
+        for (uint32_t j = 0; j < nrng; ++ j) {
+            for (uint32_t i = starts[j]; i < ends[j]; ) {
+                const uint32_t b = i / bs;
+                const uint32_t n = (b * bs + bs <= mask.size() ? bs :
+                                    mask.size() - b * bs);
+                if (b != cur) {
+                    const _ibis_column_packHead &hd =
+                        *reinterpret_cast<const _ibis_column_packHead*>
+                        (st->begin() + offs[b]);
+                    _ibis_column_unpackBlock
+                        (hd, reinterpret_cast<const uint64_t*>(&hd + 1), n,
+                         offsets.begin());
+                    for (uint32_t k = 0; k < n; ++ k)
+                        buf[k] = static_cast<T>(hd.base + offsets[k]);
+                    cur = b;
+                }
+                const uint32_t stop = (ends[j] <= b * bs + n ? ends[j] :
+                                       b * bs + n);
+                vals.insert(vals.end(), buf.begin() + (i - b * bs),
+                            buf.begin() + (stop - b * bs));
+                i = stop;
+            }
+        }
+    }
+    return vals.size();
+} // _ibis_column_packedSelect
+
+/// The encoded copies exist only for the data files of integer columns.
+template <typename T>
+static long _ibis_column_selectPacked(const char*, const ibis::bitvector&,
+                                      ibis::array_t<T>&) {
+    return -1;
+}
+static long _ibis_column_selectPacked(const char *dfn,
+                                      const ibis::bitvector &mask,
+                                      ibis::array_t<signed char> &vals) {
+    return _ibis_column_packedSelect(dfn, mask, vals);
+}
+static long _ibis_column_selectPacked(const char *dfn,
+                                      const ibis::bitvector &mask,
+                                      ibis::array_t<unsigned char> &vals) {
+    return _ibis_column_packedSelect(dfn, mask, vals);
+}
+static long _ibis_column_selectPacked(const char *dfn,
+                                      const ibis::bitvector &mask,
+                                      ibis::array_t<int16_t> &vals) {
+    return _ibis_column_packedSelect(dfn, mask, vals);
+}
+static long _ibis_column_selectPacked(const char *dfn,
+                                      const ibis::bitvector &mask,
+                                      ibis::array_t<uint16_t> &vals) {
+    return _ibis_column_packedSelect(dfn, mask, vals);
+}
+static long _ibis_column_selectPacked(const char *dfn,
+                                      const ibis::bitvector &mask,
+                                      ibis::array_t<int32_t> &vals) {
+    return _ibis_column_packedSelect(dfn, mask, vals);
+}
+static long _ibis_column_selectPacked(const char *dfn,
+                                      const ibis::bitvector &mask,
+                                      ibis::array_t<uint32_t> &vals) {
+    return _ibis_column_packedSelect(dfn, mask, vals);
+}
+static long _ibis_column_selectPacked(const char *dfn,
+                                      const ibis::bitvector &mask,
+                                      ibis::array_t<int64_t> &vals) {
+    return _ibis_column_packedSelect(dfn, mask, vals);
+}
+static long _ibis_column_selectPacked(const char *dfn,
+                                      const ibis::bitvector &mask,
+                                      ibis::array_t<uint64_t> &vals) {
+    return _ibis_column_packedSelect(dfn, mask, vals);
+} // _ibis_column_selectPacked
+
+/// Write an encoded copy of the data file @c fname.  The values are
+/// divided into blocks and each block is stored with one of the
+/// lightweight encodings, frame-of-reference, delta or run-length, with
+/// the results bit-packed.  The encoded copy is written to the file named
+/// @c fname with the extension ".pak" and is used by encodedRange and by
+/// selectValues to read fewer bytes than the raw data file.  Only the
+/// integer types are encoded.
+///
+/// The encoded copies are optional, they are written only if the
+/// parameter encoding.enable is true and the encoded copy is at least a
+/// quarter smaller than the data file.  The block size is taken from the
+/// parameter encoding.blockSize with a default of 8192.
+///
+/// Returns the number of blocks written, 0 if no encoded copy is written
+/// and a negative number to indicate error.
+int ibis::column::writeEncoded(const char *fname, ibis::TYPE_T t) {
+    if (fname == 0 || *fname == 0)
+        return -1;
+    removeEncoded(fname);
+    if (! ibis::gParameters().isTrue("encoding.enable"))
+        return 0;
+
+    uint32_t bs = static_cast<uint32_t>
+        (ibis::gParameters().getNumber("encoding.blockSize"));
+    if (bs == 0)
+        bs = 8192;
+    const off_t fsize = ibis::util::getFileSize(fname);
+    int elem = 0;
+    switch (t) {
+    case ibis::BYTE:
+    case ibis::UBYTE:
+        elem = 1; break;
+    case ibis::SHORT:
+    case ibis::USHORT:
+        elem = 2; break;
+    case ibis::INT:
+    case ibis::UINT:
+        elem = 4; break;
+    case ibis::LONG:
+    case ibis::ULONG:
+        elem = 8; break;
+    default:
+        return 0;
+    }
+    if (fsize < elem)
+        return 0;
+
+    const uint32_t nrows = fsize / elem;
+    const off_t nbytes = static_cast<off_t>(nrows) * elem;
+    ibis::array_t<uint64_t> offs, words;
+    try {
+        switch (t) {
+        case ibis::BYTE: {
+            ibis::array_t<signed char> vals(fname, 0, nbytes);
+            _ibis_column_packAll(vals, bs, offs, words);
+            break;}
+        case ibis::UBYTE: {
+            ibis::array_t<unsigned char> vals(fname, 0, nbytes);
+            _ibis_column_packAll(vals, bs, offs, words);
+            break;}
+        case ibis::SHORT: {
+            ibis::array_t<int16_t> vals(fname, 0, nbytes);
+            _ibis_column_packAll(vals, bs, offs, words);
+            break;}
+        case ibis::USHORT: {
+            ibis::array_t<uint16_t> vals(fname, 0, nbytes);
+            _ibis_column_packAll(vals, bs, offs, words);
+            break;}
+        case ibis::INT: {
+            ibis::array_t<int32_t> vals(fname, 0, nbytes);
+            _ibis_column_packAll(vals, bs, offs, words);
+            break;}
+        case ibis::UINT: {
+            ibis::array_t<uint32_t> vals(fname, 0, nbytes);
+            _ibis_column_packAll(vals, bs, offs, words);
+            break;}
+        case ibis::LONG: {
+            ibis::array_t<int64_t> vals(fname, 0, nbytes);
+            _ibis_column_packAll(vals, bs, offs, words);
+            break;}
+        case ibis::ULONG: {
+            ibis::array_t<uint64_t> vals(fname, 0, nbytes);
+            _ibis_column_packAll(vals, bs, offs, words);
+            break;}
+        default:
+            return 0;
+        }
+    }
+    catch (...) {
+        LOGGER(ibis::gVerbose > 1)
+            << "Warning -- column::writeEncoded failed to read " << fname;
+        return -2;
+    }
+    const uint32_t nb = offs.size() - 1;
+    if (nb != (nrows + bs - 1) / bs)
+        return -3;
+    if (4 * offs.back() > 3 * static_cast<uint64_t>(nbytes)) {
+        LOGGER(ibis::gVerbose > 4)
+            << "column::writeEncoded skips " << fname << " because the "
+            "encoded copy would take " << offs.back() << " bytes, the data "
+            "file takes " << nbytes;
+        return 0;
+    }
+
+    std::string pfile = fname;
+    pfile += ".pak";
+    off_t ierr = 0;
+    {
+        int fdes = UnixOpen(pfile.c_str(), OPEN_WRITENEW, OPEN_FILEMODE);
+        if (fdes < 0) {
+            LOGGER(ibis::gVerbose > 1)
+                << "Warning -- column::writeEncoded failed to open "
+                << pfile << " for writing";
+            return -4;
+        }
+        IBIS_BLOCK_GUARD(UnixClose, fdes);
+#if defined(_WIN32) && defined(_MSC_VER)
+        (void)_setmode(fdes, _O_BINARY);
+#endif
+
+        // header: 8 bytes of signature, the block size, the number of
+        // rows, the data type and the number of blocks
+        const char sig[8] = {'#', 'I', 'B', 'I', 'S', 'P', 'K', 0};
+        const uint32_t hdr[4] = {bs, nrows, static_cast<uint32_t>(t), nb};
+        ierr = UnixWrite(fdes, sig, 8);
+        ierr += UnixWrite(fdes, hdr, sizeof(hdr));
+        ierr += UnixWrite(fdes, offs.begin(), sizeof(uint64_t) * offs.size());
+        ierr += UnixWrite(fdes, words.begin(),
+                          sizeof(uint64_t) * words.size());
+    }
+    if (ierr != static_cast<off_t>(offs.back())) {
+        LOGGER(ibis::gVerbose > 1)
+            << "Warning -- column::writeEncoded failed to write " << pfile;
+        (void) remove(pfile.c_str());
+        return -5;
+    }
+    LOGGER(ibis::gVerbose > 4)
+        << "column::writeEncoded wrote " << nb << " blocks of " << bs
+        << " rows to " << pfile << " (" << offs.back() << " bytes, the data "
+        "file has " << nbytes << " bytes)";
+    return nb;
+} // ibis::column::writeEncoded
+
+/// Remove the encoded copy of the data file @c fname.  This must be
+/// called whenever the content of the data file is changed without
+/// writing a new encoded copy.
+void ibis::column::removeEncoded(const char *fname) {
+    if (fname == 0 || *fname == 0)
+        return;
+    std::string pfile = fname;
+    pfile += ".pak";
+    ibis::fileManager::instance().flushFile(pfile.c_str());
+    (void) remove(pfile.c_str());
+} // ibis::column::removeEncoded
+
+/// Evaluate the range condition @c cmp on the encoded copy of the data
+/// file.  Only the blocks with rows marked 1 in @c mask are examined, and
+/// the values are compared in their packed form, see writeEncoded.  On
+/// successful completion, @c hits has one bit for each row of the data
+/// partition and the return value is the number of hits.
+///
+/// Returns a negative number if there is no usable encoded copy, in which
+/// case the caller is expected to scan the data file.
+long ibis::column::encodedRange(const ibis::qContinuousRange &cmp,
+                                const ibis::bitvector &mask,
+                                ibis::bitvector &hits) const {
+    if (thePart == 0 || ! isInteger() || mask.size() != thePart->nRows())
+        return -1;
+    if (cmp.leftOperator() == ibis::qExpr::OP_UNDEFINED &&
+        cmp.rightOperator() == ibis::qExpr::OP_UNDEFINED)
+        return -1;
+
+    std::string pfile;
+    if (dataFileName(pfile) == 0)
+        return -1;
+    pfile += ".pak";
+    if (ibis::util::getFileSize(pfile.c_str()) <= 24)
+        return -2;
+
+    ibis::fileManager::storage *st = 0;
+    if (ibis::fileManager::instance().getFile(pfile.c_str(), &st) != 0 ||
+        st == 0)
+        return -3;
+    ibis::array_t<char> guard(st, 0, st->bytes()); // hold on to the storage
+    uint32_t bs = 0;
+    const long nb = _ibis_column_packedCheck(*st, mask.size(), m_type, bs);
+    if (nb < 0) {
+        LOGGER(ibis::gVerbose > 2)
+            << "Warning -- column[" << fullname() << "]::encodedRange "
+            "will not use " << pfile << " because it is not a valid "
+            "encoded copy of " << thePart->nRows() << " rows";
+        return -4;
+    }
+
+    // the blocks with some rows to be examined
+    std::vector<bool> need(nb, false);
+    {
+        ibis::bitvector::word_t starts[256], ends[256];
+        ibis::bitvector::decoder dec(mask);
+        for (uint32_t nrng = dec.ranges(starts, ends, 256); nrng > 0;
+             nrng = dec.ranges(starts, ends, 256)) {
+            for (uint32_t j = 0; j < nrng; ++ j) {
+                for (uint32_t b = starts[j] / bs; b * bs < ends[j]; ++ b)
+                    need[b] = true;
+            }
+        }
+    }
+
+    long ierr;
+    switch (m_type) {
+    case ibis::BYTE:
+        ierr = _ibis_column_packedScan<signed char>
+            (*st, mask.size(), bs, need, cmp, hits);
+        break;
+    case ibis::UBYTE:
+        ierr = _ibis_column_packedScan<unsigned char>
+            (*st, mask.size(), bs, need, cmp, hits);
+        break;
+    case ibis::SHORT:
+        ierr = _ibis_column_packedScan<int16_t>
+            (*st, mask.size(), bs, need, cmp, hits);
+        break;
+    case ibis::USHORT:
+        ierr = _ibis_column_packedScan<uint16_t>
+            (*st, mask.size(), bs, need, cmp, hits);
+        break;
+    case ibis::INT:
+        ierr = _ibis_column_packedScan<int32_t>
+            (*st, mask.size(), bs, need, cmp, hits);
+        break;
+    case ibis::UINT:
+        ierr = _ibis_column_packedScan<uint32_t>
+            (*st, mask.size(), bs, need, cmp, hits);
+        break;
+    case ibis::LONG:
+        ierr = _ibis_column_packedScan<int64_t>
+            (*st, mask.size(), bs, need, cmp, hits);
+        break;
+    case ibis::ULONG:
+        ierr = _ibis_column_packedScan<uint64_t>
+            (*st, mask.size(), bs, need, cmp, hits);
+        break;
+    default:
+        ierr = -1;
+        break;
+    }
+    if (ierr < 0) {
+        hits.clear();
+        return -5;
+    }
+
+    hits &= mask;
+    LOGGER(ibis::gVerbose > 5)
+        << "column[" << fullname() << "]::encodedRange evaluated " << cmp
+        << " on " << pfile << " and found " << hits.cnt() << " hits";
+    return hits.cnt();
+} // ibis::column::encodedRange
+
 /// Name of the data file in the given data directory.  If the directory
 /// name is not given, the directory is assumed to be the current data
 /// directory of the data partition.  There is no need for the caller to
@@ -4669,6 +5864,18 @@ long ibis::column::selectValuesT(const char* dfn,
             ierr = vals.size();
         return ierr;
     }
+    if (dfn != 0 && *dfn != 0) {
+        // decode only the blocks of the encoded copy that contain the
+        // selected rows
+        ierr = _ibis_column_selectPacked(dfn, mask, vals);
+        if (ierr >= 0) {
+            LOGGER(ibis::gVerbose > 4)
+                << evt << " got " << ierr << " values from the encoded "
+                "copy of " << dfn;
+            return ierr;
+        }
+        vals.clear();
+    }
 
     try {
         vals.reserve(tot);
@@ -4694,6 +5901,8 @@ long ibis::column::selectValuesT(const char* dfn,
             thePart != 0 ? thePart->accessHint(mask, sizeof(T))
             : ibis::fileManager::MMAP_LARGE_FILES;
         ierr = ibis::fileManager::instance().tryGetFile(dfn, incore, apref);
+        if (ierr >= 0 && incore.getStorage() != 0)
+            ibis::part::adviseAccess(*incore.getStorage(), mask, sizeof(T));
     }
     else {
         ierr = getValuesArray(&incore);
@@ -4713,24 +5922,14 @@ long ibis::column::selectValuesT(const char* dfn,
         // destructor of ibis::fileManager::incore
         const uint32_t nr = (incore.size() <= mask.size() ?
                              incore.size() : mask.size());
-        for (ibis::bitvector::indexSet ix = mask.firstIndexSet();
-             ix.nIndices() > 0; ++ ix) {
-            const ibis::bitvector::word_t *ixval = ix.indices();
-            if (ix.isRange()) {
-                const uint32_t stop = (ixval[1] <= nr ? ixval[1] : nr);
-                for (uint32_t i = *ixval; i < stop; ++ i) {
-                    vals.push_back(incore[i]);
-                }
-            }
-            else {
-                for (uint32_t j = 0; j < ix.nIndices(); ++ j) {
-                    if (ixval[j] < nr) {
-                        vals.push_back(incore[ixval[j]]);
-                    }
-                    else {
-                        break;
-                    }
-                }
+        ibis::bitvector::word_t starts[256], ends[256];
+        ibis::bitvector::decoder dec(mask);
+        for (uint32_t nrng = dec.ranges(starts, ends, 256); nrng > 0;
+             nrng = dec.ranges(starts, ends, 256)) {
+            for (uint32_t j = 0; j < nrng && starts[j] < nr; ++ j) {
+                const uint32_t stop = (ends[j] <= nr ? ends[j] : nr);
+                vals.insert(vals.end(), incore.begin()+starts[j],
+                            incore.begin()+stop);
             }
         }
         LOGGER(ibis::gVerbose > 4)
@@ -4893,6 +6092,8 @@ long ibis::column::selectValuesT(const char *dfn,
             thePart != 0 ? thePart->accessHint(mask, sizeof(T))
             : ibis::fileManager::MMAP_LARGE_FILES;
         ierr = ibis::fileManager::instance().tryGetFile(dfn, incore, apref);
+        if (ierr >= 0 && incore.getStorage() != 0)
+            ibis::part::adviseAccess(*incore.getStorage(), mask, sizeof(T));
     }
     else {
         ierr = getValuesArray(&incore);
@@ -6098,10 +7299,15 @@ long ibis::column::evaluateRange(const ibis::qContinuousRange& cmp,
                     // Using the index only if the cost of using the index
                     // (icost) is less than the cost of using the sequential
                     // scan (scost).  Both costs are estimated based on the
-                    // expected number of bytes to be accessed.
-                    const double icost = idx->estimateCost(cmp);
-                    const double scost = ibis::fileManager::pageSize() *
-                        ibis::part::countPages(mask, elementSize()) +
+                    // expected number of bytes to be accessed, and weighted
+                    // with the constants measured by
+                    // ibis::part::calibrateCosts if available.
+                    const double icost =
+                        ibis::part::indexCost(idx->estimateCost(cmp));
+                    const double scost = ibis::part::scanCost
+                        (ibis::fileManager::pageSize() *
+                         ibis::part::countPages(mask, elementSize()),
+                         mask.cnt()) +
                         8.0 * mask.size() / ibis::fileManager::pageSize();
                     LOGGER(ibis::gVerbose > 2)
                         << evt << " -- estimated cost with index = "
@@ -6259,9 +7465,12 @@ long ibis::column::evaluateAndSelect(const ibis::qContinuousRange& cmp,
         if (mask.size() == mask.cnt()) { // directly use index
             indexLock lock(this, "evaluateAndSelect");
             if (idx != 0 && idx->getNRows() == thePart->nRows()) {
-                const double icost = idx->estimateCost(cmp);
-                const double scost = ibis::fileManager::pageSize() *
-                    ibis::part::countPages(mask, elementSize());
+                const double icost =
+                    ibis::part::indexCost(idx->estimateCost(cmp));
+                const double scost = ibis::part::scanCost
+                    (ibis::fileManager::pageSize() *
+                     ibis::part::countPages(mask, elementSize()),
+                     mask.cnt());
                 LOGGER(ibis::gVerbose > 2)
                     << evt << " -- estimated cost with index = "
                     << icost << ", with sequential scan = " << scost;
@@ -6524,6 +7733,14 @@ long ibis::column::estimateRange(const ibis::qContinuousRange& cmp,
                 low.adjustSize(0, thePart->nRows());
             }
         }
+        else if (zoneMapRange(cmp, low, high) >= 0) {
+            // no index, use the zone map to narrow the candidates
+            ibis::bitvector msk;
+            getNullMask(msk);
+            high |= low;
+            high &= msk;
+            low &= msk;
+        }
         else if (thePart != 0) {
             low.set(0, thePart->nRows());
             getNullMask(high);
@@ -6619,12 +7836,12 @@ double ibis::column::estimateCost(const ibis::qContinuousRange& cmp) const {
     double ret;
     indexLock lock(this, "estimateCost");
     if (idx != 0) {
-        ret = idx->estimateCost(cmp);
+        ret = ibis::part::indexCost(idx->estimateCost(cmp));
     }
     else {
+        const double nr = (thePart != 0 ? thePart->nRows() : 0xFFFFFFFFU);
         ret = elementSize();
-        ret = static_cast<double>(thePart != 0 ? thePart->nRows() :
-                                  0xFFFFFFFFU) * (ret > 0.0 ? ret : 32.0);
+        ret = ibis::part::scanCost(nr * (ret > 0.0 ? ret : 32.0), nr);
     }
     return ret;
 } // ibis::column::estimateCost
@@ -6636,12 +7853,12 @@ double ibis::column::estimateCost(const ibis::qDiscreteRange& cmp) const {
     double ret;
     indexLock lock(this, "estimateCost");
     if (idx != 0) {
-        ret = idx->estimateCost(cmp);
+        ret = ibis::part::indexCost(idx->estimateCost(cmp));
     }
     else {
+        const double nr = (thePart != 0 ? thePart->nRows() : 0xFFFFFFFFU);
         ret = elementSize();
-        ret = static_cast<double>(thePart != 0 ? thePart->nRows() :
-                                  0xFFFFFFFFU) * (ret > 0.0 ? ret : 32.0);
+        ret = ibis::part::scanCost(nr * (ret > 0.0 ? ret : 32.0), nr);
         double width = 1.0 + (cmp.rightBound()<upper?cmp.rightBound():upper)
             - (cmp.leftBound()>lower?cmp.leftBound():lower);
         if (upper > lower && width >= 1.0 && width < (1.0+upper-lower)) {
@@ -6653,7 +7870,8 @@ double ibis::column::estimateCost(const ibis::qDiscreteRange& cmp) const {
 
 /// Compute the locations of the rows can not be decided by the index.
 /// Returns the fraction of rows might satisfy the specified range
-/// condition.  If no index, nothing can be decided.
+/// condition.  If no index, the zone map is used if available, otherwise
+/// nothing can be decided.
 float ibis::column::getUndecidable(const ibis::qContinuousRange& cmp,
                                    ibis::bitvector& iffy) const {
     if (cmp.leftOperator() == ibis::qExpr::OP_UNDEFINED &&
@@ -6663,9 +7881,18 @@ float ibis::column::getUndecidable(const ibis::qContinuousRange& cmp,
     float ret = 1.0;
     try {
         indexLock lock(this, "getUndecidable");
+        ibis::bitvector sure;
         if (idx != 0) {
             ret = idx->undecidable(cmp, iffy);
         }
+        else if (zoneMapRange(cmp, sure, iffy) >= 0) {
+            // the blocks marked maybe by the zone map are undecidable
+            ibis::bitvector msk;
+            getNullMask(msk);
+            iffy &= msk;
+            ret = (iffy.size() > 0 ?
+                   static_cast<float>(iffy.cnt()) / iffy.size() : 0.0);
+        }
         else {
             getNullMask(iffy);
             ret = 1.0; // everything might satisfy the condition
@@ -6723,15 +7950,24 @@ long ibis::column::estimateRange(const ibis::qDiscreteRange& cmp) const {
 } // ibis::column::estimateRange
 
 // compute the rows that can not be decided by the index, if no index,
-// nothing can be decided.
+// the zone map is used if available, otherwise nothing can be decided.
 float ibis::column::getUndecidable(const ibis::qDiscreteRange& cmp,
                                    ibis::bitvector& iffy) const {
     float ret = 1.0;
     try {
         indexLock lock(this, "getUndecidable");
+        ibis::bitvector sure;
         if (idx != 0) {
             ret = idx->undecidable(cmp, iffy);
         }
+        else if (zoneMapRange(cmp, sure, iffy) >= 0) {
+            // the blocks marked maybe by the zone map are undecidable
+            ibis::bitvector msk;
+            getNullMask(msk);
+            iffy &= msk;
+            ret = (iffy.size() > 0 ?
+                   static_cast<float>(iffy.cnt()) / iffy.size() : 0.0);
+        }
         else {
             getNullMask(iffy);
             ret = 1.0; // everything might satisfy the condition
@@ -6852,9 +8088,9 @@ long ibis::column::estimateRange(const ibis::qIntHod& cmp,
 } // ibis::column::estimateRange
 
 double ibis::column::estimateCost(const ibis::qIntHod& cmp) const {
+    const double nr = (thePart != 0 ? thePart->nRows() : 0xFFFFFFFFU);
     double ret = elementSize();
-    ret = static_cast<double>(thePart != 0 ? thePart->nRows() :
-                              0xFFFFFFFFU) * (ret > 0.0 ? ret : 32.0);
+    ret = ibis::part::scanCost(nr * (ret > 0.0 ? ret : 32.0), nr);
     return ret;
 } // ibis::column::estimateCost
 
@@ -6966,9 +8202,9 @@ long ibis::column::estimateRange(const ibis::qUIntHod& cmp,
 } // ibis::column::estimateRange
 
 double ibis::column::estimateCost(const ibis::qUIntHod& cmp) const {
+    const double nr = (thePart != 0 ? thePart->nRows() : 0xFFFFFFFFU);
     double ret = elementSize();
-    ret = static_cast<double>(thePart != 0 ? thePart->nRows() :
-                              0xFFFFFFFFU) * (ret > 0.0 ? ret : 32.0);
+    ret = ibis::part::scanCost(nr * (ret > 0.0 ? ret : 32.0), nr);
     return ret;
 } // ibis::column::estimateCost
 
@@ -7260,6 +8496,8 @@ long ibis::column::append(const char* dt, const char* df,
                        "%lu records are valid", filename.c_str(),
                        static_cast<long unsigned>(mtot.size()));
     }
+    (void) writeZoneMap(to.c_str(), m_type, mtot);
+    (void) writeEncoded(to.c_str(), m_type);
     if (thePart == 0 || thePart->currentDataDir() == 0)
         return ret;
     if (std::strcmp(dt, thePart->currentDataDir()) == 0) {
@@ -7703,6 +8941,8 @@ long ibis::column::writeData(const char *dir, uint32_t nold, uint32_t nnew,
     uint32_t ninfile=0;
     sprintf(fn, "%s%c%s", dir, FASTBIT_DIRSEP, m_name.c_str());
     ibis::fileManager::instance().flushFile(fn);
+    removeZoneMap(fn);
+    removeEncoded(fn);
 
     FILE *fdat = fopen(fn, "ab");
     if (fdat == 0) {
@@ -8338,6 +9578,8 @@ long ibis::column::saveSelected(const ibis::bitvector& sel, const char *dest,
             }
         }
         ibis::fileManager::instance().flushFile(fname.c_str());
+        removeZoneMap(fname.c_str());
+        removeEncoded(fname.c_str());
         FILE* fptr = fopen(fname.c_str(), "r+b");
         if (fptr == 0) {
             if (ibis::gVerbose > -1)
@@ -8482,6 +9724,8 @@ long ibis::column::saveSelected(const ibis::bitvector& sel, const char *dest,
             return -6;
         }
         ibis::fileManager::instance().flushFile(dfname.c_str());
+        removeZoneMap(dfname.c_str());
+        removeEncoded(dfname.c_str());
         FILE* dfptr = fopen(dfname.c_str(), "wb");
         if (dfptr == 0) {
             if (ibis::gVerbose > 0)
@@ -8618,6 +9862,8 @@ long ibis::column::truncateData(const char* dir, uint32_t nent,
             nbyt = ptr - arr->begin();
             delete arr; // no longer need the array_t
             ibis::fileManager::instance().flushFile(fn);
+            removeZoneMap(fn);
+            removeEncoded(fn);
 
             if (cnt < nent) { // current file does not have enough entries
                 memset(buf, 0, MAX_LINE);
@@ -121,6 +121,17 @@ public:
     virtual void computeMinMax(const char *dir,
 			       double& min, double &max, bool &asc) const;
 
+    static int  writeZoneMap(const char *fname, ibis::TYPE_T t,
+			     const ibis::bitvector &msk);
+    static void removeZoneMap(const char *fname);
+    long zoneMapRange(const ibis::qRange &cmp, ibis::bitvector &sure,
+		      ibis::bitvector &maybe) const;
+    static int  writeEncoded(const char *fname, ibis::TYPE_T t);
+    static void removeEncoded(const char *fname);
+    long encodedRange(const ibis::qContinuousRange &cmp,
+		      const ibis::bitvector &mask,
+		      ibis::bitvector &hits) const;
+
     virtual int  attachIndex(double *, uint64_t, int64_t *, uint64_t,
                              void *, FastBitReadBitmaps) const;
     virtual int  attachIndex(double *, uint64_t, int64_t *, uint64_t,
@@ -205,6 +205,7 @@ int ibis::countQuery::estimate() {
         return -1;
     }
     ibis::util::timer mytime("countQuery::estimate", 2);
+    ibis::fileManager::arena pool("countQuery::estimate");
 #ifndef DONOT_REORDER_EXPRESSION
     if (conds.getExpr() != 0 && false == conds->directEval()) {
         ibis::query::weight wt(mypart);
@@ -212,6 +213,7 @@ int ibis::countQuery::estimate() {
     }
 #endif
 
+    mypart->prefetch(conds.getExpr());
     ibis::bitvector mask;
     conds.getNullMask(*mypart, mask);
     if (m_sel != 0) {
@@ -298,8 +300,11 @@ int ibis::countQuery::evaluate() {
     }
     int ierr;
     ibis::util::timer mytime("countQuery::evaluate", 1);
+    ibis::fileManager::arena pool("countQuery::evaluate");
 
     if (hits == 0) { // have not performed an estimate
+        // start reading the files of all columns involved
+        mypart->prefetch(conds.getExpr());
         ibis::bitvector mask;
         conds.getNullMask(*mypart, mask);
         if (m_sel != 0) {
@@ -372,6 +377,61 @@ int ibis::countQuery::evaluate() {
     return 0;
 } // ibis::countQuery::evaluate
 
+/// Compute the number of hits.  If the query has already been evaluated,
+/// this is the same as getNumHits.  Otherwise, the query expression is
+/// evaluated in the count-only mode, where the last level of the
+/// expression only counts the hits and never forms the hit vector.  The
+/// hit vector is not kept, a later call to evaluate will recompute it.
+///
+/// It returns a negative number to indicate error.
+long ibis::countQuery::countHits() {
+    if (hits != 0) {
+        if (cand != 0 && cand != hits) { // only an estimate is available
+            int ierr = evaluate();
+            if (ierr < 0)
+                return ierr;
+        }
+        return hits->cnt();
+    }
+    if (mypart == 0 || mypart->nRows() == 0 || mypart->nColumns() == 0) {
+        LOGGER(ibis::gVerbose > 1)
+            << "Warning -- countQuery::countHits() can not proceed on an "
+            "empty data partition";
+        return -1;
+    }
+    ibis::util::timer mytime("countQuery::countHits", 1);
+
+    ibis::bitvector mask;
+    conds.getNullMask(*mypart, mask);
+    if (m_sel != 0) {
+        ibis::bitvector tmp;
+        m_sel->getNullMask(*mypart, tmp);
+        if (mask.size() > 0)
+            mask &= tmp;
+        else
+            mask.swap(tmp);
+    }
+    if (mask.size() != mypart->nRows())
+        mask.adjustSize(mypart->nRows(), mypart->nRows());
+    if (conds.getExpr() == 0) // everything is a hit
+        return mask.cnt();
+
+#ifndef DONOT_REORDER_EXPRESSION
+    if (! conds->directEval()) {
+        ibis::query::weight wt(mypart);
+        conds->reorder(wt);
+    }
+#endif
+    long cnt = doCount(conds.getExpr(), mask);
+    if (cnt < 0)
+        return cnt - 20;
+
+    LOGGER(ibis::gVerbose > 0)
+        << "From " << mypart->name() << " Where " << conds << " --> "
+        << cnt;
+    return cnt;
+} // ibis::countQuery::countHits
+
 /// A negative number will be returned if the query has not been evaluated.
 long ibis::countQuery::getNumHits() const {
     long nHits = (hits != 0 && (cand == 0 || cand == hits) ?
@@ -1196,6 +1256,113 @@ int ibis::countQuery::doEvaluate(const ibis::qExpr* term,
     return ierr;
 } // ibis::countQuery::doEvaluate
 
+/// Count the hits of a term under the mask.  The operands of the logical
+/// operators are evaluated as in doEvaluate, however the result of the
+/// operator itself is only counted.  The conjunctions pass the hits of
+/// the left operand as the mask for the right operand, so that only the
+/// last operand is counted, and the operands of a chain of OR operators
+/// are counted together with bitvector::countOr.
+///
+/// It returns the number of hits, or a negative number to indicate error.
+long ibis::countQuery::doCount(const ibis::qExpr* term,
+                               const ibis::bitvector& mask) const {
+    if (term == 0) // no hits
+        return 0;
+    const long nmask = mask.cnt();
+    if (nmask == 0) // no hits
+        return 0;
+    LOGGER(ibis::gVerbose > 7)
+        << "countQuery::doCount -- starting to count " << *term;
+
+    long cnt = 0;
+    int ierr = 0;
+    bool unmasked = false; // ht is computed without the mask
+    ibis::bitvector ht;
+    switch (term->getType()) {
+    case ibis::qExpr::LOGICAL_NOT: {
+        cnt = doCount(term->getLeft(), mask);
+        if (cnt >= 0)
+            cnt = nmask - cnt;
+        break;}
+    case ibis::qExpr::LOGICAL_AND: {
+        ierr = doEvaluate(term->getLeft(), mask, ht);
+        if (ierr > 0)
+            cnt = doCount(term->getRight(), ht);
+        else
+            cnt = ierr;
+        break;}
+    case ibis::qExpr::LOGICAL_MINUS: {
+        ierr = doEvaluate(term->getLeft(), mask, ht);
+        if (ierr > 0) {
+            cnt = doCount(term->getRight(), ht);
+            if (cnt >= 0)
+                cnt = static_cast<long>(ht.cnt()) - cnt;
+        }
+        else {
+            cnt = ierr;
+        }
+        break;}
+    case ibis::qExpr::LOGICAL_OR: {
+        std::vector<const ibis::qExpr*> terms;
+        term->extractDisjuncts(terms);
+        std::vector<ibis::bitvector> res(terms.size());
+        ibis::array_t<ibis::bitvector*> ops;
+        ops.reserve(terms.size());
+        for (size_t j = 0; j < terms.size() && ierr >= 0; ++ j) {
+            ierr = doEvaluate(terms[j], mask, res[j]);
+            if (ierr > 0)
+                ops.push_back(&(res[j]));
+        }
+        if (ierr >= 0)
+            cnt = ibis::bitvector::countOr(ops);
+        else
+            cnt = ierr;
+        break;}
+    case ibis::qExpr::STRING: {
+        ierr = mypart->stringSearch
+            (*(reinterpret_cast<const ibis::qString*>(term)), ht);
+        unmasked = true;
+        break;}
+    case ibis::qExpr::ANYSTRING: {
+        ierr = mypart->stringSearch
+            (*(reinterpret_cast<const ibis::qAnyString*>(term)), ht);
+        unmasked = true;
+        break;}
+    case ibis::qExpr::KEYWORD: {
+        ierr = mypart->keywordSearch
+            (*(reinterpret_cast<const ibis::qKeyword*>(term)), ht);
+        unmasked = true;
+        break;}
+    case ibis::qExpr::ALLWORDS: {
+        ierr = mypart->keywordSearch
+            (*(reinterpret_cast<const ibis::qAllWords*>(term)), ht);
+        unmasked = true;
+        break;}
+    case ibis::qExpr::LIKE: {
+        ierr = mypart->patternSearch
+            (*(reinterpret_cast<const ibis::qLike*>(term)), ht);
+        unmasked = true;
+        break;}
+    default: {
+        ierr = doEvaluate(term, mask, ht);
+        cnt = (ierr >= 0 ? static_cast<long>(ht.cnt()) : ierr);
+        break;}
+    }
+    if (unmasked) { // count the hits under the mask
+        if (ierr < 0)
+            cnt = ierr;
+        else if (ht.size() == mask.size())
+            cnt = ht.count(mask);
+        else {
+            ht &= mask;
+            cnt = ht.cnt();
+        }
+    }
+    LOGGER(ibis::gVerbose > 7)
+        << "countQuery::doCount(" << *term << ") --> " << cnt;
+    return cnt;
+} // ibis::countQuery::doCount
+
 // the function to clear most of the resouce consuming parts of a query
 void ibis::countQuery::clear() {
     delete hits;
@@ -57,6 +57,8 @@ public:
     int evaluate();
     /// Return the number of records in the exact solution.
     long getNumHits() const;
+    /// Count the number of hits without keeping the hit vector.
+    long countHits();
     /// Get the row numbers of the hits.
     long getHitRows(std::vector<uint32_t> &rids) const;
     /// Return the pointer to the internal hit vector.  The user should NOT
@@ -83,6 +85,8 @@ protected:
     /// Evaluate one term of a query expression.
     int doEvaluate(const qExpr* term, const ibis::bitvector& mask,
 		   ibis::bitvector& hits) const;
+    /// Count the hits of one term of a query expression.
+    long doCount(const qExpr* term, const ibis::bitvector& mask) const;
     /// Evaluate one term using the base data.
     int doScan(const ibis::qExpr* term, const ibis::bitvector& mask,
 	       ibis::bitvector& ht) const;
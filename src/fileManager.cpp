@@ -27,6 +27,8 @@
 #include <time.h>
 #include <stdexcept>    // std::runtime_error
 #include <iomanip>      // std::setprecision
+#include <fstream>      // std::ifstream, std::ofstream
+#include <algorithm>    // std::sort
 
 #if defined(HAVE_SYS_SYSCTL) || defined(__APPLE__) || defined(__FreeBSD__)
 #include <sys/sysctl.h> // sysctl
@@ -41,6 +43,13 @@
 #if defined(unix) && !defined(_WIN32)
 #include <sys/resource.h>       // getrlimit
 #endif
+#if (HAVE_MMAP+0 > 0) && defined(_POSIX_SHARED_MEMORY_OBJECTS) && \
+    defined(HAVE_GCC_ATOMIC32) && defined(HAVE_GCC_ATOMIC64)
+#include <fcntl.h>              // O_CREAT, O_EXCL
+/// Files read into memory may be shared with other processes through
+/// POSIX shared memory.  See ibis::fileManager::roFile::doShare.
+#define FASTBIT_SHARED_CACHE 1
+#endif
 
 // initialize static varialbes (class members) of fileManager
 time_t ibis::fileManager::hbeat = 0;
@@ -227,8 +236,10 @@ void ibis::fileManager::flushFile(const char* name) {
             LOGGER(ibis::gVerbose > 7)
                 << "fileManager::flushFile -- removing \"" << (*it).first
                 << "\" from the list of mapped files";
-            delete (*it).second;
+            roFile *tmp = (*it).second;
+            unlinkFile(tmp);
             mapped.erase(it);
+            delete tmp;
         }
         else {
             LOGGER(ibis::gVerbose > 2)
@@ -241,8 +252,10 @@ void ibis::fileManager::flushFile(const char* name) {
             LOGGER(ibis::gVerbose > 7)
                 << "fileManager::flushFile -- removing \"" << (*it).first
                 << "\" from the list of incore files";
-            delete (*it).second;
+            roFile *tmp = (*it).second;
+            unlinkFile(tmp);
             incore.erase(it);
+            delete tmp;
         }
         else {
             LOGGER(ibis::gVerbose > 2)
@@ -305,8 +318,10 @@ void ibis::fileManager::flushDir(const char* name) {
                         << "fileManager::flushDir -- removing \""
                         << (*it).first
                         << "\" from the list of mapped files";
-                    delete (*it).second;
+                    roFile *tmp = (*it).second;
+                    unlinkFile(tmp);
                     mapped.erase(it);
+                    delete tmp;
                     ++ deleted;
                 }
             }
@@ -336,8 +351,10 @@ void ibis::fileManager::flushDir(const char* name) {
                         << "fileManager::flushDir -- removing \""
                         << (*it).first
                         << "\" from the list of incore files";
-                    delete (*it).second;
+                    roFile *tmp = (*it).second;
+                    unlinkFile(tmp);
                     incore.erase(it);
+                    delete tmp;
                     ++ deleted;
                 }
             }
@@ -460,11 +477,13 @@ void ibis::fileManager::clear() {
         tmp.reserve(mapped.size()+incore.size());
         for (fileList::const_iterator it=mapped.begin();
              it != mapped.end(); ++it) {
+            unlinkFile((*it).second);
             tmp.push_back((*it).second);
         }
         mapped.clear();
         for (fileList::const_iterator it=incore.begin();
              it != incore.end(); ++it) {
+            unlinkFile((*it).second);
             tmp.push_back((*it).second);
         }
         incore.clear();
@@ -535,8 +554,28 @@ ibis::fileManager& ibis::fileManager::instance() {
 /// will attempt to use memory map on it.  For smaller files, it is more
 /// efficient to read the whole content into memory rather than keeping a
 /// file open.  The default value is defined by the macro FASTBIT_MIN_MAP_SIZE.
+///
+/// The memory used by queries is controlled by two more parameters, which
+/// are read by ibis::fileManager::budget and ibis::table::select.
+/// fileManager.queryBudget is the maximum number of bytes a select
+/// operation may allocate, and fileManager.queryMemory is the total
+/// number of bytes that may be reserved by the select operations running
+/// at the same time.  Neither is limited by default.
+///
+/// \arg fileManager.sharedMemory If true, the files read into memory are
+/// placed in shared memory segments so that the processes of the same
+/// user on the same machine share one copy of each file.  The total size
+/// of the segments is limited by fileManager.sharedBytes, which defaults
+/// to maxBytes.  This is available on systems with POSIX shared memory.
+///
+/// \arg fileManager.manifest The name of a file recording the files used
+/// most.  It is written when the file manager is destroyed and read by
+/// ibis::init to bring the same files back into memory before the first
+/// query arrives.  The number of bytes read by ibis::init is limited by
+/// fileManager.warmUpBytes, which defaults to half of maxBytes.
 ibis::fileManager::fileManager()
-    : page_count(0), minMapSize(FASTBIT_MIN_MAP_SIZE), nwaiting(0) {
+    : page_count(0), minMapSize(FASTBIT_MIN_MAP_SIZE), nwaiting(0),
+      sharedBytes(0), hand(0), stopFetching(false) {
     {
         size_t sz = static_cast<size_t>
             (ibis::gParameters().getNumber("fileManager.maxBytes"));
@@ -551,6 +590,12 @@ ibis::fileManager::fileManager()
         if (sz != 0)
             minMapSize = sz;
     }
+#if defined(FASTBIT_SHARED_CACHE)
+    if (ibis::gParameters().isTrue("fileManager.sharedMemory")) {
+        sharedBytes = static_cast<uint64_t>
+            (ibis::gParameters().getNumber("fileManager.sharedBytes"));
+    }
+#endif
     if (maxBytes < FASTBIT_MIN_MAP_SIZE) {
         LOGGER(ibis::gVerbose > 3 && maxBytes > 0)
             << "user input parameter fileManager.maxBytes (" << maxBytes
@@ -682,19 +727,51 @@ ibis::fileManager::fileManager()
     if (pthread_cond_init(&readCond, 0) != 0)
         throw ibis::bad_alloc("pthread_cond_init(readCond) failed in "
                               "fileManager ctor" IBIS_FILE_LINE);
+    if (pthread_mutex_init(&fetchLock, 0) != 0)
+        throw ibis::bad_alloc("pthread_mutex_init(fetchLock) failed in "
+                              "fileManager ctor" IBIS_FILE_LINE);
+    if (pthread_cond_init(&fetchCond, 0) != 0)
+        throw ibis::bad_alloc("pthread_cond_init(fetchCond) failed in "
+                              "fileManager ctor" IBIS_FILE_LINE);
+    for (unsigned j = 0; j < FASTBIT_FILE_SHARDS; ++ j) {
+        if (pthread_mutex_init(&(shards[j].lock), 0) != 0)
+            throw ibis::bad_alloc("pthread_mutex_init failed on a shard "
+                                  "in fileManager ctor" IBIS_FILE_LINE);
+    }
+
+#if defined(FASTBIT_SHARED_CACHE)
+    if (sharedBytes == 0 &&
+        ibis::gParameters().isTrue("fileManager.sharedMemory"))
+        sharedBytes = maxBytes;
+#endif
 
     LOGGER(ibis::gVerbose > 1)
         << "fileManager initialization complete -- maxBytes="
-        << maxBytes << ", maxOpenFiles=" << maxOpenFiles;
+        << maxBytes << ", maxOpenFiles=" << maxOpenFiles
+        << (sharedBytes > 0 ? ", sharing files with other processes" : "");
 } // ibis::fileManager::fileManager
 
 /// Destructor.
 ibis::fileManager::~fileManager() {
+    {   // stop the prefetch threads
+        ibis::util::mutexLock lck(&fetchLock, "fileManager::dtor");
+        stopFetching = true;
+        pending.clear();
+        (void) pthread_cond_broadcast(&fetchCond);
+    }
+    for (size_t j = 0; j < fetchers.size(); ++ j)
+        (void) pthread_join(fetchers[j], 0);
+    if (ibis::gParameters()["fileManager.manifest"] != 0)
+        (void) saveManifest(ibis::gParameters()["fileManager.manifest"]);
     ibis::util::clear(ibis::datasets);
     clear();
     // (void)pthread_rwlock_destroy(&lock);
     (void)pthread_mutex_destroy(&mutex);
     (void)pthread_cond_destroy(&cond);
+    (void)pthread_mutex_destroy(&fetchLock);
+    (void)pthread_cond_destroy(&fetchCond);
+    for (unsigned j = 0; j < FASTBIT_FILE_SHARDS; ++ j)
+        (void)pthread_mutex_destroy(&(shards[j].lock));
     LOGGER(ibis::gVerbose > 1)
         << "fileManager decommissioned\n";
 } // ibis::fileManager::~fileManager
@@ -731,6 +808,7 @@ void ibis::fileManager::recordFile(ibis::fileManager::roFile *st) {
                     "new mapped)" IBIS_FILE_LINE;
             }
             mapped[st->filename()] = st;
+            linkFile(st);
         }
         else if (st != (*it).second) {
             LOGGER(ibis::gVerbose >= 0)
@@ -758,6 +836,7 @@ void ibis::fileManager::recordFile(ibis::fileManager::roFile *st) {
                     "new incore)" IBIS_FILE_LINE;
             }
             incore[st->filename()] = st;
+            linkFile(st);
         }
         else if (st != (*it).second) {
             LOGGER(ibis::gVerbose >= 0)
@@ -794,12 +873,88 @@ void ibis::fileManager::unrecordFile(ibis::fileManager::roFile *st) {
             << evt << " -- the given filename is not on the list incore";
     }
     else if (st != (*it).second) {
+        unlinkFile((*it).second);
         incore.erase(it);
         LOGGER(ibis::gVerbose > 12)
             << evt << " removed " << st->filename() << " from incore";
     }
 } // ibis::fileManager::unrecordFile
 
+/// Return the shard of the lookup table that may contain the named file.
+ibis::fileManager::shard& ibis::fileManager::shardOf(const char* name) {
+    return shards[ibis::util::checksum(name, std::strlen(name)) %
+                  FASTBIT_FILE_SHARDS];
+} // ibis::fileManager::shardOf
+
+/// Look for the named file in the lookup table.  Only the lock on the
+/// shard containing the name is acquired, therefore this function does
+/// not wait for other threads reading or unloading files.  If the file is
+/// found, its reference bit is set so that the next sweep of the CLOCK
+/// hand will skip it.  It returns a nil pointer if the named file is not
+/// in memory.
+ibis::fileManager::roFile* ibis::fileManager::findFile(const char* name) {
+    shard& sh = shardOf(name);
+    ibis::util::mutexLock lck(&(sh.lock), name);
+    fileList::const_iterator it = sh.files.find(name);
+    if (it == sh.files.end())
+        return 0;
+
+    (*it).second->referenced = true;
+    return (*it).second;
+} // ibis::fileManager::findFile
+
+/// Add a file to the lookup table and to the CLOCK ring.  A new file is
+/// placed right behind the CLOCK hand so that it is the last one to be
+/// examined by the next sweep.  The caller needs to hold the mutex lock on
+/// the file manager.
+void ibis::fileManager::linkFile(ibis::fileManager::roFile *st) {
+    {
+        shard& sh = shardOf(st->filename());
+        ibis::util::mutexLock lck(&(sh.lock), st->filename());
+        sh.files[st->filename()] = st;
+    }
+
+    st->referenced = false;
+    if (hand == 0) {
+        st->prevFile = st;
+        st->nextFile = st;
+        hand = st;
+    }
+    else {
+        st->nextFile = hand;
+        st->prevFile = hand->prevFile;
+        hand->prevFile->nextFile = st;
+        hand->prevFile = st;
+    }
+} // ibis::fileManager::linkFile
+
+/// Remove a file from the lookup table and from the CLOCK ring.  This
+/// needs to be done before the file object is deleted since the lookup
+/// table uses the file name in the object as the key.  The caller needs
+/// to hold the mutex lock on the file manager.
+void ibis::fileManager::unlinkFile(ibis::fileManager::roFile *st) {
+    if (st->filename() != 0) {
+        shard& sh = shardOf(st->filename());
+        ibis::util::mutexLock lck(&(sh.lock), st->filename());
+        fileList::iterator it = sh.files.find(st->filename());
+        if (it != sh.files.end() && (*it).second == st)
+            sh.files.erase(it);
+    }
+
+    if (st->nextFile == 0) return; // not on the ring
+    if (st->nextFile == st) {
+        hand = 0;
+    }
+    else {
+        if (hand == st)
+            hand = st->nextFile;
+        st->prevFile->nextFile = st->nextFile;
+        st->nextFile->prevFile = st->prevFile;
+    }
+    st->prevFile = 0;
+    st->nextFile = 0;
+} // ibis::fileManager::unlinkFile
+
 /// Retrieve the file content as a storage object.  The object *st returned
 /// from this function is owned by the fileManager.  The caller should NOT
 /// delete *st!  This function will wait for the fileManager to unload some
@@ -839,6 +994,14 @@ int ibis::fileManager::getFile(const char* name, storage **st,
         }
     }
 
+    // is the named file already in memory?  This check only needs the
+    // lock on one shard of the lookup table
+    roFile *rf = findFile(name);
+    if (rf != 0) {
+        *st = rf;
+        return ierr;
+    }
+
     //20100922readLock rock(evt.c_str());
     ibis::util::mutexLock lck(&mutex, evt.c_str()); // only one instance can run
     // is the named file among those mapped ?
@@ -1065,6 +1228,12 @@ int ibis::fileManager::tryGetFile(const char* name, storage **st,
         evt += name;
         evt += ')';
     }
+    roFile *rf = findFile(name);
+    if (rf != 0) { // found it in the lookup table
+        *st = rf;
+        return ierr;
+    }
+
     //20100922readLock rock("tryGetFile");
     ibis::util::mutexLock lck(&mutex, evt.c_str());
 
@@ -1398,121 +1567,31 @@ int ibis::fileManager::unload(size_t sz) {
                  << ", maxBytes=" << ibis::util::groupby1000(maxBytes) << ")";
     }
 
-    // collect the list of files that can be unloaded
-    std::vector<fileList::iterator> candidates;
-    fileList::iterator it;
     time_t startTime = time(0);
     time_t current = startTime;
 
     do { // will wait
-        {
-            size_t sum = 0; // the total bytes that can can be unloaded
-            for (it=mapped.begin(); it!=mapped.end(); ++it) {
-                if ((*it).second->inUse() == 0 &&
-                    (*it).second->pastUse() > 0) {
-                    sum += (*it).second->size();
-                }
-            }
-            for (it=incore.begin(); it!=incore.end(); ++it) {
-                if ((*it).second->inUse() == 0 &&
-                    (*it).second->pastUse() > 0) {
-                    sum += (*it).second->size();
-                }
-            }
-            const uint64_t tb = ibis::fileManager::totalBytes();
-            if (sz == 0 || maxBytes <= tb || maxBytes+sum < tb+sz)
-                // invoke the external cleaners
-                invokeCleaners();
-        }
-
-        // collects the candidates to be removed
-        for (it=mapped.begin(); it!=mapped.end(); ++it) {
-            if ((*it).second->inUse() == 0 &&
-                (*it).second->pastUse() > 0) {
-                candidates.push_back(it);
-            }
-        }
-        for (it=incore.begin(); it!=incore.end(); ++it) {
-            if ((*it).second->inUse() == 0 &&
-                (*it).second->pastUse() > 0) {
-                candidates.push_back(it);
-            }
-        }
-
-        if (candidates.size() > 1) {
-            // sort the candidates in descending order of scores
-            const size_t ncand = candidates.size();
-            std::vector<float> scores(candidates.size());
-            for (unsigned i = 0; i < ncand; ++ i) {
-                scores[i] = (*(candidates[i])).second->score();
-            }
-            for (unsigned stride = ncand/2; stride > 0; stride /= 2) {
-                for (unsigned i = 0; i < ncand - stride; ++ i) {
-                    if (scores[i] < scores[i+stride]) {
-                        float tmp = scores[i];
-                        scores[i] = scores[i+stride];
-                        scores[i+stride] = tmp;
-                        it = candidates[i];
-                        candidates[i] = candidates[i+stride];
-                        candidates[i+stride] = it;
-                    }
-                }
-            }
-        }
         if (sz == 0) {
-            LOGGER(ibis::gVerbose > 1 && candidates.size() > 0)
-                << "fileManager::unload -- to unload all ("
-                << candidates.size() << ") inactive files";
-            for (size_t i = 0; i < candidates.size(); ++ i) {
-                it = candidates[i];
-                roFile *tmp = (*it).second; // fileManager::roFile to delete
-                if (ibis::gVerbose > 3) {
-                    ibis::util::logger lg;
-                    lg() << "fileManager::unload " << (*it).first;
-                    if (ibis::gVerbose > 7) {
-                        lg() << "\n";
-                        (*it).second->printStatus(lg());
-                    }
-                }
-                if (tmp->mapped) {
-                    mapped.erase(it);
-                }
-                else {
-                    incore.erase(it);
-                }
-                delete tmp;
-            }
+            // give the external cleaners a chance to release the files
+            // they hold before unloading all inactive files
+            invokeCleaners();
+            const uint32_t cnt = sweep(0);
+            LOGGER(ibis::gVerbose > 1 && cnt > 0)
+                << "fileManager::unload -- unloaded all (" << cnt
+                << ") inactive files";
             return 0;
         }
-        else if (candidates.size() > 0) {
-            // note: totalBytes is updated when an object is deleted
-            while (candidates.size() > 0 &&
-                   maxBytes-sz < ibis::fileManager::totalBytes())  {
-                it = candidates.back();
-                roFile *tmp = (*it).second;
-                if (ibis::gVerbose > 3) {
-                    ibis::util::logger lg;
-                    lg() << "fileManager::unload " << (*it).first;
-                    if (ibis::gVerbose > 7) {
-                        lg() << "\n";
-                        (*it).second->printStatus(lg());
-                    }
-                }
 
-                if (tmp->mapped) {
-                    mapped.erase(it);
-                }
-                else {
-                    incore.erase(it);
-                }
-                delete tmp; // remove the target selected
-                candidates.resize(candidates.size()-1);
-            }
-            if (maxBytes >= sz+ibis::fileManager::totalBytes())
-                return 0;
-        }
+        (void) sweep(sz);
+        if (maxBytes >= sz+ibis::fileManager::totalBytes())
+            return 0;
 
-        candidates.clear(); // remove space taken up by candiates
+        // the inactive files do not free up enough space, invoke the
+        // external cleaners and try again
+        invokeCleaners();
+        (void) sweep(sz);
+        if (maxBytes >= sz+ibis::fileManager::totalBytes())
+            return 0;
 
         if (nwaiting > 0) {
             // a primitive strategy: only one thread can wait for any
@@ -1596,6 +1675,49 @@ int ibis::fileManager::unload(size_t sz) {
     }
 } // ibis::fileManager::unload
 
+/// Sweep the CLOCK hand around the ring of files in memory and unload
+/// inactive files until there is room for @c sz more bytes.  A file whose
+/// reference bit is set gets a second chance: the bit is cleared and the
+/// file is skipped.  If @c sz is 0, all inactive files are unloaded
+/// regardless of their reference bits.  Each file is visited at most twice
+/// in one call.  Returns the number of files unloaded.
+///
+/// @note The caller needs to hold the mutex lock on the file manager.
+uint32_t ibis::fileManager::sweep(size_t sz) {
+    uint32_t cnt = 0;
+    size_t nsteps = 2 * (mapped.size() + incore.size());
+    while (hand != 0 && nsteps > 0 &&
+           (sz == 0 || maxBytes < sz+ibis::fileManager::totalBytes())) {
+        -- nsteps;
+        roFile *tmp = hand;
+        hand = tmp->nextFile;
+        if (tmp->inUse() > 0 || tmp->pastUse() == 0)
+            continue;
+        if (sz > 0 && tmp->referenced) {
+            tmp->referenced = false;
+            continue;
+        }
+
+        if (ibis::gVerbose > 3) {
+            ibis::util::logger lg;
+            lg() << "fileManager::unload " << tmp->filename();
+            if (ibis::gVerbose > 7) {
+                lg() << "\n";
+                tmp->printStatus(lg());
+            }
+        }
+        rememberFile(tmp);
+        unlinkFile(tmp);
+        if (tmp->mapped)
+            mapped.erase(tmp->filename());
+        else
+            incore.erase(tmp->filename());
+        delete tmp; // note: totalBytes is updated here
+        ++ cnt;
+    }
+    return cnt;
+} // ibis::fileManager::sweep
+
 /// Invoke the external cleanup function registered with the file manager.
 void ibis::fileManager::invokeCleaners() const {
     const uint64_t before = ibis::fileManager::totalBytes();
@@ -1639,6 +1761,620 @@ void ibis::fileManager::signalMemoryAvailable() const {
     }
 } // ibis::fileManager::signalMemoryAvailable
 
+/// Ask the prefetch threads to start reading the named file.  The call
+/// returns immediately.  The file is read into the page cache of the
+/// operating system, so that a later call to getFile or getFileSegment
+/// on the same file does not have to wait for the storage device.  Since
+/// the file is not recorded by the file manager, a prefetch never leaves
+/// behind a stale copy of a file that is modified later.  Requests for
+/// files already in memory, files already waiting to be prefetched, and
+/// requests beyond the length of the waiting list are ignored.
+///
+/// The number of prefetch threads is controlled by the parameter
+/// fileManager.prefetchThreads, the default is 4.  The threads are
+/// started on the first call to this function.  A value of 0 turns off
+/// prefetching.  Having several threads allows several files to be read
+/// at the same time, which is necessary to keep a solid state device
+/// busy.
+void ibis::fileManager::prefetch(const char* name) {
+    if (name == 0 || *name == 0) return;
+    if (findFile(name) != 0) return; // already in memory
+
+    ibis::util::mutexLock lck(&fetchLock, "fileManager::prefetch");
+    if (stopFetching) return;
+    if (fetchers.empty()) {
+        unsigned nt = 4;
+        if (ibis::gParameters()["fileManager.prefetchThreads"] != 0)
+            nt = static_cast<unsigned>
+                (ibis::gParameters().getNumber("fileManager.prefetchThreads"));
+        if (nt > 64)
+            nt = 64;
+        for (unsigned j = 0; j < nt; ++ j) {
+            pthread_t tid;
+            int ierr = pthread_create(&tid, 0, fetchThread, this);
+            if (ierr != 0) {
+                LOGGER(ibis::gVerbose > 1)
+                    << "Warning -- fileManager::prefetch failed to start "
+                    "prefetch thread " << j << ", pthread_create returned "
+                    << ierr;
+                break;
+            }
+            fetchers.push_back(tid);
+        }
+        if (fetchers.empty()) { // do not try again
+            stopFetching = true;
+            return;
+        }
+        LOGGER(ibis::gVerbose > 3)
+            << "fileManager::prefetch started " << fetchers.size()
+            << " prefetch thread" << (fetchers.size() > 1 ? "s" : "");
+    }
+
+    if (pending.size() >= 64 * fetchers.size())
+        return; // too many outstanding requests
+    for (std::deque<std::string>::const_iterator it = pending.begin();
+         it != pending.end(); ++ it) {
+        if (it->compare(name) == 0)
+            return;
+    }
+    pending.push_back(name);
+    (void) pthread_cond_signal(&fetchCond);
+    LOGGER(ibis::gVerbose > 7)
+        << "fileManager::prefetch queued \"" << name << "\"";
+} // ibis::fileManager::prefetch
+
+/// The main loop of a prefetch thread.  It returns when the file manager
+/// is being destroyed.
+void ibis::fileManager::fetchFiles() {
+    std::string name;
+    while (true) {
+        {
+            ibis::util::mutexLock lck(&fetchLock, "fileManager::fetchFiles");
+            while (! stopFetching && pending.empty())
+                (void) pthread_cond_wait(&fetchCond, &fetchLock);
+            if (stopFetching)
+                return;
+            name.swap(pending.front());
+            pending.pop_front();
+        }
+        if (findFile(name.c_str()) != 0) continue;
+
+        int fdes = UnixOpen(name.c_str(), OPEN_READONLY);
+        if (fdes < 0) continue;
+        IBIS_BLOCK_GUARD(UnixClose, fdes);
+#if defined(_WIN32) && defined(_MSC_VER)
+        (void)_setmode(fdes, _O_BINARY);
+#endif
+#if defined(POSIX_FADV_WILLNEED)
+        int ierr = posix_fadvise(fdes, 0, 0, POSIX_FADV_WILLNEED);
+#else
+        // read through the file to bring it into the cache of the OS
+        int ierr = 0;
+        char buf[65536];
+        while (! stopFetching && UnixRead(fdes, buf, sizeof(buf)) > 0);
+#endif
+        LOGGER(ibis::gVerbose > 6)
+            << "fileManager::fetchFiles -- prefetched \"" << name
+            << "\", ierr = " << ierr;
+    }
+} // ibis::fileManager::fetchFiles
+
+/// The function passed to pthread_create to start a prefetch thread.
+void* ibis::fileManager::fetchThread(void* arg) {
+    try {
+        reinterpret_cast<ibis::fileManager*>(arg)->fetchFiles();
+    }
+    catch (...) {
+        LOGGER(ibis::gVerbose > 0)
+            << "Warning -- fileManager::fetchThread received an exception";
+    }
+    return 0;
+} // ibis::fileManager::fetchThread
+
+/// Remember the access statistics of a file about to be unloaded, so
+/// that saveManifest can still list it.  At most FASTBIT_MANIFEST_SIZE
+/// files are remembered, the one with the lowest score is forgotten
+/// first.  The caller needs to hold the mutex lock on the file manager.
+void ibis::fileManager::rememberFile(const ibis::fileManager::roFile *rf) {
+    if (rf == 0 || rf->filename() == 0 || rf->pastUse() == 0) return;
+
+    fileStat &fs = unloaded[rf->filename()];
+    fs.bytes = rf->size();
+    fs.nacc += rf->pastUse();
+    fs.score = rf->score();
+    if (unloaded.size() > FASTBIT_MANIFEST_SIZE) {
+        statList::iterator low = unloaded.begin();
+        for (statList::iterator it = unloaded.begin();
+             it != unloaded.end(); ++ it) {
+            if (it->second.score < low->second.score)
+                low = it;
+        }
+        unloaded.erase(low);
+    }
+} // ibis::fileManager::rememberFile
+
+/// An entry of the warm-up manifest.
+struct _ibis_warmUp_entry {
+    std::string name;
+    uint64_t bytes;
+    unsigned nacc;
+    double score;
+};
+/// Sort the entries of the manifest in descending order of scores.
+struct _ibis_warmUp_higher {
+    bool operator()(const _ibis_warmUp_entry &a,
+                    const _ibis_warmUp_entry &b) const {
+        return (a.score > b.score ||
+                (a.score == b.score && a.bytes < b.bytes));
+    }
+};
+/// The files to be read by the warm-up threads.
+struct _ibis_warmUp_list {
+    std::vector<_ibis_warmUp_entry> files;
+    size_t next;
+    uint64_t bytes;
+    pthread_mutex_t lock;
+};
+
+/// Write the names of the files used recently to the named manifest file.
+/// Each line of the manifest contains the score, the number of past
+/// accesses, the size in bytes and the name of a file, in descending
+/// order of scores.  The files currently in memory and the ones unloaded
+/// to make room for others are both listed.  The manifest is written to
+/// a temporary file first and then renamed, so that a concurrent warmUp
+/// never reads a partial manifest.
+///
+/// Returns the number of files listed upon successful completion,
+/// otherwise a negative number.
+///
+/// @note If the parameter fileManager.manifest is set, the destructor of
+/// the file manager writes the manifest to the named file and ibis::init
+/// calls warmUp with the same file.
+int ibis::fileManager::saveManifest(const char *manifest) const {
+    if (manifest == 0 || *manifest == 0) return -1;
+
+    std::vector<_ibis_warmUp_entry> list;
+    {
+        ibis::util::mutexLock lck(&mutex, "fileManager::saveManifest");
+        list.reserve(mapped.size() + incore.size() + unloaded.size());
+        _ibis_warmUp_entry ent;
+        for (int j = 0; j < 2; ++ j) {
+            const fileList &fl = (j == 0 ? mapped : incore);
+            for (fileList::const_iterator it = fl.begin();
+                 it != fl.end(); ++ it) {
+                const roFile &rf = *(it->second);
+                ent.name = rf.filename();
+                ent.bytes = rf.size();
+                ent.nacc = rf.pastUse();
+                ent.score = rf.score();
+                statList::const_iterator us = unloaded.find(ent.name);
+                if (us != unloaded.end())
+                    ent.nacc += us->second.nacc;
+                list.push_back(ent);
+            }
+        }
+        for (statList::const_iterator it = unloaded.begin();
+             it != unloaded.end(); ++ it) {
+            if (mapped.find(it->first.c_str()) != mapped.end() ||
+                incore.find(it->first.c_str()) != incore.end())
+                continue;
+            ent.name = it->first;
+            ent.bytes = it->second.bytes;
+            ent.nacc = it->second.nacc;
+            ent.score = it->second.score;
+            list.push_back(ent);
+        }
+    }
+    std::sort(list.begin(), list.end(), _ibis_warmUp_higher());
+
+    std::string tmp = manifest;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp.c_str());
+        if (! out) {
+            LOGGER(ibis::gVerbose > 0)
+                << "Warning -- fileManager::saveManifest failed to open \""
+                << tmp << "\" for writing";
+            return -2;
+        }
+        out << "# FastBit file manager manifest: score, accesses, bytes, "
+            "file name\n";
+        for (size_t j = 0; j < list.size(); ++ j)
+            out << list[j].score << ' ' << list[j].nacc << ' '
+                << list[j].bytes << ' ' << list[j].name << '\n';
+        if (! out) {
+            LOGGER(ibis::gVerbose > 0)
+                << "Warning -- fileManager::saveManifest failed to write "
+                "to \"" << tmp << '"';
+            (void) remove(tmp.c_str());
+            return -3;
+        }
+    }
+#if defined(_WIN32)
+    (void) remove(manifest); // rename on windows does not overwrite
+#endif
+    if (rename(tmp.c_str(), manifest) != 0) {
+        LOGGER(ibis::gVerbose > 0)
+            << "Warning -- fileManager::saveManifest failed to rename \""
+            << tmp << "\" to \"" << manifest << "\" -- " << strerror(errno);
+        (void) remove(tmp.c_str());
+        return -4;
+    }
+    LOGGER(ibis::gVerbose > 2)
+        << "fileManager::saveManifest wrote " << list.size() << " file name"
+        << (list.size() > 1 ? "s" : "") << " to " << manifest;
+    return list.size();
+} // ibis::fileManager::saveManifest
+
+/// Read the files listed in a manifest written by saveManifest.  The
+/// files are read in descending order of their scores until the total
+/// size reaches @c limit bytes.  Files that no longer exist or would
+/// exceed the limit are skipped.  If @c limit is 0, half of the memory
+/// cache is used, and the limit is never more than the size of the cache.
+///
+/// The files are read by several threads, the number of which is given by
+/// the parameter fileManager.warmUpThreads, with a default of 4.  The
+/// files are retrieved through getFile, so they are memory mapped or read
+/// into memory the same way as they would be for a query.  The pages of
+/// the memory mapped files are touched so that the first query does not
+/// wait for them.  The access counts recorded in the manifest are carried
+/// over, so a file that was used a lot before a restart is less likely to
+/// be unloaded soon after.
+///
+/// Returns the number of bytes read into memory, or a negative number if
+/// the manifest can not be read.
+int64_t ibis::fileManager::warmUp(const char *manifest, uint64_t limit) {
+    if (manifest == 0 || *manifest == 0) return -1;
+    std::ifstream in(manifest);
+    if (! in) {
+        LOGGER(ibis::gVerbose > 2)
+            << "Warning -- fileManager::warmUp failed to open \"" << manifest
+            << '"';
+        return -2;
+    }
+    if (limit == 0 || limit > maxBytes) {
+        limit = (limit == 0 ? (maxBytes >> 1) : maxBytes);
+    }
+
+    _ibis_warmUp_list todo;
+    todo.next = 0;
+    todo.bytes = 0;
+    std::string line;
+    _ibis_warmUp_entry ent;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream iss(line);
+        if (iss >> ent.score >> ent.nacc >> ent.bytes) {
+            std::getline(iss >> std::ws, ent.name);
+            if (! ent.name.empty())
+                todo.files.push_back(ent);
+        }
+    }
+    std::sort(todo.files.begin(), todo.files.end(),
+              _ibis_warmUp_higher());
+
+    // keep the files that fit within the limit, with their current sizes
+    uint64_t total = 0;
+    size_t nf = 0;
+    for (size_t j = 0; j < todo.files.size(); ++ j) {
+        Stat_T st;
+        if (UnixStat(todo.files[j].name.c_str(), &st) != 0 || st.st_size <= 0)
+            continue;
+        if (total + st.st_size > limit)
+            continue;
+        total += st.st_size;
+        if (nf < j)
+            todo.files[nf] = todo.files[j];
+        todo.files[nf].bytes = st.st_size;
+        ++ nf;
+    }
+    todo.files.resize(nf);
+    if (nf == 0) return 0;
+
+    ibis::horometer timer;
+    timer.start();
+    unsigned nt = 4;
+    if (ibis::gParameters()["fileManager.warmUpThreads"] != 0)
+        nt = static_cast<unsigned>
+            (ibis::gParameters().getNumber("fileManager.warmUpThreads"));
+    if (nt > nf)
+        nt = nf;
+    if (nt > 64)
+        nt = 64;
+    if (pthread_mutex_init(&todo.lock, 0) != 0)
+        return -3;
+    std::vector<pthread_t> tids;
+    for (unsigned j = 1; j < nt; ++ j) {
+        pthread_t tid;
+        if (pthread_create(&tid, 0, warmUpThread, &todo) != 0)
+            break;
+        tids.push_back(tid);
+    }
+    (void) warmUpThread(&todo); // the calling thread also reads files
+    for (size_t j = 0; j < tids.size(); ++ j)
+        (void) pthread_join(tids[j], 0);
+    (void) pthread_mutex_destroy(&todo.lock);
+
+    timer.stop();
+    LOGGER(ibis::gVerbose > 1)
+        << "fileManager::warmUp read " << ibis::util::groupby1000(todo.bytes)
+        << " bytes from " << nf << " file" << (nf > 1 ? "s" : "")
+        << " listed in " << manifest << " using " << tids.size()+1
+        << " thread" << (tids.empty() ? "" : "s") << " in "
+        << timer.realTime() << " sec(elapsed)";
+    return todo.bytes;
+} // ibis::fileManager::warmUp
+
+/// The function executed by the warm-up threads.  Each thread takes the
+/// next file from the list until all files are read.
+void* ibis::fileManager::warmUpThread(void *arg) {
+    _ibis_warmUp_list &todo =
+        *static_cast<_ibis_warmUp_list*>(arg);
+    ibis::fileManager &fm = ibis::fileManager::instance();
+    while (true) {
+        size_t j;
+        {
+            ibis::util::mutexLock lck(&todo.lock, "fileManager::warmUp");
+            if (todo.next >= todo.files.size())
+                break;
+            j = todo.next;
+            ++ todo.next;
+        }
+        const _ibis_warmUp_entry &ent = todo.files[j];
+        try {
+            array_t<char> arr;
+            if (fm.getFile(ent.name.c_str(), arr) != 0 || arr.empty())
+                continue;
+
+            roFile *rf = dynamic_cast<roFile*>(arr.getStorage());
+            if (rf != 0) {
+                if (rf->nacc < ent.nacc)
+                    rf->nacc = ent.nacc;
+                if (rf->isFileMap()) {
+                    // bring the pages into memory now
+                    rf->advise(ACCESS_WILLNEED, 0, rf->size());
+                    volatile char sum = 0;
+                    for (size_t i = 0; i < arr.size(); i += pagesize)
+                        sum += arr[i];
+                }
+            }
+            ibis::util::mutexLock lck(&todo.lock, "fileManager::warmUp");
+            todo.bytes += arr.size();
+        }
+        catch (...) {
+            LOGGER(ibis::gVerbose > 1)
+                << "Warning -- fileManager::warmUp failed to read \""
+                << ent.name << '"';
+        }
+    }
+    return 0;
+} // ibis::fileManager::warmUpThread
+
+// The states shared by all ibis::fileManager::budget objects.
+static pthread_mutex_t _ibis_budget_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _ibis_budget_cond = PTHREAD_COND_INITIALIZER;
+/// The number of bytes reserved by the budgets in effect.
+static uint64_t _ibis_budget_reserved = 0;
+/// The next ticket to be handed out to a budget waiting for admission.
+static uint64_t _ibis_budget_ticket = 0;
+/// The ticket of the budget to be admitted next.
+static uint64_t _ibis_budget_serving = 0;
+/// The key to the budget in effect in each thread.
+static pthread_key_t _ibis_budget_key;
+static pthread_once_t _ibis_budget_once = PTHREAD_ONCE_INIT;
+static void _ibis_budget_makeKey() {
+    (void) pthread_key_create(&_ibis_budget_key, 0);
+}
+
+/// Constructor.  A limit of 0 means the budget only counts the bytes
+/// charged without limiting them.  The owner is expected to be a static
+/// string, it is only used in log messages.
+ibis::fileManager::budget::budget(uint64_t lim, const char *owner)
+    : m_owner(owner != 0 && *owner != 0 ? owner : "query"), m_limit(lim),
+      m_reserved(0), m_used(0), m_peak(0), m_active(false),
+      m_exceeded(false) {
+    if (current() != 0) return; // nested budget
+
+    const uint64_t pool = static_cast<uint64_t>
+        (ibis::gParameters().getNumber("fileManager.queryMemory"));
+    if (m_limit > 0 && pool > 0) {
+        m_reserved = (m_limit < pool ? m_limit : pool);
+        ibis::horometer timer;
+        timer.start();
+        ibis::util::mutexLock lck(&_ibis_budget_lock, "fileManager::budget");
+        const uint64_t mine = _ibis_budget_ticket;
+        ++ _ibis_budget_ticket;
+        LOGGER(ibis::gVerbose > 3 && (mine != _ibis_budget_serving ||
+                                      _ibis_budget_reserved + m_reserved >
+                                      pool))
+            << "fileManager::budget -- " << m_owner << " waiting for "
+            << ibis::util::groupby1000(m_reserved) << " bytes, "
+            << ibis::util::groupby1000(_ibis_budget_reserved)
+            << " bytes of fileManager.queryMemory ("
+            << ibis::util::groupby1000(pool) << ") are in use";
+        while (mine != _ibis_budget_serving ||
+               _ibis_budget_reserved + m_reserved > pool) {
+            int ierr = pthread_cond_wait(&_ibis_budget_cond,
+                                         &_ibis_budget_lock);
+            if (ierr != 0) {
+                LOGGER(ibis::gVerbose >= 0)
+                    << "Warning -- fileManager::budget -- pthread_cond_wait "
+                    "returned " << ierr << ", " << m_owner
+                    << " proceeds without waiting for its turn";
+                break;
+            }
+        }
+        _ibis_budget_reserved += m_reserved;
+        ++ _ibis_budget_serving;
+        (void) pthread_cond_broadcast(&_ibis_budget_cond);
+        timer.stop();
+        LOGGER(ibis::gVerbose > 3 && timer.realTime() > 0.01)
+            << "fileManager::budget -- " << m_owner << " was admitted after "
+            << timer.realTime() << " sec";
+    }
+
+    (void) pthread_setspecific(_ibis_budget_key, this);
+    m_active = true;
+} // ibis::fileManager::budget::budget
+
+/// Destructor.  Return the reservation and wake up the budgets waiting.
+ibis::fileManager::budget::~budget() {
+    if (! m_active) return;
+    (void) pthread_setspecific(_ibis_budget_key, 0);
+    if (m_reserved > 0) {
+        ibis::util::mutexLock lck(&_ibis_budget_lock, "fileManager::~budget");
+        _ibis_budget_reserved -= m_reserved;
+        (void) pthread_cond_broadcast(&_ibis_budget_cond);
+    }
+    LOGGER(ibis::gVerbose > 4)
+        << "fileManager::budget -- " << m_owner << " used at most "
+        << ibis::util::groupby1000(m_peak) << " bytes"
+        << (m_limit > 0 ? " out of " : "")
+        << (m_limit > 0 ? ibis::util::groupby1000(m_limit) : std::string());
+} // ibis::fileManager::budget::~budget
+
+/// Return the budget in effect in the calling thread.  It returns a nil
+/// pointer if there is none.
+ibis::fileManager::budget* ibis::fileManager::budget::current() {
+    (void) pthread_once(&_ibis_budget_once, _ibis_budget_makeKey);
+    return static_cast<ibis::fileManager::budget*>
+        (pthread_getspecific(_ibis_budget_key));
+} // ibis::fileManager::budget::current
+
+/// Charge @c n bytes to the budget in effect in the calling thread.  It
+/// throws an ibis::bad_alloc exception if the charge would exceed the
+/// limit of the budget.
+void ibis::fileManager::budget::charge(size_t n) {
+    budget *bdg = current();
+    if (bdg == 0) return;
+    if (bdg->m_limit > 0 && bdg->m_used + n > bdg->m_limit) {
+        bdg->m_exceeded = true;
+        LOGGER(ibis::gVerbose > 1)
+            << "Warning -- fileManager::budget -- " << bdg->m_owner
+            << " can not allocate " << ibis::util::groupby1000(n)
+            << " more bytes, it is using "
+            << ibis::util::groupby1000(bdg->m_used) << " out of "
+            << ibis::util::groupby1000(bdg->m_limit) << " bytes";
+        throw ibis::bad_alloc("fileManager::budget exceeded" IBIS_FILE_LINE);
+    }
+    bdg->m_used += n;
+    if (bdg->m_peak < bdg->m_used)
+        bdg->m_peak = bdg->m_used;
+} // ibis::fileManager::budget::charge
+
+/// Return @c n bytes to the budget in effect in the calling thread.
+void ibis::fileManager::budget::credit(size_t n) {
+    budget *bdg = current();
+    if (bdg == 0) return;
+    bdg->m_used = (bdg->m_used > n ? bdg->m_used - n : 0);
+} // ibis::fileManager::budget::credit
+
+/// The key to the arena in effect in each thread.
+static pthread_key_t _ibis_arena_key;
+static pthread_once_t _ibis_arena_once = PTHREAD_ONCE_INIT;
+static void _ibis_arena_makeKey() {
+    (void) pthread_key_create(&_ibis_arena_key, 0);
+}
+
+/// Find the size class of a request for @c n bytes, where 64 <= n <= 1
+/// MB.  The size of the memory actually allocated is returned in @c cap.
+/// The sizes of the classes are 4, 5, 6 or 7 times a power of two, so
+/// that no more than a quarter of the memory allocated is wasted.
+static inline unsigned _ibis_arena_class(size_t n, size_t &cap) {
+    const size_t m = n - 1;
+    unsigned e = 3; // m >= 63
+    while ((m >> e) > 7)
+        ++ e;
+    cap = ((m >> e) + 1) << e;
+    return 4 * e + static_cast<unsigned>(m >> e) - 19;
+} // _ibis_arena_class
+
+/// Constructor.  The owner is expected to be a static string, it is only
+/// used in log messages.
+ibis::fileManager::arena::arena(const char *owner)
+    : m_owner(owner != 0 && *owner != 0 ? owner : "query"), m_limit(8388608),
+      m_pooled(0), m_requests(0), m_reused(0), m_active(false) {
+    if (current() != 0) return; // nested arena
+    if (ibis::gParameters()["fileManager.arenaBytes"] != 0)
+        m_limit = static_cast<uint64_t>
+            (ibis::gParameters().getNumber("fileManager.arenaBytes"));
+    if (m_limit == 0) return;
+
+    for (unsigned j = 0; j < FASTBIT_ARENA_CLASSES; ++ j)
+        m_free[j] = 0;
+    (void) pthread_setspecific(_ibis_arena_key, this);
+    m_active = true;
+} // ibis::fileManager::arena::arena
+
+/// Destructor.  Return all memory in the pool to the system.
+ibis::fileManager::arena::~arena() {
+    if (! m_active) return;
+    (void) pthread_setspecific(_ibis_arena_key, 0);
+    for (unsigned j = 0; j < FASTBIT_ARENA_CLASSES; ++ j) {
+        while (m_free[j] != 0) {
+            char *next = *reinterpret_cast<char**>(m_free[j]);
+            free(m_free[j]);
+            m_free[j] = next;
+        }
+    }
+    LOGGER(ibis::gVerbose > 4 && m_requests > 0)
+        << "fileManager::arena -- " << m_owner << " served " << m_reused
+        << " out of " << m_requests << " request"
+        << (m_requests > 1 ? "s" : "") << " for memory from its pool";
+} // ibis::fileManager::arena::~arena
+
+/// Return the arena in effect in the calling thread.  It returns a nil
+/// pointer if there is none.
+ibis::fileManager::arena* ibis::fileManager::arena::current() {
+    (void) pthread_once(&_ibis_arena_once, _ibis_arena_makeKey);
+    return static_cast<ibis::fileManager::arena*>
+        (pthread_getspecific(_ibis_arena_key));
+} // ibis::fileManager::arena::current
+
+/// Allocate @c n bytes for a storage object.  The memory is taken from
+/// the pool of the arena in effect in the calling thread if possible,
+/// otherwise it is allocated with malloc in the size of its class.  It
+/// returns a nil pointer if there is no arena in effect, if @c n is
+/// outside of the sizes pooled, or if malloc fails.  The memory returned
+/// may be freed with free or given back through deallocate.
+char* ibis::fileManager::arena::allocate(size_t n) {
+    if (n < 64 || n > 1048576) return 0;
+    arena *are = current();
+    if (are == 0) return 0;
+
+    size_t cap;
+    const unsigned c = _ibis_arena_class(n, cap);
+    ++ are->m_requests;
+    char *ret = are->m_free[c];
+    if (ret != 0) {
+        are->m_free[c] = *reinterpret_cast<char**>(ret);
+        are->m_pooled -= cap;
+        ++ are->m_reused;
+    }
+    else {
+        ret = static_cast<char*>(malloc(cap));
+    }
+    return ret;
+} // ibis::fileManager::arena::allocate
+
+/// Give the memory of a storage object of @c n bytes back to the arena in
+/// effect in the calling thread.  The memory must have been obtained from
+/// allocate with at least @c n bytes.  It returns false if the memory is
+/// not kept, in which case the caller is to free it.
+bool ibis::fileManager::arena::deallocate(char *addr, size_t n) {
+    if (addr == 0 || n < 64 || n > 1048576) return false;
+    arena *are = current();
+    if (are == 0) return false;
+
+    size_t cap;
+    const unsigned c = _ibis_arena_class(n, cap);
+    if (are->m_pooled + cap > are->m_limit) return false;
+    *reinterpret_cast<char**>(addr) = are->m_free[c];
+    are->m_free[c] = addr;
+    are->m_pooled += cap;
+    return true;
+} // ibis::fileManager::arena::deallocate
+
 // /// Constructor.  It attempts to acquire the lock and records whether a
 // /// write lock was acquired as a boolean variable.  The function isLocked
 // /// returns whether the lock has been acquired.
@@ -1842,7 +2578,8 @@ template class ibis::fileManager::buffer<uint64_t>;
 //
 /// Constructor.  Allocate no real storage.
 ibis::fileManager::storage::storage()
-    : name(), m_begin(0), m_end(0), nacc(0), nref() {
+    : name(), m_begin(0), m_end(0), nacc(0), nref(),
+      pooled(false) {
     LOGGER(ibis::gVerbose > 8)
         << "fileManager::storage(" << static_cast<void*>(this) << ", "
         << static_cast<void*>(m_begin) << ") initialization completed";
@@ -1853,7 +2590,8 @@ ibis::fileManager::storage::storage()
 /// object is in use.
 ibis::fileManager::storage::storage(char* addr, size_t num)
     : name(addr!=0 ? new char[1] : 0), m_begin(addr),
-      m_end(addr!=0 ? addr+num : 0), nacc(0), nref() {
+      m_end(addr!=0 ? addr+num : 0), nacc(0), nref(),
+      pooled(false) {
     if (name != 0)
         *name = 0;
     LOGGER(ibis::gVerbose > 8)
@@ -1866,10 +2604,12 @@ ibis::fileManager::storage::storage(char* addr, size_t num)
 /// Constructor.  Allocate storage for an array of the specified size (in
 /// bytes).
 ibis::fileManager::storage::storage(size_t n)
-    : name(0), m_begin(0), m_end(0), nacc(0), nref() {
+    : name(0), m_begin(0), m_end(0), nacc(0), nref(),
+      pooled(false) {
     LOGGER(ibis::gVerbose > 15)
         << "fileManager::storage::storage(" << n << ") ...";
     if (n == 0) n = 8; // give 8 bytes if asks for 0
+    ibis::fileManager::budget::charge(n);
     if (n+ibis::fileManager::totalBytes() > ibis::fileManager::maxBytes) {
 #ifdef FASTBIT_RECURSIVE_UNLOAD
         ibis::util::mutexLock lck(&ibis::fileManager::instance().mutex,
@@ -1896,7 +2636,10 @@ ibis::fileManager::storage::storage(size_t n)
                               IBIS_FILE_LINE);
 #endif
     }
-    m_begin = static_cast<char*>(malloc(n));
+    m_begin = ibis::fileManager::arena::allocate(n);
+    pooled = (m_begin != 0);
+    if (m_begin == 0)
+        m_begin = static_cast<char*>(malloc(n));
     if (m_begin == 0) { // failed to allocate memory
 #ifdef FASTBIT_RECURSIVE_UNLOAD
         LOGGER(ibis::gVerbose > 2)
@@ -1961,7 +2704,8 @@ ibis::fileManager::storage::storage(size_t n)
 ibis::fileManager::storage::storage(const char* fname,
                                     const off_t begin,
                                     const off_t end)
-    : name(0), m_begin(0), m_end(0), nacc(0), nref() {
+    : name(0), m_begin(0), m_end(0), nacc(0), nref(),
+      pooled(false) {
     if (fname == 0 || *fname == 0 || end <= begin) return;
 
     long nbytes = end - begin;
@@ -1987,7 +2731,8 @@ ibis::fileManager::storage::storage(const char* fname,
 ibis::fileManager::storage::storage(const int fdes,
                                     const off_t begin,
                                     const off_t end)
-    : name(0), m_begin(0), m_end(0), nacc(0), nref() {
+    : name(0), m_begin(0), m_end(0), nacc(0), nref(),
+      pooled(false) {
     if (fdes < 0 || end <= begin) return;
 
     off_t nbytes = end - begin;
@@ -2011,12 +2756,14 @@ ibis::fileManager::storage::storage(const int fdes,
 
 /// Copy constructor.  Copy the values between begin and end [begin, end).
 ibis::fileManager::storage::storage(const char* begin, const char* end)
-    : name(0), m_begin(0), m_end(0), nacc(0), nref() {
+    : name(0), m_begin(0), m_end(0), nacc(0), nref(),
+      pooled(false) {
     if (end <= begin) return;
     LOGGER(ibis::gVerbose > 15)
         << "fileManager::storage::storage(" << static_cast<const void*>(begin)
         << ", " << static_cast<const void*>(end) << ") ...";
     int64_t nbytes = end - begin;
+    ibis::fileManager::budget::charge(nbytes);
     if (nbytes+ibis::fileManager::totalBytes() > ibis::fileManager::maxBytes) {
 #ifdef FASTBIT_RECURSIVE_UNLOAD
         ibis::util::mutexLock lck(&ibis::fileManager::instance().mutex,
@@ -2041,7 +2788,10 @@ ibis::fileManager::storage::storage(const char* begin, const char* end)
                               IBIS_FILE_LINE);
 #endif
     }
-    m_begin = static_cast<char*>(malloc(nbytes));
+    m_begin = ibis::fileManager::arena::allocate(nbytes);
+    pooled = (m_begin != 0);
+    if (m_begin == 0)
+        m_begin = static_cast<char*>(malloc(nbytes));
     if (m_begin == 0) { // memory allocation failed
 #ifdef FASTBIT_RECURSIVE_UNLOAD
         LOGGER(ibis::gVerbose > 2)
@@ -2101,12 +2851,14 @@ ibis::fileManager::storage::storage(const char* begin, const char* end)
 
 /// Copy constructor.  Make an in-memory copy.
 ibis::fileManager::storage::storage(const ibis::fileManager::storage& rhs)
-    : name(0), m_begin(0), m_end(0), nacc(0), nref() {
+    : name(0), m_begin(0), m_end(0), nacc(0), nref(),
+      pooled(false) {
     LOGGER(ibis::gVerbose > 15)
         << "fileManager::storage::storage(" << static_cast<const void*>(&rhs)
         << ") ... start copying";
     uint64_t nbytes = rhs.size();
     if (nbytes == 0) return;
+    ibis::fileManager::budget::charge(nbytes);
 
     if (nbytes+ibis::fileManager::totalBytes() > ibis::fileManager::maxBytes) {
 #ifdef FASTBIT_RECURSIVE_UNLOAD
@@ -2128,7 +2880,10 @@ ibis::fileManager::storage::storage(const ibis::fileManager::storage& rhs)
         throw ibis::bad_alloc("storage::ctor(copy) failed" IBIS_FILE_LINE);
 #endif
     }
-    m_begin = static_cast<char*>(malloc(nbytes));
+    m_begin = ibis::fileManager::arena::allocate(nbytes);
+    pooled = (m_begin != 0);
+    if (m_begin == 0)
+        m_begin = static_cast<char*>(malloc(nbytes));
     if (m_begin == 0) { // failed to allocate memory
 #ifdef FASTBIT_RECURSIVE_UNLOAD
         LOGGER(ibis::gVerbose > 2)
@@ -2243,11 +2998,15 @@ void ibis::fileManager::storage::clear() {
 
     if (name == 0 || *name != 0) {
         ibis::fileManager::decreaseUse(size(), evt.c_str());
-        free(m_begin);
+        ibis::fileManager::budget::credit(size());
+        if (! (pooled && ibis::fileManager::arena::deallocate(m_begin,
+                                                              size())))
+            free(m_begin);
     }
     m_begin = 0;
     m_end = 0;
     nacc = 0;
+    pooled = false;
     if (name) {
         delete [] name;
         name = 0;
@@ -2275,13 +3034,16 @@ void* ibis::fileManager::storage::release() {
         oss << ")";
         evt += oss.str();
     }
-    if (nref() > 0)
+    if (nref() > 0) {
         ibis::fileManager::decreaseUse(size(), evt.c_str());
+        ibis::fileManager::budget::credit(size());
+    }
 
-    void *ret = m_begin;
+    void *ret = m_begin; // memory from the arena is also freed with free
     m_begin = 0;
     m_end = 0;
     nacc = 0;
+    pooled = false;
     if (name) {
         delete [] name;
         name = 0;
@@ -2494,7 +3256,8 @@ void ibis::fileManager::storage::endUse() {
 //
 /// Constructor.
 ibis::fileManager::roFile::roFile()
-    : storage(), opened(0), lastUse(0), mapped(0) {
+    : storage(), opened(0), lastUse(0), mapped(0), referenced(false),
+      prevFile(0), nextFile(0) {
 #if defined(_WIN32) && defined(_MSC_VER)
     fdescriptor = INVALID_HANDLE_VALUE;
     fmap = INVALID_HANDLE_VALUE;
@@ -2503,9 +3266,21 @@ ibis::fileManager::roFile::roFile()
     fdescriptor = -1;
     fsize = 0;
     map_begin = 0;
+    shared = 0;
 #endif
 }
 
+/// A measure of the value of keeping the file in memory.  It is the
+/// number of past accesses discounted by the number of hours since the
+/// file was last used, so that a file used often but not lately ranks
+/// below one in current use.
+double ibis::fileManager::roFile::score() const {
+    const time_t now = time(0);
+    const double idle = (lastUse > 0 && lastUse < now ?
+                         difftime(now, lastUse) : 0.0);
+    return (nacc + 1.0) * 3600.0 / (3600.0 + idle);
+} // ibis::fileManager::roFile::score
+
 /// Start using a file.  Increments the active reference.
 void ibis::fileManager::roFile::beginUse() {
     // acquire a read lock
@@ -2568,6 +3343,9 @@ void ibis::fileManager::roFile::clear() {
     if (mapped == 0) {
         free(m_begin);
     }
+    else if (mapped == 2) {
+        unshare();
+    }
     else {
 #if defined(_WIN32) && defined(_MSC_VER)
         UnmapViewOfFile(map_begin);
@@ -2686,6 +3464,9 @@ void ibis::fileManager::roFile::doRead(const char* file) {
             << file << "\"";
         return;
     }
+    if (n > 0 && ibis::fileManager::instance().sharedBytes > 0 &&
+        doShare(file, n))
+        return;
 
     int in = UnixOpen(file, OPEN_READONLY);
     if (in < 0) {
@@ -2734,6 +3515,244 @@ void ibis::fileManager::roFile::doRead(const char* file) {
     opened = time(0);
 } // ibis::fileManager::roFile::doRead
 
+#if defined(FASTBIT_SHARED_CACHE)
+/// The header of a shared memory segment holding the content of a file.
+/// It occupies the first page of the segment, the content of the file
+/// starts on the second page.
+struct _ibis_shm_header {
+    /// Zero while the content is being read, 1 when it is ready and 2 if
+    /// the reading failed.
+    volatile uint32_t state;
+    /// The number of processes attached to the segment.
+    volatile uint32_t nref;
+    /// The size of the file.
+    uint64_t bytes;
+    /// The name of the segment, used by the last process to remove it.
+    char name[96];
+};
+
+/// The total size of the shared memory segments of the current user.  It
+/// is kept in a small shared memory segment of its own, so that all
+/// processes observe the same limit.
+static volatile uint64_t *_ibis_shm_total = 0;
+static pthread_once_t _ibis_shm_once = PTHREAD_ONCE_INIT;
+static void _ibis_shm_openTotal() {
+    char nm[64];
+    sprintf(nm, "/fastbit-%lu-total", static_cast<long unsigned>(getuid()));
+    int fd = shm_open(nm, O_RDWR | O_CREAT, 0600);
+    if (fd < 0) return;
+    IBIS_BLOCK_GUARD(UnixClose, fd);
+    Stat_T st;
+    if (fstat(fd, &st) != 0) return;
+    if (st.st_size < static_cast<off_t>(sizeof(uint64_t)) &&
+        ftruncate(fd, sizeof(uint64_t)) != 0)
+        return;
+    void *addr = mmap(0, sizeof(uint64_t), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+    if (addr != MAP_FAILED)
+        _ibis_shm_total = static_cast<volatile uint64_t*>(addr);
+} // _ibis_shm_openTotal
+
+/// Reserve space for a new segment.  Returns false if the limit would be
+/// exceeded.
+static bool _ibis_shm_reserve(uint64_t bytes, uint64_t limit) {
+    (void) pthread_once(&_ibis_shm_once, _ibis_shm_openTotal);
+    if (_ibis_shm_total == 0) return false;
+    if (__sync_add_and_fetch(_ibis_shm_total, bytes) <= limit)
+        return true;
+    (void) __sync_fetch_and_sub(_ibis_shm_total, bytes);
+    return false;
+} // _ibis_shm_reserve
+
+/// Return the space of a segment removed.
+static void _ibis_shm_unreserve(uint64_t bytes) {
+    if (_ibis_shm_total != 0)
+        (void) __sync_fetch_and_sub(_ibis_shm_total, bytes);
+} // _ibis_shm_unreserve
+#endif
+
+/// Place the content of the named file in a shared memory segment, or
+/// attach to the segment already created by another process.  The name
+/// of the segment is derived from the device, inode number, size and
+/// modification time of the file, so a file modified after the segment
+/// was created is placed in a new segment.  The first process reads the
+/// file into the segment, the others wait until the content is ready and
+/// map it read-only.  The segment is removed when the last process
+/// detaches from it.  The total size of the segments is limited by the
+/// parameter fileManager.sharedBytes.
+///
+/// Returns true if the content of the file is available through the
+/// shared memory segment, otherwise false, in which case the caller is to
+/// read the file privately.
+///
+/// @note A process that terminates abnormally does not detach from the
+/// segments it uses, these segments remain until the machine restarts or
+/// they are removed by hand from /dev/shm.
+bool ibis::fileManager::roFile::doShare(const char* file, uint64_t bytes) {
+#if defined(FASTBIT_SHARED_CACHE)
+    Stat_T st;
+    if (UnixStat(file, &st) != 0 || static_cast<uint64_t>(st.st_size) != bytes)
+        return false;
+    std::string evt = "fileManager::roFile::doShare";
+    if (ibis::gVerbose > 5) {
+        evt += '(';
+        evt += file;
+        evt += ')';
+    }
+
+    ibis::fileManager &fm = ibis::fileManager::instance();
+    const size_t ps = ibis::fileManager::pageSize();
+    _ibis_shm_header hd;
+    sprintf(hd.name, "/fastbit-%lu-%lx-%lx-%lx-%lx",
+            static_cast<long unsigned>(getuid()),
+            static_cast<long unsigned>(st.st_dev),
+            static_cast<long unsigned>(st.st_ino),
+            static_cast<long unsigned>(bytes),
+            static_cast<long unsigned>(st.st_mtime));
+
+    bool creator = true;
+    int fd = shm_open(hd.name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        if (errno != EEXIST) {
+            LOGGER(ibis::gVerbose > 2)
+                << "Warning -- " << evt << " failed to create shared memory "
+                "segment " << hd.name << " -- " << strerror(errno);
+            return false;
+        }
+        creator = false;
+        fd = shm_open(hd.name, O_RDWR, 0600);
+        if (fd < 0) return false;
+    }
+    IBIS_BLOCK_GUARD(UnixClose, fd);
+    if (creator) {
+        if (! _ibis_shm_reserve(bytes, fm.sharedBytes)) {
+            LOGGER(ibis::gVerbose > 3)
+                << evt << " -- no space left for " << bytes << " bytes in "
+                "shared memory, will read the file privately";
+            (void) shm_unlink(hd.name);
+            return false;
+        }
+        if (ftruncate(fd, ps + bytes) != 0) {
+            (void) shm_unlink(hd.name);
+            _ibis_shm_unreserve(bytes);
+            return false;
+        }
+    }
+    else {
+        // the segment may still be sized by its creator
+        Stat_T sst;
+        if (fstat(fd, &sst) != 0 ||
+            static_cast<uint64_t>(sst.st_size) != ps + bytes)
+            return false;
+    }
+
+    void *addr = mmap(0, ps, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        if (creator) {
+            (void) shm_unlink(hd.name);
+            _ibis_shm_unreserve(bytes);
+        }
+        return false;
+    }
+    _ibis_shm_header *hdr = static_cast<_ibis_shm_header*>(addr);
+    void *dat = MAP_FAILED;
+    if (creator) {
+        hdr->bytes = bytes;
+        strcpy(hdr->name, hd.name);
+        hdr->nref = 1;
+        dat = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, ps);
+        bool ok = false;
+        if (dat != MAP_FAILED) {
+            int in = UnixOpen(file, OPEN_READONLY);
+            if (in >= 0) {
+                ok = (ibis::util::read(in, static_cast<char*>(dat), bytes)
+                      == static_cast<int64_t>(bytes));
+                UnixClose(in);
+                fm.recordPages(0, bytes);
+            }
+            ok = ok && (mprotect(dat, bytes, PROT_READ) == 0);
+        }
+        __sync_synchronize();
+        hdr->state = (ok ? 1 : 2);
+        if (! ok) {
+            LOGGER(ibis::gVerbose > 2)
+                << "Warning -- " << evt << " failed to read " << bytes
+                << " bytes into shared memory segment " << hd.name;
+            if (dat != MAP_FAILED)
+                munmap(dat, bytes);
+            shared = hdr;
+            unshare();
+            return false;
+        }
+    }
+    else {
+        // attach unless the last process is removing the segment
+        uint32_t nr = hdr->nref;
+        while (nr > 0 && ! __sync_bool_compare_and_swap(&(hdr->nref), nr,
+                                                        nr+1))
+            nr = hdr->nref;
+        if (nr == 0) {
+            munmap(addr, ps);
+            return false;
+        }
+
+        for (int j = 0; hdr->state == 0 && j < 1000*FASTBIT_MAX_WAIT_TIME;
+             ++ j)
+            usleep(1000);
+        __sync_synchronize();
+        if (hdr->state == 1)
+            dat = mmap(0, bytes, PROT_READ, MAP_SHARED, fd, ps);
+        if (dat == MAP_FAILED) {
+            LOGGER(ibis::gVerbose > 2)
+                << "Warning -- " << evt << " failed to attach to shared "
+                "memory segment " << hd.name << ", state = " << hdr->state;
+            shared = hdr;
+            unshare();
+            return false;
+        }
+    }
+
+    storage::clear(); // the buffer allocated by the caller is not needed
+    shared = hdr;
+    map_begin = dat;
+    fsize = bytes;
+    mapped = 2;
+    m_begin = static_cast<char*>(dat);
+    m_end = m_begin + bytes;
+    name = ibis::util::strnewdup(file);
+    opened = time(0);
+    ibis::fileManager::increaseUse(bytes, evt.c_str());
+    LOGGER(ibis::gVerbose > 4)
+        << evt << " -- " << (creator ? "created" : "attached to")
+        << " shared memory segment " << hdr->name << " with " << bytes
+        << " bytes";
+    return true;
+#else
+    return false;
+#endif
+} // ibis::fileManager::roFile::doShare
+
+/// Detach from the shared memory segment.  The last process to detach
+/// removes the segment.  This function does not update the byte count of
+/// the file manager, the caller is expected to do so.
+void ibis::fileManager::roFile::unshare() {
+#if defined(FASTBIT_SHARED_CACHE)
+    if (shared == 0) return;
+    if (mapped == 2 && map_begin != 0)
+        munmap(map_begin, fsize);
+    _ibis_shm_header *hdr = static_cast<_ibis_shm_header*>(shared);
+    if (__sync_sub_and_fetch(&(hdr->nref), 1) == 0) {
+        (void) shm_unlink(hdr->name);
+        _ibis_shm_unreserve(hdr->bytes);
+    }
+    munmap(shared, ibis::fileManager::pageSize());
+    shared = 0;
+    map_begin = 0;
+    fsize = 0;
+    mapped = 0;
+#endif
+} // ibis::fileManager::roFile::unshare
+
 /// Read a portion of a file into memory.
 /// Do NOT record the name of the file.  This is different from the one that
 /// read the whole file which automatically records the name of the file.
@@ -3089,3 +4108,46 @@ void ibis::fileManager::roFile::doMap(const char* file, off_t b, off_t e,
 } // ibis::fileManager::roFile::doMap using mmap
 #endif
 
+/// Pass the access pattern to the operating system through madvise.  The
+/// arguments @c b and @c e are byte offsets from the beginning of the
+/// storage, they are expanded to page boundaries.  Only the pages of a
+/// memory mapped file are affected, the advice is ignored for the files
+/// read into memory and on systems without madvise.
+void ibis::fileManager::roFile::advise(ACCESS_PATTERN pat, size_t b,
+                                       size_t e) const {
+#if (HAVE_MMAP+0 > 0) && defined(MADV_WILLNEED) && !defined(_WIN32)
+    if (mapped == 0 || m_begin == 0 || b >= e || b >= size()) return;
+    if (e > size())
+        e = size();
+
+    const size_t ps = ibis::fileManager::pageSize();
+    char *addr = m_begin + b;
+    // the start must be on a page boundary, which is never before
+    // map_begin since map_begin is on a page boundary
+    char *start = static_cast<char*>(map_begin) +
+        ps * ((addr - static_cast<char*>(map_begin)) / ps);
+    const size_t len = (m_begin + e) - start;
+    int adv = MADV_NORMAL;
+    switch (pat) {
+    default:
+    case ibis::fileManager::ACCESS_NORMAL:
+        break;
+    case ibis::fileManager::ACCESS_SEQUENTIAL:
+        adv = MADV_SEQUENTIAL;
+        break;
+    case ibis::fileManager::ACCESS_RANDOM:
+        adv = MADV_RANDOM;
+        break;
+    case ibis::fileManager::ACCESS_WILLNEED:
+        adv = MADV_WILLNEED;
+        break;
+    }
+    int ierr = madvise(start, len, adv);
+    LOGGER(ierr != 0 && ibis::gVerbose > 3)
+        << "Warning -- roFile::advise(" << (name ? name : "?") << ", "
+        << static_cast<int>(pat) << ", " << b << ", " << e
+        << ") -- madvise failed with errno " << errno << ", "
+        << strerror(errno);
+#endif
+} // ibis::fileManager::roFile::advise
+
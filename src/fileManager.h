@@ -16,6 +16,26 @@
 
 #include <set>		// std::set
 #include <map>		// std::map
+#include <deque>	// std::deque
+
+/// The number of shards in the lookup table of the file manager.  Each
+/// shard has its own mutex lock so that threads looking for files already
+/// in memory rarely contend with each other or with a thread reading a
+/// new file.
+#ifndef FASTBIT_FILE_SHARDS
+#define FASTBIT_FILE_SHARDS 16
+#endif
+
+/// The maximum number of unloaded files whose access statistics are kept
+/// for the manifest written by ibis::fileManager::saveManifest.
+#ifndef FASTBIT_MANIFEST_SIZE
+#define FASTBIT_MANIFEST_SIZE 4096
+#endif
+
+/// The number of size classes of ibis::fileManager::arena.  The classes
+/// cover the sizes from 64 bytes to 1 MB with four classes for every
+/// power of two.
+#define FASTBIT_ARENA_CLASSES 57
 
 /// @ingroup FastBitIBIS
 /// This fileManager is intended to allow different objects to share the
@@ -32,6 +52,15 @@ public:
 	PREFER_MMAP		// try to use mmap if possible
     };
 
+    /// Hint passed to the function @c storage::advise.  It describes how
+    /// a portion of a memory mapped file is to be accessed.
+    enum ACCESS_PATTERN {
+	ACCESS_NORMAL,		// no particular pattern
+	ACCESS_SEQUENTIAL,	// from the lower address to the higher one
+	ACCESS_RANDOM,		// a few pages in no particular order
+	ACCESS_WILLNEED		// will be accessed soon
+    };
+
     template<typename T>
     int getFile(const char* name, array_t<T>& arr,
 		ACCESS_PREFERENCE pref=MMAP_LARGE_FILES);
@@ -61,6 +90,12 @@ public:
     static inline void decreaseUse(size_t dec, const char* evt);
     /// Signal to the file manager that some memory have been freed.
     void signalMemoryAvailable() const;
+    /// Start reading the named file in the background.
+    void prefetch(const char* name);
+    /// Write the names of the frequently used files to a manifest.
+    int saveManifest(const char* manifest) const;
+    /// Read the files listed in a manifest, up to @c limit bytes.
+    int64_t warmUp(const char* manifest, uint64_t limit=0);
 
     /// A function object to be used to register external cleaners.
     class cleaner {
@@ -73,6 +108,8 @@ public:
 
     class roFile; // forward declaration of fileManager::roFile
     class storage; // forward declaration of fileManager::storage
+    class budget; // forward declaration of fileManager::budget
+    class arena; // forward declaration of fileManager::arena
 #if defined(HAVE_FILE_MAP)
     class rofSegment; // forward declaration of fileManager::rofSegment
 #endif
@@ -190,6 +227,19 @@ private:
     fileList incore;
     /// Files that are being read by the function getFile.
     nameList reading;
+    /// A portion of the lookup table for files in memory.  The union of
+    /// all shards contains the same files as mapped and incore, but each
+    /// shard is protected by its own mutex lock so that getFile and
+    /// tryGetFile can find a file in memory without the main mutex lock.
+    struct shard {
+	pthread_mutex_t lock;
+	fileList files;
+    };
+    /// The lookup table for files in memory.
+    shard shards[FASTBIT_FILE_SHARDS];
+    /// The current position of the CLOCK hand.  The files in memory are
+    /// linked into a ring and unload sweeps the ring from this position.
+    roFile *hand;
     /// List of external cleaners.
     cleanerList cleaners;
     /// The number of pages read by read from @c unistd.h.
@@ -198,9 +248,35 @@ private:
     uint32_t minMapSize;
     /// Number of threads waiting for memory.
     uint32_t nwaiting;
+    /// The maximum number of bytes of all shared memory segments created
+    /// by the processes of the same user.  Zero if the files are not to be
+    /// shared with other processes.
+    uint64_t sharedBytes;
     /// The conditional variable for reading list.
     pthread_cond_t readCond;
 
+    /// Access statistics of a file no longer in memory.
+    struct fileStat {
+	uint64_t bytes;	///!< The size of the file.
+	unsigned nacc;	///!< The number of past accesses.
+	double score;	///!< The score at the time of unloading.
+    };
+    typedef std::map< std::string, fileStat > statList;
+    /// The files unloaded to make room for others.  They are remembered
+    /// so that saveManifest can list them along with the files in memory.
+    statList unloaded;
+
+    /// Names of the files waiting to be prefetched.
+    std::deque<std::string> pending;
+    /// The threads serving the prefetch requests.
+    std::vector<pthread_t> fetchers;
+    /// Set to true to tell the prefetch threads to exit.
+    bool stopFetching;
+    /// Protect pending and fetchers.
+    pthread_mutex_t fetchLock;
+    /// Signal the arrival of new prefetch requests.
+    pthread_cond_t fetchCond;
+
     /// The multiple read single write lock
     //mutable pthread_rwlock_t lock;
     /// Control access to incore and mapped
@@ -215,7 +291,16 @@ private:
     static uint32_t pagesize;
 
     int unload(size_t size);	// try to unload size bytes
+    uint32_t sweep(size_t size);	// one round of CLOCK replacement
+    shard& shardOf(const char* name);
+    roFile* findFile(const char* name);
+    void linkFile(roFile*);
+    void unlinkFile(roFile*);
     void invokeCleaners() const;// invoke external cleaners
+    void rememberFile(const roFile*);
+    static void* warmUpThread(void*);
+    void fetchFiles();		// serve the prefetch requests
+    static void* fetchThread(void*);
     //inline void gainWriteAccess(const char* m) const;
 
     // class writeLock;
@@ -282,6 +367,9 @@ public:
 
     /// Is the storage a file map ?
     virtual bool isFileMap() const {return false;}
+    /// Advise the operating system how the bytes [b, e) are to be
+    /// accessed.  It does nothing unless the storage is a file map.
+    virtual void advise(ACCESS_PATTERN, size_t, size_t) const {}
     // IO functions
     virtual void printStatus(std::ostream& out) const;
     off_t read(const char* fname, const off_t begin, const off_t end);
@@ -307,6 +395,8 @@ protected:
     unsigned nacc;
     /// Number of (active) references to this storage.
     ibis::util::sharedInt32 nref;
+    /// Was the memory obtained through arena::allocate?
+    bool pooled;
 
     virtual void clear(); // free memory/close file
 }; // class fileManager::storage
@@ -329,7 +419,9 @@ public:
     virtual void endUse();
     // is the read-only file mapped ?
     virtual bool isFileMap() const {return (mapped != 0);}
+    virtual void advise(ACCESS_PATTERN pat, size_t b, size_t e) const;
     int disconnectFile();
+    double score() const;
 
     // IO functions
     virtual void printStatus(std::ostream& out) const;
@@ -353,27 +445,10 @@ protected:
 #if defined(HAVE_FILE_MAP)
     void doMap(const char* file, off_t b, off_t e, int opt=0);
 #endif
-
-    /// The function assigns a score to a file.  It is used by
-    /// ibis::fileManager::unload to determine what files to remove.  Files
-    /// with the smallest scores are the target for removal.
-    float score() const {
-	float sc = FLT_MAX;
-	time_t now = time(0);
-	if (opened >= now) {
-	    sc = static_cast<float>(1e-4 * size() + nacc);
-	}
-	else if (lastUse >= now) {
-	    sc = static_cast<float>(sqrt(5e-6*size()) + nacc +
-				    (now - opened));
-	}
-	else {
-	    sc = static_cast<float>((sqrt(1e-6*size() + now - opened) +
-				     (static_cast<double>(nacc) /
-				      (now - opened))) / (now - lastUse));
-	}
-	return sc;
-    }
+    // Attach to the shared memory segment holding the content of the file.
+    bool doShare(const char* file, uint64_t bytes);
+    // Detach from the shared memory segment.
+    void unshare();
 
     friend class ibis::fileManager;
     virtual void clear(); // free memory/close file
@@ -386,8 +461,15 @@ private:
     time_t opened;
     /// time of last use
     time_t lastUse;
-    /// 0 not a mapped file, otherwise yes
+    /// 0 not a mapped file, 1 a file map, 2 a shared memory segment
     unsigned mapped;
+    /// The reference bit of the CLOCK replacement policy.  Set when the
+    /// file is found in memory, cleared as the CLOCK hand passes by.
+    bool referenced;
+    /// The previous file in the CLOCK ring.
+    roFile *prevFile;
+    /// The next file in the CLOCK ring.
+    roFile *nextFile;
 
 #if defined(_WIN32) && defined(_MSC_VER)
     HANDLE fdescriptor; // HANDLE to the open file
@@ -397,6 +479,7 @@ private:
     int fdescriptor; // descriptor of the open file
     size_t fsize;    // the size of the mapped portion of file
     void *map_begin; // actual address returned by mmap
+    void *shared;    // header of the shared memory segment
 #endif
 
     // not implemented, to prevent automatic generation
@@ -425,6 +508,118 @@ private:
 }; // ibis::fileManager::rofSegment
 #endif
 
+/// A memory budget for a query.  While an object of this class exists,
+/// the in-memory storage objects allocated by the thread that created it
+/// are charged against the budget.  This covers the memory of the array_t
+/// and bitvector objects, and the in-memory data partitions produced by
+/// select operations, but not the files read by the file manager.  If the
+/// budget has a limit, an allocation that would exceed the limit throws
+/// an ibis::bad_alloc exception, which fails only the query owning the
+/// budget.
+///
+/// A budget with a limit also reserves that much memory from the memory
+/// set aside for queries, which is given by the parameter
+/// fileManager.queryMemory.  When the memory set aside is reserved by
+/// other queries, the constructor waits until enough of it is returned.
+/// The queries waiting are admitted in the order of their arrival.  A
+/// large query therefore waits for its turn instead of pushing the
+/// indexes of other queries out of memory.
+///
+/// A budget created while another one is in effect in the same thread
+/// does not reserve any memory, the allocations continue to be charged
+/// to the outer one.
+class FASTBIT_CXX_DLLSPEC ibis::fileManager::budget {
+public:
+    budget(uint64_t limit, const char *owner);
+    ~budget();
+
+    /// The maximum number of bytes that may be charged.  0 for no limit.
+    uint64_t limit() const {return m_limit;}
+    /// The number of bytes currently charged.
+    uint64_t inUse() const {return m_used;}
+    /// The largest number of bytes charged at any time.
+    uint64_t peak() const {return m_peak;}
+    /// Has an allocation been refused because of the limit?
+    bool exceeded() const {return m_exceeded;}
+
+    static budget* current();
+    static void charge(size_t n);
+    static void credit(size_t n);
+
+private:
+    /// The name of the operation owning the budget.
+    const char *m_owner;
+    /// The limit.
+    uint64_t m_limit;
+    /// The number of bytes reserved from fileManager.queryMemory.
+    uint64_t m_reserved;
+    /// The number of bytes charged.
+    uint64_t m_used;
+    /// The high water mark of m_used.
+    uint64_t m_peak;
+    /// Is this budget in effect?  False for nested budgets.
+    bool m_active;
+    /// Has an allocation been refused?
+    bool m_exceeded;
+
+    budget(const budget&); // no copy constructor
+    budget& operator=(const budget&); // no assignment operator
+}; // ibis::fileManager::budget
+
+/// A pool of memory for the temporary objects of a query.  While an
+/// object of this class exists, the in-memory storage objects allocated
+/// by the thread that created it draw their memory from the pool.  A
+/// storage object freed in the same thread returns its memory to the pool
+/// instead of the system, and the next storage object of a similar size
+/// reuses it without calling malloc.  This covers the array_t and
+/// bitvector objects created and discarded many times while a query is
+/// evaluated.  All memory left in the pool is returned to the system when
+/// the pool is destroyed.
+///
+/// The memory is allocated with malloc in a small number of sizes, four
+/// for each power of two between 64 bytes and 1 MB, so that a piece of
+/// memory may be reused for any request of the same size class.  Larger
+/// requests are not pooled.  A storage object that outlives the pool, for
+/// example the hits of a query, holds an ordinary piece of memory from
+/// malloc and is freed normally.  The memory kept in the pool is limited
+/// by the parameter fileManager.arenaBytes, default to 8 MB.  A value of
+/// 0 turns off pooling.
+///
+/// A pool created while another one is in effect in the same thread does
+/// nothing, the outer one continues to serve the thread.
+class FASTBIT_CXX_DLLSPEC ibis::fileManager::arena {
+public:
+    explicit arena(const char *owner);
+    ~arena();
+
+    /// The number of requests served from the pool.
+    uint64_t reused() const {return m_reused;}
+
+    static arena* current();
+    static char* allocate(size_t n);
+    static bool deallocate(char *addr, size_t n);
+
+private:
+    /// The name of the operation owning the pool.
+    const char *m_owner;
+    /// The maximum number of bytes to keep in the pool.
+    uint64_t m_limit;
+    /// The number of bytes in the pool.
+    uint64_t m_pooled;
+    /// The number of requests for memory.
+    uint64_t m_requests;
+    /// The number of requests served from the pool.
+    uint64_t m_reused;
+    /// Is this pool in effect?  False for nested pools.
+    bool m_active;
+    /// The lists of free memory, one for each size class.  The first
+    /// bytes of a free piece of memory hold the address of the next one.
+    char *m_free[FASTBIT_ARENA_CLASSES];
+
+    arena(const arena&); // no copy constructor
+    arena& operator=(const arena&); // no assignment operator
+}; // ibis::fileManager::arena
+
 // /// A write lock for controlling access to the two internal lists.
 // class ibis::fileManager::writeLock {
 // public:
@@ -556,6 +751,7 @@ ibis::fileManager::storage::swap(ibis::fileManager::storage& rhs) throw () {
     {char* tmp = m_begin; m_begin = rhs.m_begin; rhs.m_begin = tmp;}
     {char* tmp = m_end; m_end = rhs.m_end; rhs.m_end = tmp;}
     {unsigned itmp = nacc; nacc = rhs.nacc; rhs.nacc = itmp;}
+    {bool btmp = pooled; pooled = rhs.pooled; rhs.pooled = btmp;}
     //nref.swap(rhs.nref);
 } // ibis::fileManager::storage::swap
 #endif // IBIS_FILEMANAGER_H
@@ -209,6 +209,7 @@ int64_t ibis::filter::count() const {
             nhits += (*it)->nRows();
         return nhits;
     }
+    ibis::fileManager::arena pool("filter::count");
     if (hits_.size() == myparts.size()) {
         if (cand_.empty()) {
             for (array_t<bitvector*>::const_iterator it = hits_.begin();
@@ -263,6 +264,8 @@ int64_t ibis::filter::count() const {
         else {
             ierr = qq.setPartition(myparts[j]);
             if (ierr >= 0) {
+                if (j+1 < myparts.size())
+                    myparts[j+1]->prefetch(wc_->getExpr());
                 ierr = qq.evaluate();
                 if (ierr >= 0) {
                     nhits += qq.getNumHits();
@@ -1487,6 +1490,8 @@ ibis::table* ibis::filter::sift2(const ibis::selectClause  &tms,
             continue;
         }
 
+        if (it+1 != plist.end()) // overlap the reading of the next one
+            (*(it+1))->prefetch(cond.getExpr());
         ierr = qq.evaluate();
         if (ierr < 0) {
             LOGGER(ibis::gVerbose > 1)
@@ -1814,6 +1819,8 @@ ibis::table* ibis::filter::sift2(const ibis::selectClause        &tms,
             continue;
         }
 
+        if (j+1 < plist.size()) // overlap the reading of the next one
+            plist[j+1]->prefetch(cond.getExpr());
         ierr = qq.evaluate();
         if (ierr < 0) {
             LOGGER(ibis::gVerbose > 1)
@@ -2011,6 +2018,8 @@ ibis::table* ibis::filter::sift2S(const ibis::selectClause  &tms,
             continue;
         }
 
+        if (it+1 != plist.end()) // overlap the reading of the next one
+            (*(it+1))->prefetch(cond.getExpr());
         ierr = qq.evaluate();
         if (ierr < 0) {
             LOGGER(ibis::gVerbose > 1)
@@ -2527,6 +2536,8 @@ ibis::table* ibis::filter::sift2S(const ibis::selectClause        &tms,
             continue;
         }
 
+        if (j+1 < plist.size()) // overlap the reading of the next one
+            plist[j+1]->prefetch(cond.getExpr());
         ierr = qq.evaluate();
         if (ierr < 0) {
             LOGGER(ibis::gVerbose > 1)
@@ -2704,28 +2715,44 @@ ibis::table* ibis::filter::sift2S(const ibis::selectClause        &tms,
 /// unpredictable way if the selected records can not fit in the available
 /// memory.
 ///
+/// The memory used is charged to an ibis::fileManager::budget with the
+/// limit given by the parameter fileManager.queryBudget.  If the limit is
+/// exceeded, this function returns a nil pointer without disturbing the
+/// files cached for other queries.
+///
 /// If the select clause is missing, the return table will have no columns
 /// and the number of rows is the number of rows satisfying the query
 /// conditions.  An empty query condition matches all rows following the
 /// SQL convension.
 ibis::table* ibis::table::select(const ibis::constPartList& mylist,
                                  const char *sel, const char *cond) {
+    ibis::fileManager::budget bdg
+        (static_cast<uint64_t>
+         (ibis::gParameters().getNumber("fileManager.queryBudget")),
+         "table::select");
+    ibis::fileManager::arena pool("table::select");
+    ibis::table *res = 0;
     try {
-        if (mylist.empty())
-            return new ibis::tabula(); // return an empty unnamed table
-
-        if (sel == 0 || *sel == 0)
-            return new ibis::tabula(ibis::table::computeHits(mylist, cond));
-
-        ibis::selectClause sc(sel);
-        if (sc.empty())
-            return new ibis::tabula(ibis::table::computeHits(mylist, cond));
-
-        if (cond == 0 || *cond == 0)
-            return ibis::filter::sift0(sc, mylist);
-
-        ibis::whereClause wc(cond);
-        return ibis::filter::sift(sc, mylist, wc);
+        if (mylist.empty()) {
+            res = new ibis::tabula(); // return an empty unnamed table
+        }
+        else if (sel == 0 || *sel == 0) {
+            res = new ibis::tabula(ibis::table::computeHits(mylist, cond));
+        }
+        else {
+            ibis::selectClause sc(sel);
+            if (sc.empty()) {
+                res = new ibis::tabula
+                    (ibis::table::computeHits(mylist, cond));
+            }
+            else if (cond == 0 || *cond == 0) {
+                res = ibis::filter::sift0(sc, mylist);
+            }
+            else {
+                ibis::whereClause wc(cond);
+                res = ibis::filter::sift(sc, mylist, wc);
+            }
+        }
     }
     catch (const ibis::bad_alloc &e) {
         if (ibis::gVerbose > 1) {
@@ -2737,7 +2764,8 @@ ibis::table* ibis::table::select(const ibis::constPartList& mylist,
                 ibis::fileManager::instance().printStatus(lg());
             }
         }
-        ibis::util::emptyCache();
+        if (! bdg.exceeded()) // only this query is short of memory
+            ibis::util::emptyCache();
     }
     catch (const std::exception &e) {
         if (ibis::gVerbose > 1) {
@@ -2775,7 +2803,16 @@ ibis::table* ibis::table::select(const ibis::constPartList& mylist,
         }
         ibis::util::emptyCache();
     }
-    return 0;
+    if (res != 0 && bdg.exceeded()) {
+        // some values were not selected because of the budget
+        LOGGER(ibis::gVerbose > 1)
+            << "Warning -- table::select exceeded its memory budget of "
+            << ibis::util::groupby1000(bdg.limit())
+            << " bytes, will return a nil pointer";
+        delete res;
+        res = 0;
+    }
+    return res;
 } // ibis::table::select
 
 /// Upon successful completion of this function, it produces an in-memory
@@ -2783,29 +2820,43 @@ ibis::table* ibis::table::select(const ibis::constPartList& mylist,
 /// unpredictable way if the selected records can not fit in available
 /// memory.
 ///
+/// The memory used is charged to an ibis::fileManager::budget, see the
+/// other version of this function.
+///
 /// If the select clause is missing, the return table will have no columns
 /// and the number of rows is the number of rows satisfying the query
 /// conditions.  An empty query condition matches all rows following the
 /// SQL convension.
 ibis::table* ibis::table::select(const ibis::constPartList& plist,
                                  const char *sel, const ibis::qExpr *cond) {
+    ibis::fileManager::budget bdg
+        (static_cast<uint64_t>
+         (ibis::gParameters().getNumber("fileManager.queryBudget")),
+         "table::select");
+    ibis::fileManager::arena pool("table::select");
+    ibis::table *res = 0;
     try {
-        if (plist.empty())
-            return new ibis::tabula(); // return an empty unnamed table
-
-        if (sel == 0 || *sel == 0)
-            return new ibis::tabula(ibis::table::computeHits(plist, cond));
-
-        ibis::selectClause sc(sel);
-        if (sc.empty())
-            return new ibis::tabula(ibis::table::computeHits(plist, cond));
-
-        if (cond == 0)
-            return ibis::filter::sift0(sc, plist);
-
-        ibis::whereClause wc;
-        wc.setExpr(cond);
-        return ibis::filter::sift(sc, plist, wc);
+        if (plist.empty()) {
+            res = new ibis::tabula(); // return an empty unnamed table
+        }
+        else if (sel == 0 || *sel == 0) {
+            res = new ibis::tabula(ibis::table::computeHits(plist, cond));
+        }
+        else {
+            ibis::selectClause sc(sel);
+            if (sc.empty()) {
+                res = new ibis::tabula
+                    (ibis::table::computeHits(plist, cond));
+            }
+            else if (cond == 0) {
+                res = ibis::filter::sift0(sc, plist);
+            }
+            else {
+                ibis::whereClause wc;
+                wc.setExpr(cond);
+                res = ibis::filter::sift(sc, plist, wc);
+            }
+        }
     }
     catch (const ibis::bad_alloc &e) {
         if (ibis::gVerbose > 1) {
@@ -2815,7 +2866,8 @@ ibis::table* ibis::table::select(const ibis::constPartList& plist,
             if (ibis::gVerbose > 3)
                 ibis::fileManager::instance().printStatus(lg());
         }
-        ibis::util::emptyCache();
+        if (! bdg.exceeded()) // only this query is short of memory
+            ibis::util::emptyCache();
     }
     catch (const std::exception &e) {
         if (ibis::gVerbose > 1) {
@@ -2853,5 +2905,14 @@ ibis::table* ibis::table::select(const ibis::constPartList& plist,
         }
         ibis::util::emptyCache();
     }
-    return 0;
+    if (res != 0 && bdg.exceeded()) {
+        // some values were not selected because of the budget
+        LOGGER(ibis::gVerbose > 1)
+            << "Warning -- table::select exceeded its memory budget of "
+            << ibis::util::groupby1000(bdg.limit())
+            << " bytes, will return a nil pointer";
+        delete res;
+        res = 0;
+    }
+    return res;
 } // ibis::table::select
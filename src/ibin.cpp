@@ -5716,9 +5716,10 @@ int ibis::bin::write32(int fdes) const {
         (void) UnixSeek(fdes, start, SEEK_SET);
         return -9;
     }
+    const BITMAP_FORMAT fmt = bitmapFormat();
     for (uint32_t i = 0; i < nobs; ++i) {
         if (bits[i] != 0)
-            bits[i]->write(fdes);
+            writeBitmap(fdes, *bits[i], fmt);
         offset32[i+1] = UnixSeek(fdes, 0, SEEK_CUR);
     }
     ierr = UnixSeek(fdes, start+2*sizeof(uint32_t), SEEK_SET);
@@ -5806,9 +5807,10 @@ int ibis::bin::write64(int fdes) const {
         (void) UnixSeek(fdes, start, SEEK_SET);
         return -14;
     }
+    const BITMAP_FORMAT fmt = bitmapFormat();
     for (uint32_t i = 0; i < nobs; ++i) {
         if (bits[i] != 0)
-            bits[i]->write(fdes);
+            writeBitmap(fdes, *bits[i], fmt);
         offset64[i+1] = UnixSeek(fdes, 0, SEEK_CUR);
     }
     ierr = UnixSeek(fdes, start+2*sizeof(uint32_t), SEEK_SET);
@@ -372,6 +372,11 @@ namespace ibis {
     ///   logfile = /tmp/ibis.log
     ///@endverbatim
     ///
+    /// If the parameter fileManager.manifest names a file written by
+    /// ibis::fileManager::saveManifest, the files listed in it are read
+    /// into memory before this function returns.  This reduces the time
+    /// needed to answer the first queries after a restart.
+    ///
     /// One may call ibis::util::closeLogFile to close the log file, but
     /// this is not mandatory.  The runtime system will close all open
     /// files upon the termination of the user program.
@@ -429,6 +434,13 @@ namespace ibis {
                 std::cerr << "ibis::init found " << ierr << " data partition"
                           << (ierr > 1 ? "s" : "") << std::endl;
         }
+	if (ibis::gParameters()["fileManager.manifest"] != 0) {
+	    // bring the files used before the last shutdown back into memory
+	    (void) ibis::fileManager::instance().warmUp
+		(ibis::gParameters()["fileManager.manifest"],
+		 static_cast<uint64_t>(ibis::gParameters().getNumber
+				       ("fileManager.warmUpBytes")));
+	}
 #if defined(_WIN32) && defined(_MSC_VER) && (defined(_DEBUG) || defined(DEBUG))
 	std::cerr << "DEBUG - WIN32 related macros";
 #ifdef NTDDI_VERSION
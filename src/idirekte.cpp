@@ -738,10 +738,11 @@ int ibis::direkte::write(const char* dt) const {
             << ", ierr = " << ierr;
         return -5;
     }
+    const BITMAP_FORMAT fmt = bitmapFormat();
     for (uint32_t i = 0; i < nobs; ++ i) {
         if (bits[i] != 0) {
             if (bits[i]->cnt() > 0)
-                bits[i]->write(fdes);
+                writeBitmap(fdes, *bits[i], fmt);
         }
         offset64[i+1] = UnixSeek(fdes, 0, SEEK_CUR);
     }
@@ -5613,75 +5613,16 @@ void ibis::index::addBins(uint32_t ib, uint32_t ie,
     else if (bytes*static_cast<double>(na)*na <= log(2.0)*uncomp) {
         LOGGER(ibis::gVerbose > 5)
             << "index::addBins(" << ib << ", " << ie
-            << ") uses a priority queue to OR the bitmaps";
-        typedef std::pair<ibis::bitvector*, bool> _elem;
-        // put all bitmaps in a priority queue
-        std::priority_queue<_elem> que;
-        _elem op1, op2, tmp;
-        tmp.first = 0;
-
-        // populate the priority queue with the original input
+            << ") uses orMany to OR the bitmaps";
+        array_t<bitvector*> ops;
+        ops.reserve(na + 1);
+        ops.push_back(&res);
         for (uint32_t i = ib; i < ie; ++i) {
             if (bits[i]) {
-                op1.first = bits[i];
-                op1.second = false;
-                que.push(op1);
-            }
-        }
-
-        try {
-            while (! que.empty()) {
-                op1 = que.top();
-                que.pop();
-                if (que.empty()) {
-                    res.copy(*(op1.first));
-                    if (op1.second) delete op1.first;
-                    break;
-                }
-
-                op2 = que.top();
-                que.pop();
-                tmp.second = true;
-                tmp.first = *(op1.first) | *(op2.first);
-#if DEBUG+0 > 0 || _DEBUG+0 > 0
-                LOGGER(ibis::gVerbose >= 0)
-                    << "DEBUG -- addBins-using priority queue: "
-                    << op1.first->bytes()
-                    << (op1.second ? "(transient), " : ", ")
-                    << op2.first->bytes()
-                    << (op2.second ? "(transient) >> " : " >> ")
-                    << tmp.first->bytes();
-#endif
-                if (op1.second)
-                    delete op1.first;
-                if (op2.second)
-                    delete op2.first;
-                if (! que.empty()) {
-                    que.push(tmp);
-                    tmp.first = 0;
-                }
-            }
-            if (tmp.first != 0) {
-                if (tmp.second) {
-                    res |= *(tmp.first);
-                    delete tmp.first;
-                    tmp.first = 0;
-                }
-                else {
-                    res |= *(tmp.first);
-                }
-            }
-        }
-        catch (...) { // need to free the pointers
-            delete tmp.first;
-            while (! que.empty()) {
-                tmp = que.top();
-                if (tmp.second)
-                    delete tmp.first;
-                que.pop();
+                ops.push_back(bits[i]);
             }
-            throw;
         }
+        res.orMany(ops);
     }
     else if (sum2 <= (uncomp >> 2)) {
         LOGGER(ibis::gVerbose > 5)
@@ -5745,7 +5686,6 @@ void ibis::index::addBins(uint32_t ib, uint32_t ie, ibis::bitvector& res,
         return;
     }
 
-    typedef std::pair<ibis::bitvector*, bool> _elem;
     const size_t nobs = bits.size();
     if (ie > nobs) ie = nobs;
     bool straight = true;
@@ -5909,72 +5849,16 @@ void ibis::index::addBins(uint32_t ib, uint32_t ie, ibis::bitvector& res,
             if (bytes*static_cast<double>(na)*na <= log(2.0)*uncomp) {
                 LOGGER(ibis::gVerbose > 5)
                     << "index::addBins(" << ib << ", " << ie
-                    << ") uses a priority queue to OR the bitmaps";
-                // put all bitmaps in a priority queue
-                std::priority_queue<_elem> que;
-                _elem op1, op2, tmp;
-                tmp.first = 0;
-
-                // populate the priority queue with the original input
+                    << ") uses orMany to OR the bitmaps";
+                array_t<bitvector*> ops;
+                ops.reserve(na + 1);
+                ops.push_back(&res);
                 for (uint32_t i = ib; i < ie; ++i) {
                     if (bits[i]) {
-                        op1.first = bits[i];
-                        op1.second = false;
-                        que.push(op1);
+                        ops.push_back(bits[i]);
                     }
                 }
-
-                try {
-                    while (! que.empty()) {
-                        op1 = que.top();
-                        que.pop();
-                        if (que.empty()) {
-                            res.copy(*(op1.first));
-                            if (op1.second) delete op1.first;
-                            break;
-                        }
-
-                        op2 = que.top();
-                        que.pop();
-                        tmp.second = true;
-                        tmp.first = *(op1.first) | *(op2.first);
-#if DEBUG+0 > 0 || _DEBUG+0 > 0
-                        LOGGER(ibis::gVerbose >= 0)
-                            << "DEBUG -- addBins-using priority queue: "
-                            << op1.first->bytes()
-                            << (op1.second ? "(transient), " : ", ")
-                            << op2.first->bytes()
-                            << (op2.second ? "(transient) >> " : " >> ")
-                            << tmp.first->bytes();
-#endif
-                        if (op1.second) delete op1.first;
-                        if (op2.second) delete op2.first;
-                        if (! que.empty()) {
-                            que.push(tmp);
-                            tmp.first = 0;
-                        }
-                    }
-                    if (tmp.first != 0) {
-                        if (tmp.second) {
-                            res |= *(tmp.first);
-                            delete tmp.first;
-                            tmp.first = 0;
-                        }
-                        else {
-                            res |= *(tmp.first);
-                        }
-                    }
-                }
-                catch (...) { // need to free the pointers
-                    delete tmp.first;
-                    while (! que.empty()) {
-                        tmp = que.top();
-                        if (tmp.second)
-                            delete tmp.first;
-                        que.pop();
-                    }
-                    throw;
-                }
+                res.orMany(ops);
             }
             else {
                 LOGGER(ibis::gVerbose > 5)
@@ -6065,79 +5949,20 @@ void ibis::index::addBins(uint32_t ib, uint32_t ie, ibis::bitvector& res,
             if (bytes*static_cast<double>(na)*na <= log(2.0)*uncomp) {
                 LOGGER(ibis::gVerbose > 5)
                     << "index::addBins(" << ib << ", " << ie
-                    << ") uses a priority queue to OR the bitmaps (complement)";
-                // use priority queue for all bitmaps
-                std::priority_queue<_elem> que;
-                _elem op1, op2, tmp;
-                tmp.first = 0;
-
-                // populate the priority queue with the original input
+                    << ") uses orMany to OR the bitmaps (complement)";
+                array_t<bitvector*> ops;
+                ops.reserve(na);
                 for (uint32_t i = 0; i < ib; ++i) {
                     if (bits[i]) {
-                        op1.first = bits[i];
-                        op1.second = false;
-                        que.push(op1);
+                        ops.push_back(bits[i]);
                     }
                 }
                 for (uint32_t i = ie; i < nobs; ++i) {
                     if (bits[i]) {
-                        op1.first = bits[i];
-                        op1.second = false;
-                        que.push(op1);
-                    }
-                }
-
-                try {
-                    while (! que.empty()) {
-                        op1 = que.top();
-                        que.pop();
-                        if (que.empty()) {
-                            res.copy(*(op1.first));
-                            if (op1.second) delete op1.first;
-                            break;
-                        }
-
-                        op2 = que.top();
-                        que.pop();
-                        tmp.second = true;
-                        tmp.first = *(op1.first) | *(op2.first);
-#if DEBUG+0 > 0 || _DEBUG+0 > 0
-                        LOGGER(ibis::gVerbose >= 0)
-                            << "DEBUG -- addBins-using priority queue: "
-                            << op1.first->bytes()
-                            << (op1.second ? "(transient), " : ", ")
-                            << op2.first->bytes()
-                            << (op2.second ? "(transient) >> " : " >> ")
-                            << tmp.first->bytes();
-#endif
-                        if (op1.second) delete op1.first;
-                        if (op2.second) delete op2.first;
-                        if (! que.empty()) {
-                            que.push(tmp);
-                            tmp.first = 0;
-                        }
-                    }
-                    if (tmp.first != 0) {
-                        if (tmp.second) {
-                            sum.swap(*(tmp.first));
-                            delete tmp.first;
-                            tmp.first = 0;
-                        }
-                        else {
-                            sum.copy(*(tmp.first));
-                        }
+                        ops.push_back(bits[i]);
                     }
                 }
-                catch (...) { // need to free the pointers
-                    delete tmp.first;
-                    while (! que.empty()) {
-                        tmp = que.top();
-                        if (tmp.second)
-                            delete tmp.first;
-                        que.pop();
-                    }
-                    throw;
-                }
+                sum.orMany(ops);
             }
             else if (sum2 <= (uncomp >> 2)){
                 LOGGER(ibis::gVerbose > 5)
@@ -6246,8 +6071,8 @@ void ibis::index::addBins(uint32_t ib, uint32_t ie, ibis::bitvector& res,
 /// - If there are two or less bit vectors, use |= operator directly.
 /// - Compute the total size of the bitmaps involved.
 /// - If the total size times log(number of bitvectors involved) is less
-///   than the size of an uncompressed bitvector, use a priority queue to
-///   store all input bitvectors and intermediate solutions,
+///   than the size of an uncompressed bitvector, use
+///   ibis::bitvector::orMany to combine all input bitvectors in one pass,
 /// - or else, decompress the first bitvector and use inplace bitwise OR
 ///   operator to complete the operations.
 void ibis::index::sumBins(uint32_t ib, uint32_t ie, ibis::bitvector& res,
@@ -6342,54 +6167,16 @@ void ibis::index::sumBins(uint32_t ib, uint32_t ie, ibis::bitvector& res,
         if (bytes*static_cast<double>(na)*na <= log(2.0)*uncomp) {
             LOGGER(ibis::gVerbose > 5)
                 << evt << "(" << ib << ", " << ie
-                << ") performs bitwise OR with a priority queue";
-            // put all bitmaps in a priority queue
-            std::priority_queue<ibis::bitvector*> que;
-            ibis::bitvector *op1, *op2, *tmp;
-            tmp = 0;
-
-            // populate the priority queue with the original input
+                << ") performs bitwise OR with orMany";
+            std::vector<ibis::bitvector> tmp(ie - ib);
+            array_t<bitvector*> ops(ie - ib);
             for (uint32_t i = ib; i < ie; ++i) {
-                tmp = new ibis::bitvector(buf+offset64[i]-offset64[ib],
-                                          offset64[i+1]-offset64[i]);
-                que.push(tmp);
-            }
-
-            try {
-                while (! que.empty()) {
-                    op1 = que.top();
-                    que.pop();
-                    if (que.empty()) {
-                        res.swap(*op1);
-                        delete op1;
-                        break;
-                    }
-
-                    op2 = que.top();
-                    que.pop();
-                    tmp = (*op1) | (*op2);
-                    delete op1;
-                    delete op2;
-                    if (! que.empty()) {
-                        que.push(tmp);
-                        tmp = 0;
-                    }
-                }
-                if (tmp != 0) {
-                    res.swap(*tmp);
-                    delete tmp;
-                    tmp = 0;
-                }
-            }
-            catch (...) { // need to free the pointers
-                delete tmp;
-                while (! que.empty()) {
-                    tmp = que.top();
-                    delete tmp;
-                    que.pop();
-                }
-                throw;
+                ibis::bitvector bv(buf+offset64[i]-offset64[ib],
+                                   offset64[i+1]-offset64[i]);
+                tmp[i-ib].swap(bv);
+                ops[i-ib] = &(tmp[i-ib]);
             }
+            res.orMany(ops);
         }
         else if (sum2 <= (uncomp >> 2)) {
             // use uncompressed res
@@ -6443,8 +6230,8 @@ void ibis::index::sumBins(uint32_t ib, uint32_t ie, ibis::bitvector& res,
 /// - If there are two or less bit vectors, use |= operator directly.
 /// - Compute the total size of the bitmaps involved.
 /// - If the total size times log(number of bitvectors involved) is less
-///   than the size of an uncompressed bitvector, use a priority queue to
-///   store all input bitvectors and intermediate solutions,
+///   than the size of an uncompressed bitvector, use
+///   ibis::bitvector::orMany to combine all input bitvectors in one pass,
 /// - or else, decompress the first bitvector and use inplace bitwise OR
 ///   operator to complete the operations.
 void ibis::index::sumBins(uint32_t ib, uint32_t ie,
@@ -6460,7 +6247,6 @@ void ibis::index::sumBins(uint32_t ib, uint32_t ie,
         return;
     }
 
-    typedef std::pair<ibis::bitvector*, bool> _elem;
     bool straight = true;
     if (offset32.size() <= nobs && offset64.size() <= nobs) {
         // all bitvectors must be in memory
@@ -6673,72 +6459,15 @@ void ibis::index::sumBins(uint32_t ib, uint32_t ie,
             if (bytes*static_cast<double>(na)*na <= log(2.0)*uncomp) {
                 LOGGER(ibis::gVerbose > 5)
                     << "index::sumBins(" << ib << ", " << ie
-                    << ") performs bitwise OR with a priority queue";
-                // put all bitmaps in a priority queue
-                std::priority_queue<_elem> que;
-                _elem op1, op2, tmp;
-                tmp.first = 0;
-
-                // populate the priority queue with the original input
+                    << ") performs bitwise OR with orMany";
+                array_t<bitvector*> ops;
+                ops.reserve(na);
                 for (uint32_t i = ib; i < ie; ++i) {
                     if (bits[i]) {
-                        op1.first = bits[i];
-                        op1.second = false;
-                        que.push(op1);
+                        ops.push_back(bits[i]);
                     }
                 }
-
-                try {
-                    while (! que.empty()) {
-                        op1 = que.top();
-                        que.pop();
-                        if (que.empty()) {
-                            res.copy(*(op1.first));
-                            if (op1.second) delete op1.first;
-                            break;
-                        }
-
-                        op2 = que.top();
-                        que.pop();
-                        tmp.second = true;
-                        tmp.first = *(op1.first) | *(op2.first);
-#if DEBUG+0 > 0 || _DEBUG+0 > 0
-                        LOGGER(ibis::gVerbose >= 0)
-                            << "DEBUG -- sumBins using priority queue: "
-                            << op1.first->bytes()
-                            << (op1.second ? "(transient), " : ", ")
-                            << op2.first->bytes()
-                            << (op2.second ? "(transient) >> " : " >> ")
-                            << tmp.first->bytes();
-#endif
-                        if (op1.second) delete op1.first;
-                        if (op2.second) delete op2.first;
-                        if (! que.empty()) {
-                            que.push(tmp);
-                            tmp.first = 0;
-                        }
-                    }
-                    if (tmp.first != 0) {
-                        if (tmp.second) {
-                            res.swap(*(tmp.first));
-                            delete tmp.first;
-                            tmp.first = 0;
-                        }
-                        else {
-                            res.copy(*(tmp.first));
-                        }
-                    }
-                }
-                catch (...) { // need to free the pointers
-                    delete tmp.first;
-                    while (! que.empty()) {
-                        tmp = que.top();
-                        if (tmp.second)
-                            delete tmp.first;
-                        que.pop();
-                    }
-                    throw;
-                }
+                res.orMany(ops);
             }
             else if (sum2 <= (uncomp >> 2)) {
                 // use uncompressed res
@@ -6841,80 +6570,21 @@ void ibis::index::sumBins(uint32_t ib, uint32_t ie,
             if (bytes*static_cast<double>(na)*na <= log(2.0)*uncomp) {
                 LOGGER(ibis::gVerbose > 5)
                     << "index::sumBins(" << ib << ", " << ie
-                    << ") performs bitwise OR with a priority queue "
+                    << ") performs bitwise OR with orMany "
                     "(complement)";
-                // use priority queue for all bitmaps
-                std::priority_queue<_elem> que;
-                _elem op1, op2, tmp;
-                tmp.first = 0;
-
-                // populate the priority queue with the original input
+                array_t<bitvector*> ops;
+                ops.reserve(na);
                 for (uint32_t i = 0; i < ib; ++i) {
                     if (bits[i]) {
-                        op1.first = bits[i];
-                        op1.second = false;
-                        que.push(op1);
+                        ops.push_back(bits[i]);
                     }
                 }
                 for (uint32_t i = ie; i < nobs; ++i) {
                     if (bits[i]) {
-                        op1.first = bits[i];
-                        op1.second = false;
-                        que.push(op1);
-                    }
-                }
-
-                try {
-                    while (! que.empty()) {
-                        op1 = que.top();
-                        que.pop();
-                        if (que.empty()) {
-                            res.copy(*(op1.first));
-                            if (op1.second) delete op1.first;
-                            break;
-                        }
-
-                        op2 = que.top();
-                        que.pop();
-                        tmp.second = true;
-                        tmp.first = *(op1.first) | *(op2.first);
-#if DEBUG+0 > 0 || _DEBUG+0 > 0
-                        LOGGER(ibis::gVerbose >= 0)
-                            << "DEBUG -- sumBins using priority queue: "
-                            << op1.first->bytes()
-                            << (op1.second ? "(transient), " : ", ")
-                            << op2.first->bytes()
-                            << (op2.second ? "(transient) >> " : " >> ")
-                            << tmp.first->bytes();
-#endif
-                        if (op1.second) delete op1.first;
-                        if (op2.second) delete op2.first;
-                        if (! que.empty()) {
-                            que.push(tmp);
-                            tmp.first = 0;
-                        }
+                        ops.push_back(bits[i]);
                     }
-                    if (tmp.first != 0) {
-                        if (tmp.second) {
-                            res.swap(*(tmp.first));
-                            delete tmp.first;
-                            tmp.first = 0;
-                        }
-                        else {
-                            res.copy(*(tmp.first));
-                        }
-                    }
-                }
-                catch (...) { // need to free the pointers
-                    delete tmp.first;
-                    while (! que.empty()) {
-                        tmp = que.top();
-                        if (tmp.second)
-                            delete tmp.first;
-                        que.pop();
-                    }
-                    throw;
                 }
+                res.orMany(ops);
             }
             else if (sum2 <= (uncomp >> 2)){
                 LOGGER(ibis::gVerbose > 5)
@@ -7239,78 +6909,19 @@ void ibis::index::addBits(const array_t<bitvector*>& pile,
         res.compress();
     }
     else if (ie > ib + 2) { // use compressed res
-        typedef std::pair<ibis::bitvector*, bool> _elem;
-        std::priority_queue<_elem> que;
-        _elem op1, op2, tmp;
-        tmp.first = 0;
         if (ibis::gVerbose > 5) 
             ibis::util::logMessage("index", "addBits(%lu, %lu) using "
-                                   "compressed bitvector (with a priority "
-                                   "queue)", static_cast<long unsigned>(ib),
+                                   "compressed bitvector (with orMany)",
+                                   static_cast<long unsigned>(ib),
                                    static_cast<long unsigned>(ie));
-
-        // populate the priority queue with the original input
+        array_t<bitvector*> ops;
+        ops.reserve(ie - ib + 1);
+        ops.push_back(&res);
         for (uint32_t i = ib; i < ie; ++i) {
-            if (pile[i]) {
-                op1.first = pile[i];
-                op1.second = false;
-                que.push(op1);
-            }
-        }
-
-        try {
-            while (! que.empty()) {
-                op1 = que.top();
-                que.pop();
-                if (que.empty()) {
-                    res.copy(*(op1.first));
-                    if (op1.second) delete op1.first;
-                    break;
-                }
-
-                op2 = que.top();
-                que.pop();
-                tmp.second = true;
-                tmp.first = *(op1.first) | *(op2.first);
-#if DEBUG+0 > 0 || _DEBUG+0 > 0
-                LOGGER(ibis::gVerbose >= 0)
-                    << "DEBUG -- addBits-using priority queue: "
-                    << op1.first->bytes()
-                    << (op1.second ? "(transient), " : ", ")
-                    << op2.first->bytes()
-                    << (op2.second ? "(transient) >> " : " >> ")
-                    << tmp.first->bytes();
-#endif
-                if (op1.second)
-                    delete op1.first;
-                if (op2.second)
-                    delete op2.first;
-                if (! que.empty()) {
-                    que.push(tmp);
-                    tmp.first = 0;
-                }
-            }
-            if (tmp.first != 0) {
-                if (tmp.second) {
-                    res |= *(tmp.first);
-                    delete tmp.first;
-                    tmp.first = 0;
-                }
-                else {
-                    res |= *(tmp.first);
-                }
-            }
-        }
-        catch (...) { // need to free the pointers
-            delete tmp.first;
-            while (! que.empty()) {
-                tmp = que.top();
-                if (tmp.second)
-                    delete tmp.first;
-                que.pop();
-            }
-            throw;
+            if (pile[i])
+                ops.push_back(pile[i]);
         }
+        res.orMany(ops);
     }
     else if (ie > ib + 1) {
         if (pile[ib])
@@ -7352,7 +6963,6 @@ void ibis::index::sumBits(const array_t<bitvector*>& pile,
         << "index::sumBits(" << pile.size()
         << "-bitvector set, " << ib << ", " << ie << ", res("
         << res.cnt() << ", " << res.size() << ")) ...";
-    typedef std::pair<ibis::bitvector*, bool> _elem;
     const uint32_t nobs = pile.size();
     if (ie > nobs) ie = nobs;
     const bool straight = (2*(ie-ib) <= nobs);
@@ -7446,6 +7056,7 @@ void ibis::index::sumBits(const array_t<bitvector*>& pile,
     uint32_t bytes = 0;
 
 #if defined(TEST_SUMBINS_OPTIONS)
+    typedef std::pair<ibis::bitvector*, bool> _elem;
     if (ibis::gVerbose > 4 || ibis::_sumBits_option != 0) {
         ibis::util::logMessage("index", "sumBits(%lu, %lu) will operate on "
                                "%lu out of %lu bitmaps using option %d",
@@ -8255,72 +7866,14 @@ void ibis::index::sumBits(const array_t<bitvector*>& pile,
                         bytes += pile[i]->bytes();
             }
             if (bytes*static_cast<double>(na)*na <= log(2.0)*uncomp) {
-                // put all bitmaps in a priority queue
-                std::priority_queue<_elem> que;
-                _elem op1, op2, tmp;
-                tmp.first = 0;
-
-                // populate the priority queue with the original input
+                array_t<bitvector*> ops;
+                ops.reserve(na);
                 for (uint32_t i = ib; i < ie; ++i) {
                     if (pile[i]) {
-                        op1.first = pile[i];
-                        op1.second = false;
-                        que.push(op1);
-                    }
-                }
-
-                try {
-                    while (! que.empty()) {
-                        op1 = que.top();
-                        que.pop();
-                        if (que.empty()) {
-                            res.copy(*(op1.first));
-                            if (op1.second) delete op1.first;
-                            break;
-                        }
-
-                        op2 = que.top();
-                        que.pop();
-                        tmp.second = true;
-                        tmp.first = *(op1.first) | *(op2.first);
-#if DEBUG+0 > 0 || _DEBUG+0 > 0
-                        LOGGER(ibis::gVerbose >= 0)
-                            << "DEBUG -- sumBits-using priority queue: "
-                            << op1.first->bytes()
-                            << (op1.second ? "(transient), " : ", ")
-                            << op2.first->bytes()
-                            << (op2.second ? "(transient) >> " : " >> ")
-                            << tmp.first->bytes() << std::endl;
-#endif
-                        if (op1.second)
-                            delete op1.first;
-                        if (op2.second)
-                            delete op2.first;
-                        if (! que.empty()) {
-                            que.push(tmp);
-                            tmp.first = 0;
-                        }
-                    }
-                    if (tmp.first != 0) {
-                        if (tmp.second) {
-                            res.swap(*(tmp.first));
-                            delete tmp.first;
-                        }
-                        else {
-                            res.copy(*(tmp.first));
-                        }
+                        ops.push_back(pile[i]);
                     }
                 }
-                catch (...) { // need to free the pointers
-                    delete tmp.first;
-                    while (! que.empty()) {
-                        tmp = que.top();
-                        if (tmp.second)
-                            delete tmp.first;
-                        que.pop();
-                    }
-                    throw;
-                }
+                res.orMany(ops);
             }
             else {
                 uint32_t i;
@@ -8382,79 +7935,19 @@ void ibis::index::sumBits(const array_t<bitvector*>& pile,
                         bytes += pile[i]->bytes();
             }
             if (bytes*static_cast<double>(na)*na <= log(2.0)*uncomp) {
-                // use priority queue for all bitmaps
-                std::priority_queue<_elem> que;
-                _elem op1, op2, tmp;
-                tmp.first = 0;
-
-                // populate the priority queue with the original input
+                array_t<bitvector*> ops;
+                ops.reserve(na);
                 for (uint32_t i = 0; i < ib; ++i) {
                     if (pile[i]) {
-                        op1.first = pile[i];
-                        op1.second = false;
-                        que.push(op1);
+                        ops.push_back(pile[i]);
                     }
                 }
                 for (uint32_t i = ie; i < nobs; ++i) {
                     if (pile[i]) {
-                        op1.first = pile[i];
-                        op1.second = false;
-                        que.push(op1);
+                        ops.push_back(pile[i]);
                     }
                 }
-
-                try {
-                    while (! que.empty()) {
-                        op1 = que.top();
-                        que.pop();
-                        if (que.empty()) {
-                            res.copy(*(op1.first));
-                            if (op1.second) delete op1.first;
-                            break;
-                        }
-
-                        op2 = que.top();
-                        que.pop();
-                        tmp.second = true;
-                        tmp.first = *(op1.first) | *(op2.first);
-#if DEBUG+0 > 0 || _DEBUG+0 > 0
-                        LOGGER(ibis::gVerbose >= 0)
-                            << "DEBUG -- sumBits-using priority queue: "
-                            << op1.first->bytes()
-                            << (op1.second ? "(transient), " : ", ")
-                            << op2.first->bytes()
-                            << (op2.second ? "(transient) >> " : " >> ")
-                            << tmp.first->bytes();
-#endif
-                        if (op1.second)
-                            delete op1.first;
-                        if (op2.second)
-                            delete op2.first;
-                        if (! que.empty()) {
-                            que.push(tmp);
-                            tmp.first = 0;
-                        }
-                    }
-                    if (tmp.first != 0) {
-                        if (tmp.second) {
-                            res.swap(*(tmp.first));
-                            delete tmp.first;
-                        }
-                        else {
-                            res.copy(*(tmp.first));
-                        }
-                    }
-                }
-                catch (...) { // need to free the pointers
-                    delete tmp.first;
-                    while (! que.empty()) {
-                        tmp = que.top();
-                        if (tmp.second)
-                            delete tmp.first;
-                        que.pop();
-                    }
-                    throw;
-                }
+                res.orMany(ops);
             }
             else if (sum2 <= (uncomp >> 2)){
                 // uncompress the first bitmap generated
@@ -8726,6 +8219,67 @@ void ibis::index::setBases(array_t<uint32_t>& bases, uint32_t card,
     }
 } // ibis::index::setBases
 
+/// Decide the form of the bitmaps in the index file.  The choice is made
+/// with "<compressing wah64/>" or "<compressing hybrid/>" in the index
+/// specification, or by setting the parameter
+/// <partition>.<column>.useWAH64 or <partition>.<column>.useHybridBitmaps
+/// to true.  All forms are converted back to the 32-bit WAH words when
+/// read, see ibis::bitvector::writeWAH64 and ibis::bitvector::writeHybrid.
+ibis::index::BITMAP_FORMAT ibis::index::bitmapFormat() const {
+    if (col == 0) {
+        if (ibis::gParameters().isTrue("useWAH64"))
+            return BITMAP_WAH64;
+        else if (ibis::gParameters().isTrue("useHybridBitmaps"))
+            return BITMAP_HYBRID;
+        else
+            return BITMAP_WAH32;
+    }
+
+    const char *spec = col->indexSpec();
+    const char *ptr = (spec != 0 ? strstr(spec, "<compressing ") : 0);
+    if (ptr != 0) {
+        ptr += 13;
+        while (isspace(*ptr))
+            ++ ptr;
+        if (strnicmp(ptr, "wah64", 5) == 0)
+            return BITMAP_WAH64;
+        else if (strnicmp(ptr, "hybrid", 6) == 0)
+            return BITMAP_HYBRID;
+    }
+
+    std::string key;
+    if (col->partition() != 0) {
+        key = col->partition()->name();
+        key += '.';
+    }
+    key += col->name();
+    const size_t len = key.size();
+    key += ".useWAH64";
+    if (ibis::gParameters().isTrue(key.c_str()))
+        return BITMAP_WAH64;
+    key.erase(len);
+    key += ".useHybridBitmaps";
+    if (ibis::gParameters().isTrue(key.c_str()))
+        return BITMAP_HYBRID;
+    return BITMAP_WAH32;
+} // ibis::index::bitmapFormat
+
+/// Write a bitmap to an open file in the form chosen by bitmapFormat.
+void ibis::index::writeBitmap(int fdes, const ibis::bitvector& bv,
+                              BITMAP_FORMAT fmt) {
+    switch (fmt) {
+    case BITMAP_WAH64:
+        bv.writeWAH64(fdes);
+        break;
+    case BITMAP_HYBRID:
+        bv.writeHybrid(fdes);
+        break;
+    default:
+        bv.write(fdes);
+        break;
+    }
+} // ibis::index::writeBitmap
+
 /// Decide whether to uncompress the bitmaps.
 void ibis::index::optionalUnpack(array_t<bitvector*>& pile,
                                  const char *opt) {
@@ -465,6 +465,15 @@ protected:
     void initBitmaps(ibis::fileManager::storage *st);
     void initBitmaps(uint32_t *st);
     void initBitmaps(void *ctx, FastBitReadBitmaps rd);
+    /// The forms used to write the bitmaps to the index files.
+    enum BITMAP_FORMAT {
+        BITMAP_WAH32=0, ///< The WAH words of ibis::bitvector.
+        BITMAP_WAH64,   ///< The 64-bit WAH words of ibis::bitvector64.
+        BITMAP_HYBRID   ///< The smallest of WAH, positions and runs.
+    };
+    BITMAP_FORMAT bitmapFormat() const;
+    static void writeBitmap(int fdes, const ibis::bitvector& bv,
+                            BITMAP_FORMAT fmt);
 
 private:
 
@@ -519,9 +519,10 @@ int ibis::relic::write32(int fdes) const {
         (void) UnixSeek(fdes, start, SEEK_SET);
         return -9;
     }
+    const BITMAP_FORMAT fmt = bitmapFormat();
     for (uint32_t i = 0; i < nobs; ++i) {
         if (bits[i]) {
-            bits[i]->write(fdes);
+            writeBitmap(fdes, *bits[i], fmt);
         }
         offset32[i+1] = UnixSeek(fdes, 0, SEEK_CUR);
     }
@@ -612,9 +613,10 @@ int ibis::relic::write64(int fdes) const {
         (void) UnixSeek(fdes, start, SEEK_SET);
         return -9;
     }
+    const BITMAP_FORMAT fmt = bitmapFormat();
     for (uint32_t i = 0; i < nobs; ++i) {
         if (bits[i]) {
-            bits[i]->write(fdes);
+            writeBitmap(fdes, *bits[i], fmt);
         }
         offset64[i+1] = UnixSeek(fdes, 0, SEEK_CUR);
     }
@@ -4768,15 +4768,15 @@ int64_t ibis::table::computeHits(const ibis::constPartList& pts,
          it != pts.end(); ++ it) {
         ierr = qq.setPartition(*it);
         if (ierr < 0) continue;
-        ierr = qq.evaluate();
-        if (ierr == 0) {
-            nhits += qq.getNumHits();
+        const long nh = qq.countHits();
+        if (nh >= 0) {
+            nhits += nh;
         }
         else if (ibis::gVerbose > 1) {
             ibis::util::logger lg;
             lg() << "Warning -- table::computeHits failed to evaluate \""
                  << cond << "\" on data partition " << (*it)->name()
-                 << ", query::evaluate returned " << ierr;
+                 << ", countQuery::countHits returned " << nh;
         }
     }
     return nhits;
@@ -4802,15 +4802,15 @@ int64_t ibis::table::computeHits(const ibis::constPartList& pts,
          it != pts.end(); ++ it) {
         ierr = qq.setPartition(*it);
         if (ierr < 0) continue;
-        ierr = qq.evaluate();
-        if (ierr == 0) {
-            nhits += qq.getNumHits();
+        const long nh = qq.countHits();
+        if (nh >= 0) {
+            nhits += nh;
         }
         else if (ibis::gVerbose > 1) {
             ibis::util::logger lg;
             lg() << "Warning -- table::computeHits failed to evaluate \""
                  << *cond << "\" on data partition " << (*it)->name()
-                 << ", query::evaluate returned " << ierr;
+                 << ", countQuery::countHits returned " << nh;
         }
     }
     return nhits;
@@ -44,6 +44,14 @@
 #define pclose _pclose
 #endif
 
+// The scan kernels below pack the results of comparing a block of values
+// into a literal word with SSE2 on x86_64.  Define FASTBIT_NO_SIMD to use
+// only the portable version.
+#if !defined(FASTBIT_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64))
+#  include <emmintrin.h>        // SSE2
+#  define FASTBIT_PART_SSE2 1
+#endif
+
 // A higher quality random number generator within the file scope.  Use a
 // function to (possibly) delay the invocation of the constructor.
 static ibis::MersenneTwister& _ibis_part_urand() {
@@ -2738,6 +2746,311 @@ ibis::part::accessHint(const ibis::bitvector &mask, unsigned elem) const {
     return hint;
 } // ibis::part::accessHint
 
+/// Tell the operating system which pages of a memory mapped data file are
+/// about to be read.  The storage object @c st is expected to hold the
+/// values of a column with @c elem bytes each, and the positions marked 1
+/// in @c mask are to be read.  If more than 1/8th of the rows are selected
+/// or half of the pages are touched, the whole file is to be read
+/// sequentially.  Otherwise the file is marked for random access, so that
+/// the OS does not read ahead, and the page runs covering the selected
+/// positions are requested with WILLNEED so that they are read in
+/// parallel before the caller touches them one at a time.  Nothing is done
+/// if the storage is not a file map.
+void ibis::part::adviseAccess(const ibis::fileManager::storage &st,
+                              const ibis::bitvector &mask, unsigned elem) {
+    if (! st.isFileMap() || elem == 0 || mask.cnt() == 0) return;
+
+    const size_t psize = ibis::fileManager::pageSize();
+    const size_t nbytes = st.size();
+    const size_t npages = (nbytes + psize - 1) / psize;
+    const uint32_t cnt = mask.cnt();
+    if (cnt >= (mask.size() >> 3) ||
+        countPages(mask, elem) * 2 >= npages) {
+        st.advise(ibis::fileManager::ACCESS_SEQUENTIAL, 0, nbytes);
+        LOGGER(ibis::gVerbose > 6)
+            << "part::adviseAccess -- " << cnt << " out of " << mask.size()
+            << " rows, advise sequential access to " << nbytes << " bytes";
+        return;
+    }
+
+    st.advise(ibis::fileManager::ACCESS_RANDOM, 0, nbytes);
+    // coalesce the selected positions into runs of pages
+    size_t runs = 0;
+    size_t b = 0, e = 0; // current run of pages in bytes
+    ibis::bitvector::word_t starts[256], ends[256];
+    ibis::bitvector::decoder dec(mask);
+    for (uint32_t nrng = dec.ranges(starts, ends, 256); nrng > 0;
+         nrng = dec.ranges(starts, ends, 256)) {
+        for (uint32_t j = 0; j < nrng; ++ j) {
+            const size_t pb = (elem * static_cast<size_t>(starts[j]))
+                / psize * psize;
+            const size_t pe = elem * static_cast<size_t>(ends[j]);
+            if (e > 0 && pb <= e) {
+                if (pe > e)
+                    e = pe;
+            }
+            else {
+                if (e > b) {
+                    st.advise(ibis::fileManager::ACCESS_WILLNEED, b, e);
+                    ++ runs;
+                }
+                b = pb;
+                e = pe;
+            }
+        }
+    }
+    if (e > b) {
+        st.advise(ibis::fileManager::ACCESS_WILLNEED, b, e);
+        ++ runs;
+    }
+    LOGGER(ibis::gVerbose > 6)
+        << "part::adviseAccess -- " << cnt << " out of " << mask.size()
+        << " rows, advise random access with " << runs
+        << " run" << (runs>1?"s":"") << " of pages to be read soon";
+} // ibis::part::adviseAccess
+
+/// Convert the number of bytes of bitmaps needed to answer a query with an
+/// index into the cost model unit, which is the number of bytes read
+/// sequentially in the same time.  The cost includes reading the bitmaps,
+/// one random access to locate them and the bitwise logical operations.
+/// Without the constants measured by calibrateCosts, the number of bytes
+/// is returned unchanged.
+double ibis::part::indexCost(double bytes) {
+    const double seq =
+        ibis::gParameters().getNumber("cost.sequentialBytesPerSecond");
+    const double rnd =
+        ibis::gParameters().getNumber("cost.randomBytesPerSecond");
+    const double bop =
+        ibis::gParameters().getNumber("cost.bitmapBytesPerSecond");
+    if (seq > 0.0 && rnd > 0.0 && bop > 0.0)
+        return bytes + bytes * seq / bop +
+            ibis::fileManager::pageSize() * seq / rnd;
+    else
+        return bytes;
+} // ibis::part::indexCost
+
+/// Convert the cost of scanning @c rows rows stored in @c bytes bytes into
+/// the cost model unit, see indexCost.  Without the constants measured by
+/// calibrateCosts, the number of bytes is returned unchanged.
+double ibis::part::scanCost(double bytes, double rows) {
+    const double seq =
+        ibis::gParameters().getNumber("cost.sequentialBytesPerSecond");
+    const double scn =
+        ibis::gParameters().getNumber("cost.scanRowsPerSecond");
+    if (seq > 0.0 && scn > 0.0)
+        return bytes + rows * seq / scn;
+    else
+        return bytes;
+} // ibis::part::scanCost
+
+/// Measure the speed of the basic operations of the cost model on this
+/// machine.  The following parameters are set in ibis::gParameters():
+///
+/// \arg cost.bitmapBytesPerSecond The number of bytes of compressed
+/// bitmaps processed per second by the bitwise OR operation.
+///
+/// \arg cost.scanRowsPerSecond The number of rows per second examined by
+/// a sequential scan of values already in memory.
+///
+/// \arg cost.sequentialBytesPerSecond The bandwidth of reading a file
+/// sequentially.
+///
+/// \arg cost.randomBytesPerSecond The bandwidth of reading one page at a
+/// time from random locations of a file.
+///
+/// The read speeds are measured on a temporary file of 64 MB created in
+/// the directory @c dir, which should be on the same device as the data.
+/// Where supported, the file is evicted from the page cache before each
+/// read test.  If @c rcfile is not nil, the values are appended to the
+/// named configuration file, so that they can be read with
+/// ibis::init(rcfile) later.  With these parameters, the estimated costs
+/// of the indexes and the sequential scans are converted into comparable
+/// units, see indexCost and scanCost.
+///
+/// Returns 0 on success and a negative number to indicate error.
+int ibis::part::calibrateCosts(const char *dir, const char *rcfile) {
+    if (dir == 0 || *dir == 0)
+        return -1;
+
+    ibis::MersenneTwister mt(1);
+    ibis::horometer timer;
+    double bitmapRate, scanRate, seqRate, rndRate;
+
+    { // bitwise logical operations on bitmaps of moderate densities
+        const ibis::bitvector::word_t nbits = 4194304;
+        ibis::bitvector b1, b2;
+        for (ibis::bitvector::word_t i = mt.next(16); i < nbits;
+             i += 1 + mt.next(16))
+            b1.setBit(i, 1);
+        for (ibis::bitvector::word_t i = mt.next(64); i < nbits;
+             i += 1 + mt.next(64))
+            b2.setBit(i, 1);
+        b1.adjustSize(0, nbits);
+        b2.adjustSize(0, nbits);
+
+        double bytes = 0.0;
+        timer.start();
+        for (unsigned i = 0; i < 4 || (i < 1000 && timer.realTime() < 0.2);
+             ++ i) {
+            timer.resume();
+            ibis::bitvector res(b1);
+            res |= b2;
+            bytes += b1.bytes() + b2.bytes();
+            timer.stop();
+        }
+        bitmapRate = bytes / timer.realTime();
+    }
+
+    { // sequential scan of values in memory
+        const uint32_t nrows = 4194304;
+        ibis::array_t<double> vals(nrows);
+        for (uint32_t i = 0; i < nrows; ++ i)
+            vals[i] = mt.nextDouble();
+        ibis::bitvector mask, hits;
+        mask.set(1, nrows);
+        const ibis::qContinuousRange rng(0.25, ibis::qExpr::OP_LE, "x",
+                                         ibis::qExpr::OP_LT, 0.75);
+
+        double rows = 0.0;
+        timer.start();
+        for (unsigned i = 0; i < 4 || (i < 1000 && timer.realTime() < 0.2);
+             ++ i) {
+            timer.resume();
+            (void) doScan(vals, rng, mask, hits);
+            rows += nrows;
+            timer.stop();
+        }
+        scanRate = rows / timer.realTime();
+    }
+
+    { // sequential and random reads from a file
+        std::string fname = dir;
+        fname += FASTBIT_DIRSEP;
+        fname += "-calibrate";
+        const size_t chunk = 1048576;
+        const size_t nchunks = 64;
+        const size_t psize = ibis::fileManager::pageSize();
+        ibis::array_t<char> buf(chunk);
+        for (size_t i = 0; i < chunk; ++ i)
+            buf[i] = static_cast<char>(mt.next());
+
+        IBIS_BLOCK_GUARD(remove, fname.c_str());
+        {
+            int fdes = UnixOpen(fname.c_str(), OPEN_WRITENEW, OPEN_FILEMODE);
+            if (fdes < 0) {
+                LOGGER(ibis::gVerbose >= 0)
+                    << "Warning -- part::calibrateCosts failed to open \""
+                    << fname << "\" for writing";
+                return -2;
+            }
+            IBIS_BLOCK_GUARD(UnixClose, fdes);
+#if defined(_WIN32) && defined(_MSC_VER)
+            (void)_setmode(fdes, _O_BINARY);
+#endif
+            for (size_t i = 0; i < nchunks; ++ i) {
+                if (UnixWrite(fdes, buf.begin(), chunk) != (off_t)chunk) {
+                    LOGGER(ibis::gVerbose >= 0)
+                        << "Warning -- part::calibrateCosts failed to write "
+                        << nchunks << " MB to \"" << fname << "\"";
+                    return -3;
+                }
+            }
+#if _POSIX_FSYNC+0 > 0
+            (void) UnixFlush(fdes); // write to disk
+#elif defined(_WIN32) && defined(_MSC_VER)
+            (void) _commit(fdes);
+#endif
+        }
+
+        int fdes = UnixOpen(fname.c_str(), OPEN_READONLY);
+        if (fdes < 0) {
+            LOGGER(ibis::gVerbose >= 0)
+                << "Warning -- part::calibrateCosts failed to open \""
+                << fname << "\" for reading";
+            return -2;
+        }
+        IBIS_BLOCK_GUARD(UnixClose, fdes);
+#if defined(_WIN32) && defined(_MSC_VER)
+        (void)_setmode(fdes, _O_BINARY);
+#endif
+        const off_t fsize = static_cast<off_t>(chunk) * nchunks;
+
+#if defined(POSIX_FADV_DONTNEED)
+        (void) posix_fadvise(fdes, 0, fsize, POSIX_FADV_DONTNEED);
+#endif
+        double bytes = 0.0;
+        timer.start();
+        for (size_t i = 0; i < nchunks; ++ i) {
+            const off_t nr = UnixRead(fdes, buf.begin(), chunk);
+            if (nr <= 0) break;
+            bytes += nr;
+        }
+        timer.stop();
+        seqRate = bytes / timer.realTime();
+
+#if defined(POSIX_FADV_DONTNEED)
+        (void) posix_fadvise(fdes, 0, fsize, POSIX_FADV_DONTNEED);
+#endif
+        bytes = 0.0;
+        timer.start();
+        for (unsigned i = 0; i < 16 || (i < 4096 && timer.realTime() < 0.5);
+             ++ i) {
+            timer.resume();
+            const off_t pos = static_cast<off_t>(mt.next(fsize / psize)) *
+                psize;
+            if (UnixSeek(fdes, pos, SEEK_SET) == pos) {
+                const off_t nr = UnixRead(fdes, buf.begin(), psize);
+                if (nr > 0)
+                    bytes += nr;
+            }
+            timer.stop();
+        }
+        rndRate = bytes / timer.realTime();
+    }
+
+    if (! (bitmapRate > 0.0 && scanRate > 0.0 && seqRate > 0.0 &&
+           rndRate > 0.0)) {
+        LOGGER(ibis::gVerbose >= 0)
+            << "Warning -- part::calibrateCosts failed to measure the "
+            "costs, bitmap operations " << bitmapRate << " B/s, scan "
+            << scanRate << " rows/s, sequential read " << seqRate
+            << " B/s, random read " << rndRate << " B/s";
+        return -4;
+    }
+
+    std::ostringstream oss;
+    oss << "cost.bitmapBytesPerSecond = " << bitmapRate
+        << "\ncost.scanRowsPerSecond = " << scanRate
+        << "\ncost.sequentialBytesPerSecond = " << seqRate
+        << "\ncost.randomBytesPerSecond = " << rndRate << "\n";
+    {
+        char tmp[32];
+        sprintf(tmp, "%g", bitmapRate);
+        ibis::gParameters().add("cost.bitmapBytesPerSecond", tmp);
+        sprintf(tmp, "%g", scanRate);
+        ibis::gParameters().add("cost.scanRowsPerSecond", tmp);
+        sprintf(tmp, "%g", seqRate);
+        ibis::gParameters().add("cost.sequentialBytesPerSecond", tmp);
+        sprintf(tmp, "%g", rndRate);
+        ibis::gParameters().add("cost.randomBytesPerSecond", tmp);
+    }
+    if (rcfile != 0 && *rcfile != 0) {
+        std::ofstream rc(rcfile, std::ios::out | std::ios::app);
+        if (rc) {
+            rc << "\n# measured by ibis::part::calibrateCosts(" << dir
+               << ")\n" << oss.str();
+        }
+        else {
+            LOGGER(ibis::gVerbose >= 0)
+                << "Warning -- part::calibrateCosts failed to open \""
+                << rcfile << "\" to write the constants";
+        }
+    }
+    LOGGER(ibis::gVerbose > 1)
+        << "part::calibrateCosts(" << dir << ") measured\n" << oss.str();
+    return 0;
+} // ibis::part::calibrateCosts
+
 /// The selected values are packed into the resulting array.  Only those
 /// rows marked 1 are retrieved.  The caller is responsible for deleting
 /// the returned value.
@@ -3690,6 +4003,50 @@ long ibis::part::estimateRange(const ibis::qContinuousRange &cmp) const {
     return ret;
 } // ibis::part::estimateRange
 
+/// Ask the file manager to start reading the files needed to evaluate the
+/// conditions in the query expression.  For each column named in the
+/// expression, it prefetches the index file if the column has an index,
+/// otherwise the data file.  The files are read by the prefetch threads
+/// of ibis::fileManager while the caller goes on evaluating the earlier
+/// terms of the expression, so that the reading of the files of different
+/// columns overlaps with each other and with the computation.
+void ibis::part::prefetch(const ibis::qExpr *cond) const {
+    if (cond == 0 || columns.empty() || nEvents == 0) return;
+
+    const char *cname = 0;
+    switch (cond->getType()) {
+    case ibis::qExpr::RANGE:
+    case ibis::qExpr::DRANGE:
+    case ibis::qExpr::INTHOD:
+    case ibis::qExpr::UINTHOD:
+        cname = static_cast<const ibis::qRange*>(cond)->colName();
+        break;
+    case ibis::qExpr::ANYSTRING:
+        cname = static_cast<const ibis::qAnyString*>(cond)->colName();
+        break;
+    case ibis::qExpr::LIKE:
+        cname = static_cast<const ibis::qLike*>(cond)->colName();
+        break;
+    case ibis::qExpr::KEYWORD:
+        cname = static_cast<const ibis::qKeyword*>(cond)->colName();
+        break;
+    case ibis::qExpr::ALLWORDS:
+        cname = static_cast<const ibis::qAllWords*>(cond)->colName();
+        break;
+    default:
+        prefetch(cond->getLeft());
+        prefetch(cond->getRight());
+        return;
+    }
+
+    const ibis::column *col = getColumn(cname);
+    std::string fname;
+    if (col == 0 || col->dataFileName(fname) == 0) return;
+    if (col->hasIndex())
+        fname += ".idx";
+    ibis::fileManager::instance().prefetch(fname.c_str());
+} // ibis::part::prefetch
+
 /// Estimate the cost of evaluate the query expression.
 double ibis::part::estimateCost(const ibis::qContinuousRange &cmp) const {
     if (columns.empty() || nEvents == 0)
@@ -4294,14 +4651,220 @@ long ibis::part::doScan(const ibis::qRange &cmp,
     return doScan(cmp, mask, hits);
 } // ibis::part::doScan
 
+/// One range condition attached to a shared scan, see
+/// ibis::part::shareScan.
+struct _ibis_part_ticket {
+    const ibis::qContinuousRange &cmp; ///!< The condition.
+    const ibis::bitvector &mask;       ///!< The rows to examine.
+    ibis::bitvector &hits;             ///!< The rows satisfying cmp.
+    long ierr;                         ///!< The number of hits or error.
+
+    _ibis_part_ticket(const ibis::qContinuousRange &c,
+                      const ibis::bitvector &m, ibis::bitvector &h)
+        : cmp(c), mask(m), hits(h), ierr(-1) {}
+}; // _ibis_part_ticket
+
+/// Evaluate all conditions of a shared scan in one pass over @c vals.
+/// The rows are processed in segments of whole literal words that are
+/// small enough to stay in cache, and every condition is evaluated on a
+/// segment before moving on to the next one.  On return, the member ierr
+/// of each ticket is the number of hits or a negative number to indicate
+/// error.
+template <typename T>
+static void _ibis_part_sharePass(const ibis::array_t<T> &vals,
+                                 std::vector<_ibis_part_ticket*> &tks) {
+    if (tks.size() == 1) {
+        tks[0]->ierr = ibis::part::doScan
+            (vals, tks[0]->cmp, tks[0]->mask, tks[0]->hits);
+        return;
+    }
+
+    const ibis::bitvector::word_t seglen =
+        ibis::bitvector::bitsPerLiteral() * 2048;
+    std::vector<ibis::bitvector::skipIndex*> sks(tks.size(), 0);
+    try {
+        for (size_t i = 0; i < tks.size(); ++ i) {
+            if (tks[i]->mask.size() == vals.size()) {
+                sks[i] = new ibis::bitvector::skipIndex(tks[i]->mask);
+                tks[i]->hits.clear();
+                tks[i]->ierr = 0;
+            }
+            else { // can not be sliced along with the values
+                tks[i]->ierr = ibis::part::doScan
+                    (vals, tks[i]->cmp, tks[i]->mask, tks[i]->hits);
+            }
+        }
+
+        for (ibis::bitvector::word_t begin = 0; begin < vals.size();
+             begin += seglen) {
+            const ibis::bitvector::word_t end =
+                (begin + seglen < vals.size() ? begin + seglen : vals.size());
+            const ibis::array_t<T> seg(vals, begin, end);
+            for (size_t i = 0; i < tks.size(); ++ i) {
+                if (sks[i] == 0 || tks[i]->ierr < 0) continue;
+
+                ibis::bitvector sm, sh;
+                sks[i]->slice(begin, end, sm);
+                if (sm.cnt() > 0) {
+                    long ierr = ibis::part::doScan(seg, tks[i]->cmp, sm, sh);
+                    if (ierr < 0) {
+                        tks[i]->ierr = ierr;
+                        continue;
+                    }
+                    sh.adjustSize(0, end - begin);
+                }
+                else {
+                    sh.set(0, end - begin);
+                }
+                tks[i]->hits += sh;
+            }
+        }
+    }
+    catch (...) {
+        for (size_t i = 0; i < sks.size(); ++ i)
+            delete sks[i];
+        throw;
+    }
+
+    for (size_t i = 0; i < tks.size(); ++ i) {
+        if (sks[i] != 0) {
+            delete sks[i];
+            if (tks[i]->ierr >= 0)
+                tks[i]->ierr = tks[i]->hits.cnt();
+        }
+    }
+} // _ibis_part_sharePass
+
+/// A group of range conditions on the same column that are evaluated in
+/// one pass over the values of the column.
+struct ibis::part::scanBatch {
+    const ibis::column *col; ///!< The column to be scanned.
+    std::vector<_ibis_part_ticket*> tickets; ///!< The conditions.
+    bool running;  ///!< Whether the scan has started.
+    bool done;     ///!< Whether the scan has completed.
+    unsigned nref; ///!< Number of threads still using this object.
+    pthread_cond_t cond; ///!< Signaled when the scan is done.
+
+    explicit scanBatch(const ibis::column *c)
+        : col(c), running(false), done(false), nref(0) {
+        if (pthread_cond_init(&cond, 0) != 0)
+            throw "part::scanBatch failed to initialize the condition "
+                "variable" IBIS_FILE_LINE;
+    }
+    ~scanBatch() {(void) pthread_cond_destroy(&cond);}
+}; // ibis::part::scanBatch
+
+/// Evaluate the range condition on the values of column @c col, possibly
+/// sharing one pass over the values with other threads.  When the
+/// parameter scan.share is true, the range conditions on the same column
+/// from concurrent queries are gathered into batches.  Only one batch per
+/// column is scanned at any time.  The conditions arriving while a scan is
+/// in progress join the next batch, which is scanned by the thread that
+/// started it as soon as the current scan is done.  The other threads of
+/// a batch wait for its scan to complete.  When scan.share is not set,
+/// this function simply calls doScan.
+///
+/// The arguments and the return value are the same as those of doScan.
+template <typename T>
+long ibis::part::shareScan(const ibis::column &col, const array_t<T> &vals,
+                           const ibis::qContinuousRange &cmp,
+                           const ibis::bitvector &mask,
+                           ibis::bitvector &hits) const {
+    if (! ibis::gParameters().isTrue("scan.share"))
+        return doScan(vals, cmp, mask, hits);
+
+    _ibis_part_ticket me(cmp, mask, hits);
+    scanBatch *mine = 0;
+    bool owner = false;
+    {
+        mutexLock lock(this, "shareScan");
+        for (size_t i = 0; i < scanBatches.size() && mine == 0; ++ i) {
+            if (scanBatches[i]->col == &col && ! scanBatches[i]->running)
+                mine = scanBatches[i];
+        }
+        if (mine != 0) { // join the batch and let its owner do the scan
+            mine->tickets.push_back(&me);
+            ++ mine->nref;
+            while (! mine->done)
+                (void) pthread_cond_wait(&(mine->cond), &mutex);
+            -- mine->nref;
+            if (mine->nref == 0)
+                delete mine;
+        }
+        else { // start a new batch
+            owner = true;
+            mine = new scanBatch(&col);
+            mine->tickets.push_back(&me);
+            mine->nref = 1;
+            scanBatches.push_back(mine);
+
+            // wait for the scan in progress on the same column
+            for (scanBatch *run = 0; ; run = 0) {
+                for (size_t i = 0; i < scanBatches.size() && run == 0; ++ i) {
+                    if (scanBatches[i]->col == &col &&
+                        scanBatches[i]->running)
+                        run = scanBatches[i];
+                }
+                if (run == 0) break;
+
+                ++ run->nref;
+                while (! run->done)
+                    (void) pthread_cond_wait(&(run->cond), &mutex);
+                -- run->nref;
+                if (run->nref == 0)
+                    delete run;
+            }
+            mine->running = true;
+        }
+    }
+
+    if (owner) {
+        // no more tickets can be added to a running batch
+        const size_t nt = mine->tickets.size();
+        try {
+            _ibis_part_sharePass(vals, mine->tickets);
+        }
+        catch (...) {
+            for (size_t i = 0; i < nt; ++ i)
+                mine->tickets[i]->ierr = -1;
+        }
+        LOGGER(nt > 1 && ibis::gVerbose > 3)
+            << "part[" << name() << "]::shareScan evaluated " << nt
+            << " range conditions on column " << col.name()
+            << " in one pass";
+
+        mutexLock lock(this, "shareScan");
+        mine->done = true;
+        for (size_t i = 0; i < scanBatches.size(); ++ i) {
+            if (scanBatches[i] == mine) {
+                scanBatches.erase(scanBatches.begin() + i);
+                break;
+            }
+        }
+        (void) pthread_cond_broadcast(&(mine->cond));
+        -- mine->nref;
+        if (mine->nref == 0)
+            delete mine;
+    }
+
+    if (me.ierr < 0) // the shared scan failed, try again alone
+        me.ierr = doScan(vals, cmp, mask, hits);
+    return me.ierr;
+} // ibis::part::shareScan
+
 /// Evalute the range condition on the records that are marked 1 in the
 /// mask.  The i'th element of the column is examined if mask[i] is set
-/// (mask[i] == 1).
+/// (mask[i] == 1).  If the column has a zone map, only the blocks of rows
+/// that might contain hits are examined, see ibis::column::zoneMapRange.
+/// If the integer column has an encoded copy of its data file, the range
+/// condition is evaluated on the encoded values, see
+/// ibis::column::encodedRange.  The range conditions from concurrent
+/// queries may share one pass over the values, see shareScan.
 long ibis::part::doScan(const ibis::qRange &cmp,
-                        const ibis::bitvector &mask,
+                        const ibis::bitvector &mask0,
                         ibis::bitvector &hits) const {
     if (columns.empty() || nEvents == 0 || cmp.colName() == 0 ||
-        mask.size() == 0 || mask.cnt() == 0)
+        mask0.size() == 0 || mask0.cnt() == 0)
         return 0;
 
     std::string evt = "part[";
@@ -4320,6 +4883,38 @@ long ibis::part::doScan(const ibis::qRange &cmp,
         evt += oss.str();
     }
 
+    // the zone map divides the rows into blocks without any hit, blocks
+    // of hits only and blocks to be scanned
+    ibis::bitvector sure, maybe;
+    if (mask0.size() == nEvents && col->isNumeric() &&
+        col->zoneMapRange(cmp, sure, maybe) >= 0) {
+        sure &= mask0;
+        maybe &= mask0;
+        if (maybe.cnt() == 0) {
+            LOGGER(ibis::gVerbose > 4)
+                << evt << " resolved the condition with the zone map";
+            hits.swap(sure);
+            return hits.cnt();
+        }
+    }
+    else {
+        sure.clear();
+        maybe.clear();
+    }
+    const ibis::bitvector &mask = (maybe.size() == nEvents ? maybe : mask0);
+
+    // the encoded copy of the data file takes fewer bytes to read
+    if (cmp.getType() == ibis::qExpr::RANGE && col->isInteger() &&
+        col->encodedRange(static_cast<const ibis::qContinuousRange&>(cmp),
+                          mask, hits) >= 0) {
+        if (sure.size() == nEvents && sure.cnt() > 0)
+            hits |= sure;
+        LOGGER(ibis::gVerbose > 7)
+            << evt << " examined " << mask.cnt() << " candidates in the "
+            "encoded copy and found " << hits.cnt() << " hits";
+        return hits.cnt();
+    }
+
     std::string sname;
     (void) col->dataFileName(sname);
     long ierr = 0;
@@ -4386,7 +4981,7 @@ long ibis::part::doScan(const ibis::qRange &cmp,
             case ibis::qExpr::RANGE: {
                 const ibis::qContinuousRange& rng =
                     static_cast<const ibis::qContinuousRange&>(cmp);
-                ierr = doScan(intarray, rng, mask, hits);
+                ierr = shareScan(*col, intarray, rng, mask, hits);
                 break;}
             case ibis::qExpr::INTHOD: {
                 const ibis::qIntHod& qih =
@@ -4436,7 +5031,7 @@ long ibis::part::doScan(const ibis::qRange &cmp,
             case ibis::qExpr::RANGE: {
                 const ibis::qContinuousRange& rng =
                     static_cast<const ibis::qContinuousRange&>(cmp);
-                ierr = doScan(intarray, rng, mask, hits);
+                ierr = shareScan(*col, intarray, rng, mask, hits);
                 break;}
             case ibis::qExpr::INTHOD: {
                 const ibis::qIntHod& qih =
@@ -4482,7 +5077,7 @@ long ibis::part::doScan(const ibis::qRange &cmp,
             if (cmp.getType() == ibis::qExpr::RANGE) {
                 const ibis::qContinuousRange &rng =
                     static_cast<const ibis::qContinuousRange&>(cmp);
-                ierr = doScan(intarray, rng, mask, hits);
+                ierr = shareScan(*col, intarray, rng, mask, hits);
             }
             else {
                 ierr = doCompare(intarray, cmp, mask, hits);
@@ -4506,7 +5101,7 @@ long ibis::part::doScan(const ibis::qRange &cmp,
             if (cmp.getType() == ibis::qExpr::RANGE) {
                 const ibis::qContinuousRange &rng =
                     static_cast<const ibis::qContinuousRange&>(cmp);
-                ierr = doScan(intarray, rng, mask, hits);
+                ierr = shareScan(*col, intarray, rng, mask, hits);
             }
             else {
                 ierr = doCompare(intarray, cmp, mask, hits);
@@ -4530,7 +5125,7 @@ long ibis::part::doScan(const ibis::qRange &cmp,
             if (cmp.getType() == ibis::qExpr::RANGE) {
                 const ibis::qContinuousRange &rng =
                     static_cast<const ibis::qContinuousRange&>(cmp);
-                ierr = doScan(intarray, rng, mask, hits);
+                ierr = shareScan(*col, intarray, rng, mask, hits);
             }
             else {
                 ierr = doCompare(intarray, cmp, mask, hits);
@@ -4554,7 +5149,7 @@ long ibis::part::doScan(const ibis::qRange &cmp,
             if (cmp.getType() == ibis::qExpr::RANGE) {
                 const ibis::qContinuousRange &rng =
                     static_cast<const ibis::qContinuousRange&>(cmp);
-                ierr = doScan(intarray, rng, mask, hits);
+                ierr = shareScan(*col, intarray, rng, mask, hits);
             }
             else {
                 ierr = doCompare(intarray, cmp, mask, hits);
@@ -4578,7 +5173,7 @@ long ibis::part::doScan(const ibis::qRange &cmp,
             if (cmp.getType() == ibis::qExpr::RANGE) {
                 const ibis::qContinuousRange &rng =
                     static_cast<const ibis::qContinuousRange&>(cmp);
-                ierr = doScan(intarray, rng, mask, hits);
+                ierr = shareScan(*col, intarray, rng, mask, hits);
             }
             else {
                 ierr = doCompare(intarray, cmp, mask, hits);
@@ -4602,7 +5197,7 @@ long ibis::part::doScan(const ibis::qRange &cmp,
             if (cmp.getType() == ibis::qExpr::RANGE) {
                 const ibis::qContinuousRange &rng =
                     static_cast<const ibis::qContinuousRange&>(cmp);
-                ierr = doScan(intarray, rng, mask, hits);
+                ierr = shareScan(*col, intarray, rng, mask, hits);
             }
             else {
                 ierr = doCompare(intarray, cmp, mask, hits);
@@ -4624,8 +5219,8 @@ long ibis::part::doScan(const ibis::qRange &cmp,
         ierr = col->getValuesArray(&floatarray);
         if (ierr >= 0) {
             if (cmp.getType() == ibis::qExpr::RANGE)
-                ierr = doScan
-                    (floatarray,
+                ierr = shareScan
+                    (*col, floatarray,
                      static_cast<const ibis::qContinuousRange&>(cmp),
                      mask, hits);
             else
@@ -4647,8 +5242,8 @@ long ibis::part::doScan(const ibis::qRange &cmp,
         ierr = col->getValuesArray(&doublearray);
         if (ierr >= 0) {
             if (cmp.getType() == ibis::qExpr::RANGE)
-                ierr = doScan
-                    (doublearray,
+                ierr = shareScan
+                    (*col, doublearray,
                      static_cast<const ibis::qContinuousRange&>(cmp),
                      mask, hits);
             else
@@ -4672,6 +5267,11 @@ long ibis::part::doScan(const ibis::qRange &cmp,
             << hits.size() << " to " << nEvents;
         hits.adjustSize(0, nEvents); // append 0 bits or remove extra bits
     }
+    if (sure.size() == nEvents && sure.cnt() > 0) {
+        hits |= sure;
+        if (ierr >= 0)
+            ierr = hits.cnt();
+    }
     LOGGER(ibis::gVerbose > 7)
         << evt << " examined " << mask.cnt() << " candidates and found "
         << hits.cnt() << " hits";
@@ -5993,6 +6593,20 @@ long ibis::part::doScan(const ibis::compRange &cmp,
     return doScan(cmp, mask, hits);
 } // ibis::part::doScan
 
+/// Compare two values the same way as ibis::compRange::inRange.  An
+/// unknown operator is treated as satisfied.
+static inline bool
+_ibis_part_compare(double lhs, ibis::qExpr::COMPARE op, double rhs) {
+    switch (op) {
+    case ibis::qExpr::OP_LT: return (lhs < rhs);
+    case ibis::qExpr::OP_LE: return (lhs <= rhs);
+    case ibis::qExpr::OP_GT: return (lhs > rhs);
+    case ibis::qExpr::OP_GE: return (lhs >= rhs);
+    case ibis::qExpr::OP_EQ: return (lhs == rhs);
+    default:                 return true;
+    }
+} // _ibis_part_compare
+
 /// Locate the records that have mark value 1 and satisfy the complex
 /// range conditions.
 /// This implementation uses ibis::part::barrel for handling actual values
@@ -6046,6 +6660,72 @@ long ibis::part::doScan(const ibis::compRange &cmp,
         throw "part::doScan -- failed to prepare data" IBIS_FILE_LINE;
     }
 
+    ibis::math::program prog(vlist);
+    const bool has1 = (cmp.getLeft() != 0 &&
+                       cmp.leftOperator() != ibis::qExpr::OP_UNDEFINED);
+    const bool has3 = (cmp.getTerm3() != 0 &&
+                       cmp.rightOperator() != ibis::qExpr::OP_UNDEFINED);
+    const int out1 = (has1 ? prog.add(*static_cast<const ibis::math::term*>
+                                      (cmp.getLeft())) : 0);
+    const int out2 = (cmp.getRight() != 0 ?
+                      prog.add(*static_cast<const ibis::math::term*>
+                               (cmp.getRight())) : -1);
+    const int out3 = (has3 ? prog.add(*cmp.getTerm3()) : 0);
+    if (out1 >= 0 && out2 >= 0 && out3 >= 0 && vlist.inMemory()) {
+        // evaluate the three terms on a block of rows at a time
+        ibis::bitvector::word_t rows[ibis::math::program::BLOCKSIZE];
+        ibis::bitvector::decoder dec(mask);
+        ibis::bitvector::builder bld(hits);
+        for (uint32_t n = dec.positions(rows, ibis::math::program::BLOCKSIZE);
+             n > 0;
+             n = dec.positions(rows, ibis::math::program::BLOCKSIZE)) {
+            for (uint32_t i = 0; i < vlist.size(); ++ i)
+                vlist.fetch(i, rows, n, prog.input(i));
+            prog.run(n);
+            const double *tm2 = prog.output(out2);
+            if (cmp.leftOperator() == ibis::qExpr::OP_UNDEFINED &&
+                cmp.rightOperator() == ibis::qExpr::OP_UNDEFINED) {
+                for (uint32_t j = 0; j < n; ++ j) {
+                    if (tm2[j] != 0.0)
+                        bld.setBit(rows[j]);
+                }
+                continue;
+            }
+
+            const double *tm1 = (has1 ? prog.output(out1) : 0);
+            const double *tm3 = (has3 ? prog.output(out3) : 0);
+            for (uint32_t j = 0; j < n; ++ j) {
+                bool res = true;
+                if (has1)
+                    res = _ibis_part_compare(tm1[j], cmp.leftOperator(),
+                                             tm2[j]);
+                if (has3 && res)
+                    res = _ibis_part_compare(tm2[j], cmp.rightOperator(),
+                                             tm3[j]);
+                if (res)
+                    bld.setBit(rows[j]);
+            }
+        }
+        bld.finish(mask.size());
+        if (hits.size() < nEvents)
+            hits.setBit(nEvents-1, 0);
+        if (ibis::gVerbose > 3) {
+            timer.stop();
+            ierr = hits.cnt();
+            ibis::util::logger lg;
+            lg() << "part[" << (m_name ? m_name : "?")
+                 << "]::doScan -- evaluating "
+                 << cmp << " on " << mask.cnt() << " records (total: "
+                 << nEvents << ") took " << timer.realTime()
+                 << " sec elapsed time and produced "
+                 << ierr << " hit" << (ierr>1?"s":"");
+        }
+        else {
+            ierr = hits.sloppyCount();
+        }
+        return ierr;
+    }
+
     const bool uncomp = ((mask.size() >> 8) < mask.cnt());
     if (uncomp) { // use uncompressed hits internally
         hits.set(0, mask.size());
@@ -6169,28 +6849,47 @@ long ibis::part::calculate(const ibis::math::term &trm,
         throw "part::calculate -- failed to prepare data" IBIS_FILE_LINE;
     }
 
-    // feed the values into vlist and evaluate the arithmetic expression
-    ibis::bitvector::indexSet idx = msk.firstIndexSet();
-    const ibis::bitvector::word_t *iix = idx.indices();
-    while (idx.nIndices() > 0) {
-        if (idx.isRange()) {
-            // move the file pointers of open files
-            vlist.seek(*iix);
-            for (uint32_t j = 0; j < idx.nIndices(); ++j) {
-                vlist.read();
-                res.push_back(trm.eval());
-            } // for (uint32_t j = 0; j < idx.nIndices(); ++j)
-        }
-        else {
-            for (uint32_t j = 0; j < idx.nIndices(); ++j) {
-                vlist.seek(iix[j]);
-                vlist.read();
-                res.push_back(trm.eval());
-            } // for (uint32_t j = 0; j < idx.nIndices(); ++j)
+    ibis::math::program prog(vlist);
+    const int out = prog.add(trm);
+    if (out >= 0 && vlist.inMemory()) {
+        // evaluate the expression on a block of rows at a time
+        ibis::bitvector::word_t rows[ibis::math::program::BLOCKSIZE];
+        ibis::bitvector::decoder dec(msk);
+        for (uint32_t n = dec.positions(rows, ibis::math::program::BLOCKSIZE);
+             n > 0;
+             n = dec.positions(rows, ibis::math::program::BLOCKSIZE)) {
+            for (uint32_t i = 0; i < vlist.size(); ++ i)
+                vlist.fetch(i, rows, n, prog.input(i));
+            prog.run(n);
+            const double *val = prog.output(out);
+            res.insert(res.end(), val, val+n);
         }
+    }
+    else {
+        // feed the values into vlist and evaluate the arithmetic
+        // expression one row at a time
+        ibis::bitvector::indexSet idx = msk.firstIndexSet();
+        const ibis::bitvector::word_t *iix = idx.indices();
+        while (idx.nIndices() > 0) {
+            if (idx.isRange()) {
+                // move the file pointers of open files
+                vlist.seek(*iix);
+                for (uint32_t j = 0; j < idx.nIndices(); ++j) {
+                    vlist.read();
+                    res.push_back(trm.eval());
+                } // for (uint32_t j = 0; j < idx.nIndices(); ++j)
+            }
+            else {
+                for (uint32_t j = 0; j < idx.nIndices(); ++j) {
+                    vlist.seek(iix[j]);
+                    vlist.read();
+                    res.push_back(trm.eval());
+                } // for (uint32_t j = 0; j < idx.nIndices(); ++j)
+            }
 
-        ++ idx;
-    } // while (idx.nIndices() > 0)
+            ++ idx;
+        } // while (idx.nIndices() > 0)
+    }
 
     if (ibis::gVerbose > 3) {
         timer.stop();
@@ -6336,30 +7035,54 @@ long ibis::part::doScan(const ibis::math::term &trm,
 
     // open all necessary files
     vlist.open();
-    // feed the values into vlist and evaluate the arithmetic expression
-    ibis::bitvector::indexSet idx = msk.firstIndexSet();
-    const ibis::bitvector::word_t *iix = idx.indices();
-    while (idx.nIndices() > 0) {
-        if (idx.isRange()) {
-            // move the file pointers of open files
-            vlist.seek(*iix);
-            for (uint32_t j = 0; j < idx.nIndices(); ++j) {
-                vlist.read();
-                if (trm.eval() != 0)
-                    res.setBit(*iix + j, 1);
-            } // for (uint32_t j = 0; j < idx.nIndices(); ++j)
-        }
-        else {
-            for (uint32_t j = 0; j < idx.nIndices(); ++j) {
-                vlist.seek(iix[j]);
-                vlist.read();
-                if (trm.eval() != 0)
-                    res.setBit(iix[j], 1);
-            } // for (uint32_t j = 0; j < idx.nIndices(); ++j)
-        }
+    ibis::math::program prog(vlist);
+    const int out = prog.add(trm);
+    if (out >= 0 && vlist.inMemory()) {
+        // evaluate the expression on a block of rows at a time
+        ibis::bitvector::word_t rows[ibis::math::program::BLOCKSIZE];
+        ibis::bitvector::decoder dec(msk);
+        ibis::bitvector::builder bld(res);
+        for (uint32_t n = dec.positions(rows, ibis::math::program::BLOCKSIZE);
+             n > 0;
+             n = dec.positions(rows, ibis::math::program::BLOCKSIZE)) {
+            for (uint32_t i = 0; i < vlist.size(); ++ i)
+                vlist.fetch(i, rows, n, prog.input(i));
+            prog.run(n);
+            const double *val = prog.output(out);
+            for (uint32_t j = 0; j < n; ++ j) {
+                if (val[j] != 0)
+                    bld.setBit(rows[j]);
+            }
+        }
+        bld.finish(msk.size());
+    }
+    else {
+        // feed the values into vlist and evaluate the arithmetic
+        // expression one row at a time
+        ibis::bitvector::indexSet idx = msk.firstIndexSet();
+        const ibis::bitvector::word_t *iix = idx.indices();
+        while (idx.nIndices() > 0) {
+            if (idx.isRange()) {
+                // move the file pointers of open files
+                vlist.seek(*iix);
+                for (uint32_t j = 0; j < idx.nIndices(); ++j) {
+                    vlist.read();
+                    if (trm.eval() != 0)
+                        res.setBit(*iix + j, 1);
+                } // for (uint32_t j = 0; j < idx.nIndices(); ++j)
+            }
+            else {
+                for (uint32_t j = 0; j < idx.nIndices(); ++j) {
+                    vlist.seek(iix[j]);
+                    vlist.read();
+                    if (trm.eval() != 0)
+                        res.setBit(iix[j], 1);
+                } // for (uint32_t j = 0; j < idx.nIndices(); ++j)
+            }
 
-        ++ idx;
-    } // while (idx.nIndices() > 0)
+            ++ idx;
+        } // while (idx.nIndices() > 0)
+    }
 
     if (ierr >= 0) {
         if (ibis::gVerbose > 3) {
@@ -9067,6 +9790,231 @@ long ibis::part::doCompare(const char* file,
     return ierr;
 } // ibis::part::doCompare
 
+/// Evaluate @c cmp on the bitsPerLiteral() values starting at @c v and
+/// pack the results into a literal word, with the result for v[0] at 2^30.
+/// The comparisons are written into a byte array without branches so that
+/// the compiler can turn the loop into vector compares for each value type
+/// and comparison functor, and the bytes are packed with SSE2 where
+/// available.
+template <typename T, typename F>
+static inline ibis::bitvector::word_t
+_ibis_part_block(const T *v, F &cmp) {
+    unsigned char flags[32];
+    for (unsigned k = 0; k < 31; ++ k)
+        flags[30-k] = static_cast<unsigned char>(cmp(v[k]));
+    flags[31] = 0;
+#if defined(FASTBIT_PART_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const unsigned lo = _mm_movemask_epi8
+        (_mm_cmpgt_epi8(_mm_loadu_si128((const __m128i*)flags), zero));
+    const unsigned hi = _mm_movemask_epi8
+        (_mm_cmpgt_epi8(_mm_loadu_si128((const __m128i*)(flags+16)), zero));
+    return (lo | (hi << 16));
+#else
+    ibis::bitvector::word_t w = 0;
+    for (unsigned k = 0; k < 31; ++ k)
+        w |= (static_cast<ibis::bitvector::word_t>(flags[k]) << k);
+    return w;
+#endif
+} // _ibis_part_block
+
+/// Evaluate @c cmp on the rows marked 1 in @c mask and mark the rows
+/// satisfying the condition with @c bld.  If @c packed is true, @c vals
+/// only contains the values of the rows marked 1 in @c mask, otherwise it
+/// contains the values of all rows.  The rows in a range of the mask that
+/// cover a whole literal word of the output are evaluated together with
+/// _ibis_part_block; the other rows are evaluated one at a time.  Returns
+/// the number of rows examined.
+template <typename T, typename F>
+static long _ibis_part_scan(const T *vals, F cmp,
+                            const ibis::bitvector &mask, bool packed,
+                            ibis::bitvector::builder &bld) {
+    const ibis::bitvector::word_t nb = ibis::bitvector::bitsPerLiteral();
+    ibis::bitvector::word_t starts[256], ends[256];
+    ibis::bitvector::decoder dec(mask);
+    long ival = 0;
+    for (uint32_t nrng = dec.ranges(starts, ends, 256); nrng > 0;
+         nrng = dec.ranges(starts, ends, 256)) {
+        for (uint32_t i = 0; i < nrng; ++ i) {
+            ibis::bitvector::word_t j = starts[i];
+            const ibis::bitvector::word_t end = ends[i];
+            const T *v = vals + (packed ? ival : static_cast<long>(j));
+            ival += end - j;
+
+            ibis::bitvector::word_t aligned = ((j + nb - 1) / nb) * nb;
+            if (aligned > end)
+                aligned = end;
+            for (; j < aligned; ++ j, ++ v) {
+                if (cmp(*v))
+                    bld.setBit(j);
+            }
+            for (; j + nb <= end; j += nb, v += nb) {
+                const ibis::bitvector::word_t w = _ibis_part_block(v, cmp);
+                if (w != 0)
+                    bld.setWord(j, w);
+            }
+            for (; j < end; ++ j, ++ v) {
+                if (cmp(*v))
+                    bld.setBit(j);
+            }
+        }
+    }
+    return ival;
+} // _ibis_part_scan
+
+/// The number of threads to use for scanning @c nrows rows.  It is
+/// controlled by two parameters:
+///
+/// \arg scan.nThreads The maximum number of threads used to scan one data
+/// partition.  The default is 1, i.e., scans are serial.
+///
+/// \arg scan.minRowsPerThread The minimum number of rows of the mask
+/// assigned to each thread.  Masks with fewer than twice this number of
+/// rows are scanned serially.  The default is 1048576.
+static unsigned _ibis_part_scanThreads(uint32_t nrows) {
+    const double nthr = ibis::gParameters().getNumber("scan.nThreads");
+    double minrows = ibis::gParameters().getNumber("scan.minRowsPerThread");
+    if (nthr < 2.0)
+        return 1;
+    if (minrows < ibis::bitvector::bitsPerLiteral())
+        minrows = 1048576.0;
+
+    unsigned ret = static_cast<unsigned>(nrows / minrows);
+    if (ret > nthr)
+        ret = static_cast<unsigned>(nthr);
+    return (ret > 1 ? ret : 1);
+} // _ibis_part_scanThreads
+
+/// One segment of a parallel scan.  The rows of the segment are numbered
+/// from 0.
+template <typename T, typename F>
+struct _ibis_part_segment {
+    const T *vals;         ///!< The values of the segment.
+    F cmp;                 ///!< The comparison functor.
+    bool packed;           ///!< Whether @c vals only has the rows in mask.
+    long ierr;             ///!< Negative if the scan failed.
+    ibis::bitvector mask;  ///!< The rows to examine.
+    ibis::bitvector hits;  ///!< The rows satisfying the condition.
+
+    explicit _ibis_part_segment(F c) : vals(0), cmp(c), packed(false),
+                                       ierr(0) {}
+}; // _ibis_part_segment
+
+/// The thread function for scanning one segment.
+template <typename T, typename F>
+static void* _ibis_part_scanSegment(void *arg) {
+    _ibis_part_segment<T, F> &seg =
+        *static_cast<_ibis_part_segment<T, F>*>(arg);
+    try {
+        ibis::bitvector::builder bld(seg.hits);
+        (void) _ibis_part_scan(seg.vals, seg.cmp, seg.mask, seg.packed, bld);
+        bld.finish(seg.mask.size());
+    }
+    catch (...) {
+        seg.ierr = -1;
+        return reinterpret_cast<void*>(-1);
+    }
+    return 0;
+} // _ibis_part_scanSegment
+
+/// Evaluate @c cmp on the rows marked 1 in @c mask and place the results
+/// in @c hits.  The arguments are the same as those of _ibis_part_scan.
+/// A large mask is split into segments of whole literal words, which are
+/// scanned by separate threads, and the results are concatenated in
+/// order.  Since every segment except the last one ends on a word
+/// boundary, the concatenation only copies the compressed words.
+template <typename T, typename F>
+static void _ibis_part_scanAll(const T *vals, F cmp,
+                               const ibis::bitvector &mask, bool packed,
+                               ibis::bitvector &hits) {
+    const unsigned nthr = _ibis_part_scanThreads(mask.size());
+    if (nthr <= 1) {
+        ibis::bitvector::builder bld(hits);
+        (void) _ibis_part_scan(vals, cmp, mask, packed, bld);
+        bld.finish(mask.size());
+        return;
+    }
+
+    const ibis::bitvector::word_t nb = ibis::bitvector::bitsPerLiteral();
+    const ibis::bitvector::word_t seglen =
+        ((mask.size() / nthr + nb - 1) / nb) * nb;
+    std::vector< _ibis_part_segment<T, F> >
+        segs(nthr, _ibis_part_segment<T, F>(cmp));
+    {
+        ibis::bitvector::skipIndex sk(mask);
+        long ival = 0;
+        for (unsigned i = 0; i < nthr; ++ i) {
+            const ibis::bitvector::word_t begin = seglen * i;
+            const ibis::bitvector::word_t end =
+                (i+1 < nthr ? begin + seglen : mask.size());
+            sk.slice(begin, end, segs[i].mask);
+            segs[i].packed = packed;
+            segs[i].vals = vals + (packed ? ival : static_cast<long>(begin));
+            if (packed)
+                ival += segs[i].mask.cnt();
+        }
+    }
+
+    std::vector<pthread_t> tid(nthr);
+    std::vector<bool> started(nthr, false);
+    for (unsigned i = 1; i < nthr; ++ i) {
+        int ierr = pthread_create(&(tid[i]), 0,
+                                  _ibis_part_scanSegment<T, F>,
+                                  static_cast<void*>(&(segs[i])));
+        if (ierr == 0) {
+            started[i] = true;
+        }
+        else {
+            LOGGER(ibis::gVerbose > 1)
+                << "Warning -- part::doScan could not start thread # " << i
+                << " to scan rows " << seglen * i << " and beyond ("
+                << strerror(ierr) << "), will scan them serially";
+        }
+    }
+    (void) _ibis_part_scanSegment<T, F>(static_cast<void*>(&(segs[0])));
+    for (unsigned i = 1; i < nthr; ++ i) {
+        if (started[i]) {
+            void *j;
+            pthread_join(tid[i], &j);
+        }
+        else {
+            (void) _ibis_part_scanSegment<T, F>
+                (static_cast<void*>(&(segs[i])));
+        }
+    }
+
+    for (unsigned i = 0; i < nthr; ++ i) {
+        if (segs[i].ierr < 0) { // try again with only this thread
+            ibis::bitvector::builder bld(hits);
+            (void) _ibis_part_scan(vals, cmp, mask, packed, bld);
+            bld.finish(mask.size());
+            return;
+        }
+    }
+    hits.swap(segs[0].hits);
+    for (unsigned i = 1; i < nthr; ++ i)
+        hits += segs[i].hits;
+} // _ibis_part_scanAll
+
+/// A functor requiring both functors to be true.  Both are evaluated, so
+/// that the scan kernel can evaluate them without branches.
+template <typename F1, typename F2>
+struct _ibis_part_both {
+    F1 cmp1;
+    F2 cmp2;
+    _ibis_part_both(F1 c1, F2 c2) : cmp1(c1), cmp2(c2) {}
+    template <typename T>
+    bool operator()(const T &v) {return (cmp1(v) & cmp2(v));}
+}; // _ibis_part_both
+
+/// A functor for the scan kernel that calls qRange::inRange.
+struct _ibis_part_inRange {
+    const ibis::qRange &rng;
+    explicit _ibis_part_inRange(const ibis::qRange &r) : rng(r) {}
+    template <typename T>
+    bool operator()(const T &v) const {return rng.inRange(v);}
+}; // _ibis_part_inRange
+
 /// The function that performs the actual comparison for range queries.
 /// The size of array may either match the number of bits in @c mask or the
 /// number of set bits in @c mask.  This allows one to either use the whole
@@ -9079,89 +10027,23 @@ long ibis::part::doCompare(const array_t<T> &array,
                            const ibis::qRange &cmp,
                            const ibis::bitvector &mask,
                            ibis::bitvector &hits) {
-    ibis::horometer timer;
-    if (ibis::gVerbose > 3) timer.start(); // start the timer
-
-    long ierr = 0;
-    uint32_t i=0, j=0;
-    const bool uncomp = ((mask.size() >> 8) < mask.cnt());
-    if (uncomp) { // use uncompressed hits internally
-        hits.set(0, mask.size());
-        hits.decompress();
-    }
-    else {
-        hits.clear();
-        hits.reserve(mask.size(), mask.cnt());
+    if (cmp.getType() == ibis::qExpr::RANGE) {
+        // select the comparison functors once instead of switching on the
+        // operators for every value
+        return doScan(array,
+                      static_cast<const ibis::qContinuousRange&>(cmp),
+                      mask, hits);
     }
 
-    ibis::bitvector::indexSet idx = mask.firstIndexSet();
-    if (array.size() == mask.size()) { // full array available
-        while (idx.nIndices() > 0) { // the outer loop
-            const ibis::bitvector::word_t *ii = idx.indices();
-            if (idx.isRange()) {
-                for (j = *ii; j < ii[1]; ++j) {
-                    if (cmp.inRange(array[j])) {
-                        hits.setBit(j, 1);
-                        ++ ierr;
-#if DEBUG+0 > 1 || _DEBUG+0 > 1
-                        LOGGER(ibis::gVerbose >= 0)
-                            << "DEBUG -- doCompare" << array[j] << " is in "
-                            << cmp;
-#endif
-                    }
-                }
-            }
-            else {
-                for (i = 0; i < idx.nIndices(); ++i) {
-                    j = ii[i];
-                    if (cmp.inRange(array[j])) {
-                        hits.setBit(j, 1);
-                        ++ ierr;
-#if DEBUG+0 > 1 || _DEBUG+0 > 1
-                        LOGGER(ibis::gVerbose >= 0)
-                            << "DEBUG -- doCompare " << array[j] << " is in "
-                            << cmp;
-#endif
-                    }
-                }
-            }
-
-            ++idx; // next set of selected entries
-        }
-    }
-    else if (array.size() == mask.cnt()) { // packed array available
-        while (idx.nIndices() > 0) {
-            const ibis::bitvector::word_t *ii = idx.indices();
-            if (idx.isRange()) {
-                for (unsigned k = *ii; k < ii[1]; ++ k) {
-                    if (cmp.inRange(array[j++])) {
-                        hits.setBit(k, 1);
-                        ++ ierr;
-#if DEBUG+0 > 1 || _DEBUG+0 > 1
-                        LOGGER(ibis::gVerbose >= 0)
-                            << "DEBUG -- doCompare" << array[j] << " is in "
-                            << cmp << ", setting position " << k
-                            << " of hit vector to 1";
-#endif
-                    }
-                }
-            }
-            else {
-                for (uint32_t k = 0; k < idx.nIndices(); ++ k) {
-                    if (cmp.inRange(array[j++])) {
-                        hits.setBit(ii[k], 1);
-                        ++ ierr;
-#if DEBUG+0 > 1 || _DEBUG+0 > 1
-                        LOGGER(ibis::gVerbose >= 0)
-                            << "DEBUG -- doCompare " << array[j] << " is in "
-                            << cmp << ", setting position " << ii[k]
-                            << " of hit vector to 1";
-#endif
-                    }
-                }
-            }
-            ++ idx;
-        }
+    ibis::horometer timer;
+    if (ibis::gVerbose > 3) timer.start(); // start the timer
+
+    long ierr = 0;
+    // the rows are checked in order, the hits are appended one word at a
+    // time in compressed form
+    if (array.size() == mask.size() || array.size() == mask.cnt()) {
+        _ibis_part_scanAll(array.begin(), _ibis_part_inRange(cmp), mask,
+                           array.size() != mask.size(), hits);
     }
     else {
         LOGGER(ibis::gVerbose > 0)
@@ -9171,10 +10053,8 @@ long ibis::part::doCompare(const array_t<T> &array,
         ierr = -6;
     }
 
-    if (uncomp)
-        hits.compress();
-    else if (hits.size() != mask.size())
-        hits.adjustSize(0, mask.size());
+    if (ierr >= 0)
+        ierr = hits.cnt();
 
     if (ibis::gVerbose > 3 && ierr >= 0) {
         timer.stop();
@@ -16805,8 +17685,9 @@ long ibis::part::doScan(const array_t<double> &vals,
 } // ibis::part::doScan
 
 /// Evaluate the range condition.  Accepts an externally passed comparison
-/// operator.  It chooses whether the bitvector @c hits will be compressed
-/// internally based on the number of set bits in the @c mask.
+/// operator.  The rows are checked in order and the bitvector @c hits is
+/// built in compressed form with bitvector::builder.  A large mask may be
+/// split among several threads, see the parameter scan.nThreads.
 template <typename T, typename F>
 long ibis::part::doComp(const array_t<T> &vals, F cmp,
                         const ibis::bitvector &mask,
@@ -16825,138 +17706,28 @@ long ibis::part::doComp(const array_t<T> &vals, F cmp,
         return ierr;
     }
 
-    const bool uncomp = ((mask.size() >> 8) < mask.cnt());
-    if (uncomp) { // use uncompressed hits internally
-        hits.set(0, mask.size());
-        hits.decompress();
-    }
-    else {
-        hits.clear();
-        hits.reserve(mask.size(), mask.cnt());
-    }
-    if (vals.size() == mask.size()) { // full list of values
-        for (ibis::bitvector::indexSet ix = mask.firstIndexSet();
-             ix.nIndices() > 0; ++ ix) {
-            const ibis::bitvector::word_t *iix = ix.indices();
-            if (ix.isRange()) {
-                for (unsigned j = *iix; j < iix[1]; ++ j) {
-                    if (cmp(vals[j]))
-                        hits.setBit(j, 1);
-                }
-            }
-            else {
-                for (unsigned j = 0; j < ix.nIndices(); ++ j) {
-                    if (cmp(vals[iix[j]]))
-                        hits.setBit(iix[j], 1);
-                }
-            }
-        }
-    }
-    else { // compacted values
-        unsigned ival = 0;
-        for (ibis::bitvector::indexSet ix = mask.firstIndexSet();
-             ix.nIndices() > 0; ++ ix) {
-            const ibis::bitvector::word_t *iix = ix.indices();
-            if (ix.isRange()) {
-                for (unsigned j = *iix; j < iix[1]; ++ j) {
-                    if (cmp(vals[ival]))
-                        hits.setBit(j, 1);
-                    ++ ival;
-                }
-            }
-            else {
-                for (unsigned j = 0; j < ix.nIndices(); ++ j) {
-                    if (cmp(vals[ival]))
-                        hits.setBit(iix[j], 1);
-                    ++ ival;
-                }
-            }
-        }
-    }
-
-    if (uncomp)
-        hits.compress();
-    else
-        hits.adjustSize(0, mask.size());
+    _ibis_part_scanAll(vals.begin(), cmp, mask, vals.size() != mask.size(),
+                       hits);
 
     ierr = hits.sloppyCount();
     return ierr;
 } // ibis::part::doComp
 
-/// Evaluate the range condition.  The actual comparison function is
-/// only applied on rows with mask == 1.
-/// This version uses a uncompressed bitvector to store the scan results
-/// internally.
+/// Evaluate the range condition.  This used to record the scan results
+/// in an uncompressed bitvector for dense masks.  Since doComp appends the
+/// results of whole blocks of rows to the compressed bitvector, this
+/// simply calls doComp.
 template <typename T, typename F>
 long ibis::part::doComp0(const array_t<T> &vals, F cmp,
                          const ibis::bitvector &mask,
                          ibis::bitvector &hits) {
-    long ierr = 0;
-    if (mask.size() == 0 || mask.cnt() == 0)
-        return ierr;
-
-    if (vals.size() != mask.size() && vals.size() != mask.cnt()) {
-        LOGGER(ibis::gVerbose > 0)
-            << "Warning -- part::doComp0<" << typeid(T).name() << ", "
-            << typeid(F).name() << ">(vals[" << vals.size()
-            << "]) -- vals.size() must be either mask.size(" << mask.size()
-            << ") or mask.cnt(" << mask.cnt() << ")";
-        ierr = -1;
-        return ierr;
-    }
-
-    hits.set(0, mask.size());
-    hits.decompress();
-    if (vals.size() == mask.size()) { // full list of values
-        for (ibis::bitvector::indexSet ix = mask.firstIndexSet();
-             ix.nIndices() > 0; ++ ix) {
-            const ibis::bitvector::word_t *iix = ix.indices();
-            if (ix.isRange()) {
-                for (unsigned j = *iix; j < iix[1]; ++ j) {
-                    if (cmp(vals[j]))
-                        hits.turnOnRawBit(j);
-                }
-            }
-            else {
-                for (unsigned j = 0; j < ix.nIndices(); ++ j) {
-                    if (cmp(vals[iix[j]]))
-                        hits.turnOnRawBit(iix[j]);
-                }
-            }
-        }
-    }
-    else { // compacted values
-        unsigned ival = 0;
-        for (ibis::bitvector::indexSet ix = mask.firstIndexSet();
-             ix.nIndices() > 0; ++ ix) {
-            const ibis::bitvector::word_t *iix = ix.indices();
-            if (ix.isRange()) {
-                for (unsigned j = *iix; j < iix[1]; ++ j) {
-                    if (cmp(vals[ival]))
-                        hits.turnOnRawBit(j);
-                    ++ ival;
-                }
-            }
-            else {
-                for (unsigned j = 0; j < ix.nIndices(); ++ j) {
-                    if (cmp(vals[ival]))
-                        hits.turnOnRawBit(iix[j]);
-                    ++ ival;
-                }
-            }
-        }
-    }
-
-    hits.compress();
-    ierr = hits.sloppyCount();
-    return ierr;
+    return doComp(vals, cmp, mask, hits);
 } // ibis::part::doComp0
 
 /// Evaluate the range condition.  The actual comparison functions are
 /// only applied on rows with mask == 1.
-/// The actual scan function.  This one chooses whether the internal
-/// bitvector for storing the scan results will be compressed or not.  It
-/// always returns a compressed bitvector.
+/// The actual scan function.  The scan results are appended to the
+/// bitvector @c hits in compressed form with bitvector::builder.
 template <typename T, typename F1, typename F2>
 long ibis::part::doComp(const array_t<T> &vals, F1 cmp1, F2 cmp2,
                         const ibis::bitvector &mask,
@@ -16975,128 +17746,21 @@ long ibis::part::doComp(const array_t<T> &vals, F1 cmp1, F2 cmp2,
         return ierr;
     }
 
-    const bool uncomp = ((mask.size() >> 8) < mask.cnt());
-    if (uncomp) { // use uncompressed hits internally
-        hits.set(0, mask.size());
-        hits.decompress();
-    }
-    else {
-        hits.clear();
-        hits.reserve(mask.size(), mask.cnt());
-    }
-    if (vals.size() == mask.size()) { // full list of values
-        for (ibis::bitvector::indexSet ix = mask.firstIndexSet();
-             ix.nIndices() > 0; ++ ix) {
-            const ibis::bitvector::word_t *iix = ix.indices();
-            if (ix.isRange()) {
-                for (unsigned j = *iix; j < iix[1]; ++ j) {
-                    if (cmp1(vals[j]) && cmp2(vals[j]))
-                        hits.setBit(j, 1);
-                }
-            }
-            else {
-                for (unsigned j = 0; j < ix.nIndices(); ++ j) {
-                    if (cmp1(vals[iix[j]]) && cmp2(vals[iix[j]]))
-                        hits.setBit(iix[j], 1);
-                }
-            }
-        }
-    }
-    else { // compacted values
-        unsigned ival = 0;
-        for (ibis::bitvector::indexSet ix = mask.firstIndexSet();
-             ix.nIndices() > 0; ++ ix) {
-            const ibis::bitvector::word_t *iix = ix.indices();
-            if (ix.isRange()) {
-                for (unsigned j = *iix; j < iix[1]; ++ j) {
-                    if (cmp1(vals[ival]) && cmp2(vals[ival]))
-                        hits.setBit(j, 1);
-                    ++ ival;
-                }
-            }
-            else {
-                for (unsigned j = 0; j < ix.nIndices(); ++ j) {
-                    if (cmp1(vals[ival]) && cmp2(vals[ival]))
-                        hits.setBit(iix[j], 1);
-                    ++ ival;
-                }
-            }
-        }
-    }
-
-    if (uncomp)
-        hits.compress();
-    else
-        hits.adjustSize(0, mask.size());
+    _ibis_part_scanAll(vals.begin(), _ibis_part_both<F1, F2>(cmp1, cmp2),
+                       mask, vals.size() != mask.size(), hits);
     ierr = hits.sloppyCount();
     return ierr;
 } // ibis::part::doComp
 
-/// This version uses uncompressed bitvector to store the scan results
-/// internally.
+/// Evaluate the range condition.  This used to record the scan results
+/// in an uncompressed bitvector for dense masks.  Since doComp appends the
+/// results of whole blocks of rows to the compressed bitvector, this
+/// simply calls doComp.
 template <typename T, typename F1, typename F2>
 long ibis::part::doComp0(const array_t<T> &vals, F1 cmp1, F2 cmp2,
                          const ibis::bitvector &mask,
                          ibis::bitvector &hits) {
-    long ierr = 0;
-    if (mask.size() == 0 || mask.cnt() == 0)
-        return ierr;
-
-    if (vals.size() != mask.size() && vals.size() != mask.cnt()) {
-        LOGGER(ibis::gVerbose > 0)
-            << "Warning -- part::doComp0<" << typeid(T).name() << ", "
-            << typeid(F1).name() << ", " << typeid(F2).name() << ">(vals["
-            << vals.size() << "]) -- vals.size() must be either mask.size("
-            << mask.size() << ") or mask.cnt(" << mask.cnt() << ")";
-        ierr = -1;
-        return ierr;
-    }
-
-    hits.set(0, mask.size());
-    hits.decompress();
-    if (vals.size() == mask.size()) { // full list of values
-        for (ibis::bitvector::indexSet ix = mask.firstIndexSet();
-             ix.nIndices() > 0; ++ ix) {
-            const ibis::bitvector::word_t *iix = ix.indices();
-            if (ix.isRange()) {
-                for (unsigned j = *iix; j < iix[1]; ++ j) {
-                    if (cmp1(vals[j]) && cmp2(vals[j]))
-                        hits.turnOnRawBit(j);
-                }
-            }
-            else {
-                for (unsigned j = 0; j < ix.nIndices(); ++ j) {
-                    if (cmp1(vals[iix[j]]) && cmp2(vals[iix[j]]))
-                        hits.turnOnRawBit(iix[j]);
-                }
-            }
-        }
-    }
-    else { // compacted values
-        unsigned ival = 0;
-        for (ibis::bitvector::indexSet ix = mask.firstIndexSet();
-             ix.nIndices() > 0; ++ ix) {
-            const ibis::bitvector::word_t *iix = ix.indices();
-            if (ix.isRange()) {
-                for (unsigned j = *iix; j < iix[1]; ++ j) {
-                    if (cmp1(vals[ival]) && cmp2(vals[ival]))
-                        hits.turnOnRawBit(j);
-                    ++ ival;
-                }
-            }
-            else {
-                for (unsigned j = 0; j < ix.nIndices(); ++ j) {
-                    if (cmp1(vals[ival]) && cmp2(vals[ival]))
-                        hits.turnOnRawBit(iix[j]);
-                    ++ ival;
-                }
-            }
-        }
-    }
-
-    hits.compress();
-    ierr = hits.sloppyCount();
-    return ierr;
+    return doComp(vals, cmp1, cmp2, mask, hits);
 } // ibis::part::doComp0
 
 /// Evaluate the range condition.  Accepts an externally passed comparison
@@ -17194,6 +17858,7 @@ long ibis::part::doComp(const array_t<T> &vals, F cmp,
     }
 
     res.nosharing();
+    ibis::bitvector::builder bld(hits);
     if (res.capacity() < mask.cnt())
         res.reserve(mask.cnt() >> 1); // reserve space
     if (vals.size() == mask.size()) { // full list of values
@@ -17204,7 +17869,7 @@ long ibis::part::doComp(const array_t<T> &vals, F cmp,
                 for (unsigned j = *iix; j < iix[1]; ++ j) {
                     if (cmp(vals[j])) {
                         res.push_back(vals[j]);
-                        hits.setBit(j, 1);
+                        bld.setBit(j);
                     }
                 }
             }
@@ -17212,7 +17877,7 @@ long ibis::part::doComp(const array_t<T> &vals, F cmp,
                 for (unsigned j = 0; j < ix.nIndices(); ++ j) {
                     if (cmp(vals[iix[j]])) {
                         res.push_back(vals[iix[j]]);
-                        hits.setBit(iix[j], 1);
+                        bld.setBit(iix[j]);
                     }
                 }
             }
@@ -17227,7 +17892,7 @@ long ibis::part::doComp(const array_t<T> &vals, F cmp,
                 for (unsigned j = *iix; j < iix[1]; ++ j) {
                     if (cmp(vals[ival])) {
                         res.push_back(vals[ival]);
-                        hits.setBit(j, 1);
+                        bld.setBit(j);
                     }
                     ++ ival;
                 }
@@ -17236,7 +17901,7 @@ long ibis::part::doComp(const array_t<T> &vals, F cmp,
                 for (unsigned j = 0; j < ix.nIndices(); ++ j) {
                     if (cmp(vals[ival])) {
                         res.push_back(vals[ival]);
-                        hits.setBit(iix[j], 1);
+                        bld.setBit(iix[j]);
                     }
                     ++ ival;
                 }
@@ -17244,6 +17909,7 @@ long ibis::part::doComp(const array_t<T> &vals, F cmp,
         }
     }
 
+    bld.finish(mask.size());
     ierr = res.size();
     return ierr;
 } // ibis::part::doComp
@@ -17349,6 +18015,7 @@ long ibis::part::doComp(const array_t<T> &vals, F1 cmp1, F2 cmp2,
     }
 
     res.nosharing();
+    ibis::bitvector::builder bld(hits);
     if (res.capacity() < mask.cnt())
         res.reserve(mask.cnt() >> 1); // reserve space
     if (vals.size() == mask.size()) { // full list of values
@@ -17359,7 +18026,7 @@ long ibis::part::doComp(const array_t<T> &vals, F1 cmp1, F2 cmp2,
                 for (unsigned j = *iix; j < iix[1]; ++ j) {
                     if (cmp1(vals[j]) && cmp2(vals[j])) {
                         res.push_back(vals[j]);
-                        hits.setBit(j, 1);
+                        bld.setBit(j);
                     }
                 }
             }
@@ -17367,7 +18034,7 @@ long ibis::part::doComp(const array_t<T> &vals, F1 cmp1, F2 cmp2,
                 for (unsigned j = 0; j < ix.nIndices(); ++ j) {
                     if (cmp1(vals[iix[j]]) && cmp2(vals[iix[j]])) {
                         res.push_back(vals[iix[j]]);
-                        hits.setBit(iix[j], 1);
+                        bld.setBit(iix[j]);
                     }
                 }
             }
@@ -17382,7 +18049,7 @@ long ibis::part::doComp(const array_t<T> &vals, F1 cmp1, F2 cmp2,
                 for (unsigned j = *iix; j < iix[1]; ++ j) {
                     if (cmp1(vals[ival]) && cmp2(vals[ival])) {
                         res.push_back(vals[ival]);
-                        hits.setBit(j, 1);
+                        bld.setBit(j);
                     }
                     ++ ival;
                 }
@@ -17391,7 +18058,7 @@ long ibis::part::doComp(const array_t<T> &vals, F1 cmp1, F2 cmp2,
                 for (unsigned j = 0; j < ix.nIndices(); ++ j) {
                     if (cmp1(vals[ival]) && cmp2(vals[ival])) {
                         res.push_back(vals[ival]);
-                        hits.setBit(iix[j], 1);
+                        bld.setBit(iix[j]);
                     }
                     ++ ival;
                 }
@@ -17399,7 +18066,7 @@ long ibis::part::doComp(const array_t<T> &vals, F1 cmp1, F2 cmp2,
         }
     }
 
-    hits.adjustSize(0, mask.size());
+    bld.finish(mask.size());
     ierr = res.size();
     return ierr;
 } // ibis::part::doComp
@@ -20059,6 +20726,102 @@ long ibis::part::barrel::read() {
     return ierr;
 } // ibis::part::barrel::read
 
+/// Are the values of all variables in memory?  The function fetch may
+/// only be used if this function returns true.
+bool ibis::part::barrel::inMemory() const {
+    if (_tbl == 0 || stores.size() != size() || cols.size() != size())
+        return false;
+    for (uint32_t i = 0; i < size(); ++ i) {
+        if (stores[i] == 0 || cols[i] == 0)
+            return false;
+        switch (cols[i]->type()) {
+        case ibis::UBYTE:
+        case ibis::BYTE:
+        case ibis::USHORT:
+        case ibis::SHORT:
+        case ibis::CATEGORY:
+        case ibis::UINT:
+        case ibis::INT:
+        case ibis::ULONG:
+        case ibis::LONG:
+        case ibis::FLOAT:
+        case ibis::DOUBLE:
+            break;
+        default:
+            return false;
+        }
+        if (stores[i]->bytes() <
+            static_cast<size_t>(cols[i]->elementSize()) * _tbl->nRows())
+            return false;
+    }
+    return true;
+} // ibis::part::barrel::inMemory
+
+/// Copy the values at the given rows as doubles.
+template <typename T> static inline void
+_ibis_part_fetch(const char *base, const uint32_t *rows, uint32_t n,
+                 double *vals) {
+    const T *arr = reinterpret_cast<const T*>(base);
+    if (rows[n-1] - rows[0] + 1 == n) { // consecutive rows
+        arr += rows[0];
+        for (uint32_t k = 0; k < n; ++ k)
+            vals[k] = arr[k];
+    }
+    else {
+        for (uint32_t k = 0; k < n; ++ k)
+            vals[k] = arr[rows[k]];
+    }
+} // _ibis_part_fetch
+
+/// Copy the values of the ith variable at the @c n rows listed in @c
+/// rows into @c vals.  The rows must be in increasing order.  Unlike
+/// read, this function does not move the current position, and it only
+/// works when inMemory returns true.
+void ibis::part::barrel::fetch(uint32_t i, const uint32_t *rows, uint32_t n,
+                               double *vals) const {
+    if (n == 0) return;
+    const char *base = stores[i]->begin();
+    switch (cols[i]->type()) {
+    case ibis::UBYTE:
+        _ibis_part_fetch<unsigned char>(base, rows, n, vals);
+        break;
+    case ibis::BYTE:
+        _ibis_part_fetch<signed char>(base, rows, n, vals);
+        break;
+    case ibis::USHORT:
+        _ibis_part_fetch<uint16_t>(base, rows, n, vals);
+        break;
+    case ibis::SHORT:
+        _ibis_part_fetch<int16_t>(base, rows, n, vals);
+        break;
+    case ibis::CATEGORY:
+    case ibis::UINT:
+        _ibis_part_fetch<uint32_t>(base, rows, n, vals);
+        break;
+    case ibis::INT:
+        _ibis_part_fetch<int32_t>(base, rows, n, vals);
+        break;
+    case ibis::ULONG:
+        _ibis_part_fetch<uint64_t>(base, rows, n, vals);
+        break;
+    case ibis::LONG:
+        _ibis_part_fetch<int64_t>(base, rows, n, vals);
+        break;
+    case ibis::FLOAT:
+        _ibis_part_fetch<float>(base, rows, n, vals);
+        break;
+    case ibis::DOUBLE:
+        _ibis_part_fetch<double>(base, rows, n, vals);
+        break;
+    default:
+        LOGGER(ibis::gVerbose > 0)
+            << "Warning -- part::barrel::fetch can not handle column "
+            << cols[i]->name() << " of type "
+            << ibis::TYPESTRING[(int)cols[i]->type()];
+        break;
+    }
+} // ibis::part::barrel::fetch
+
 /// Seek to the position of the specified record for all variables.
 long ibis::part::barrel::seek(uint32_t pos) {
     if (pos == position) return 0;
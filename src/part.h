@@ -127,6 +127,9 @@ public:
     virtual double estimateCost(const ibis::qString &cmp) const;
     virtual double estimateCost(const ibis::qAnyString &cmp) const;
 
+    /// Start reading the files needed to evaluate the condition.
+    void prefetch(const ibis::qExpr *cond) const;
+
     /// Return an upper bound on the number of hits.
     virtual long estimateRange(const ibis::qContinuousRange &cmp) const;
 
@@ -646,6 +649,17 @@ public:
     /// Evaluate the strategy for accessing a data file.
     ibis::fileManager::ACCESS_PREFERENCE
     accessHint(const ibis::bitvector &mask, unsigned elemsize=4) const;
+    /// Advise the OS about the pages of a mapped data file to be read.
+    static void adviseAccess(const ibis::fileManager::storage &st,
+			     const ibis::bitvector &mask,
+			     unsigned elemsize=4);
+
+    /// Measure the constants of the cost model on this machine.
+    static int calibrateCosts(const char *dir, const char *rcfile=0);
+    /// The cost of reading and operating on bitmaps of an index.
+    static double indexCost(double bytes);
+    /// The cost of scanning the values of a column.
+    static double scanCost(double bytes, double rows);
 
     /// A struct to pack the arguments to function startTests.
     struct thrArg {
@@ -1358,11 +1372,21 @@ private:
     mutable pthread_mutex_t mutex;	///!< Mutex for partition manipulation.
     mutable pthread_rwlock_t rwlock;	///!< Rwlock for access control.
 
+    struct scanBatch;
+    /// Batches of range conditions sharing scans.  Protected by mutex.
+    mutable std::vector<scanBatch*> scanBatches;
+
     /******************************************************************/
     // private funcations
 
     void init(const char* prefix); ///!< Get directory names from gParameters.
 
+    template <typename T>
+    long shareScan(const ibis::column &col, const array_t<T> &vals,
+		   const ibis::qContinuousRange &cmp,
+		   const ibis::bitvector &mask,
+		   ibis::bitvector &hits) const;
+
     void   fillRIDs(const char* fn) const; ///!< Generate new RIDs.
     void   sortRIDs() const; ///!< Sort current list of RIDs.
     uint32_t searchSortedRIDs(const ibis::rid_t &rid) const;
@@ -1641,6 +1665,10 @@ public:
     void getNullMask(ibis::bitvector &mask) const;
     const ibis::column* getColumn(uint32_t i) const {return cols[i];}
 
+    bool inMemory() const;
+    void fetch(uint32_t i, const uint32_t *rows, uint32_t n,
+               double *vals) const;
+
 protected:
     const ibis::part *_tbl;
     uint32_t position;
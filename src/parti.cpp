@@ -314,6 +314,11 @@ long ibis::part::reorder(const ibis::table::stringArray& names,
     for (uint32_t i = 0; 0 == ierr && i < ind1.size(); ++ i)
         ierr = (ind1[i] != i);
     if (ierr == 0) {// no need for further action
+        for (columnList::const_iterator it = columns.begin();
+             it != columns.end(); ++ it) { // rebuild the zone maps
+            if (it->second->isNumeric())
+                it->second->computeMinMax();
+        }
         writeMetaData(nEvents, columns, activeDir);
         return ierr;
     }
@@ -463,6 +468,11 @@ long ibis::part::reorder(const ibis::table::stringArray& names,
             m_desc += currtime;
         }
     }
+    for (columnList::const_iterator it = columns.begin();
+         it != columns.end(); ++ it) { // rebuild the zone maps
+        if (it->second->isNumeric())
+            it->second->computeMinMax();
+    }
     writeMetaData(nEvents, columns, activeDir);
     LOGGER(ibis::gVerbose > 1 && ierr >= 0)
         << evt << " completed successfully";
@@ -485,6 +495,8 @@ long ibis::part::writeValues(const char *fname,
     evt += fname;
     evt += ')';
 
+    ibis::column::removeZoneMap(fname);
+    ibis::column::removeEncoded(fname);
     int fdes = UnixOpen(fname, OPEN_READWRITE, OPEN_FILEMODE);
     if (fdes < 0) {
         LOGGER(ibis::gVerbose > 1)
@@ -561,6 +573,8 @@ long ibis::part::reorderValues(const char *fname,
     evt += ">(";
     evt += fname;
     evt += ')';
+    ibis::column::removeZoneMap(fname);
+    ibis::column::removeEncoded(fname);
     int fdes = UnixOpen(fname, OPEN_READWRITE, OPEN_FILEMODE);
     if (fdes < 0) {
         LOGGER(ibis::gVerbose > 1)
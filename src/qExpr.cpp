@@ -1430,6 +1430,18 @@ void ibis::qExpr::extractDeprecatedJoins
     }
 } // ibis::qExpr::extractDeprecatedJoins
 
+/// Extract the operands of a chain of OR operators.  An expression that is
+/// not a LOGICAL_OR is its own only operand.
+void ibis::qExpr::extractDisjuncts(std::vector<const qExpr*>& terms) const {
+    if (type == LOGICAL_OR && left != 0 && right != 0) {
+        left->extractDisjuncts(terms);
+        right->extractDisjuncts(terms);
+    }
+    else {
+        terms.push_back(this);
+    }
+} // ibis::qExpr::extractDisjuncts
+
 /// Construct a qRange directly from a string representation of the constants.
 ibis::qContinuousRange::qContinuousRange
 (const char *lstr, qExpr::COMPARE lop, const char* prop,
@@ -2527,6 +2539,315 @@ double ibis::math::stdFunction2::eval() const {
     return lhs;
 } // ibis::math::stdfunction2::eval
 
+/// Constructor.  The first registers hold the values of the variables in
+/// @c bar.
+ibis::math::program::program(const ibis::math::barrel &bar) : vars(bar) {
+    regs.resize(static_cast<size_t>(bar.size()) * BLOCKSIZE);
+} // ibis::math::program::program
+
+/// Allocate a new register.
+uint32_t ibis::math::program::newRegister() {
+    const uint32_t r = regs.size() / BLOCKSIZE;
+    regs.resize(regs.size() + BLOCKSIZE);
+    return r;
+} // ibis::math::program::newRegister
+
+/// Add a term to the program.  Return a nonnegative identifier for the
+/// output of the term upon success.  Return a negative value if the term
+/// contains a function, an operator or a variable that can not be
+/// evaluated in this form, in which case the caller should fall back to
+/// term::eval.
+int ibis::math::program::add(const ibis::math::term &t) {
+    const size_t ncode = code.size();
+    const size_t nregs = regs.size();
+    const int ierr = compile(t);
+    if (ierr < 0) { // remove the partial translation
+        code.resize(ncode);
+        regs.resize(nregs);
+    }
+    return ierr;
+} // ibis::math::program::add
+
+/// Translate a term into instructions.  Return the register holding the
+/// value of the term, or a negative value for unsupported terms.
+int ibis::math::program::compile(const ibis::math::term &t) {
+    switch (t.termType()) {
+    default:
+        return -1;
+    case ibis::math::NUMBER: {
+        const uint32_t r = newRegister();
+        std::fill(regs.begin() + static_cast<size_t>(r) * BLOCKSIZE,
+                  regs.end(), t.eval());
+        return r;}
+    case ibis::math::VARIABLE: {
+        const char *nm =
+            static_cast<const ibis::math::variable&>(t).variableName();
+        for (uint32_t i = 0; i < vars.size(); ++ i) {
+            if (stricmp(nm, vars.name(i)) == 0)
+                return i;
+        }
+        return -2;}
+    case ibis::math::OPERATOR: {
+        const ibis::math::bediener &op =
+            static_cast<const ibis::math::bediener&>(t);
+        instruction ins;
+        ins.fun = 0;
+        switch (op.getOperator()) {
+        default:
+            return -3;
+        case ibis::math::NEGATE: {
+            const ibis::math::term *arg =
+                static_cast<const ibis::math::term*>
+                (op.getRight() != 0 ? op.getRight() : op.getLeft());
+            if (arg == 0)
+                return -3;
+            const int a = compile(*arg);
+            if (a < 0)
+                return a;
+            ins.op = NEG;
+            ins.left = a;
+            ins.right = a;
+            ins.out = newRegister();
+            code.push_back(ins);
+            return ins.out;}
+        case ibis::math::BITOR:    ins.op = BIT_OR;   break;
+        case ibis::math::BITAND:   ins.op = BIT_AND;  break;
+        case ibis::math::PLUS:     ins.op = ADD;      break;
+        case ibis::math::MINUS:    ins.op = SUB;      break;
+        case ibis::math::MULTIPLY: ins.op = MUL;      break;
+        case ibis::math::DIVIDE:   ins.op = DIV;      break;
+        case ibis::math::REMAINDER: ins.op = REM;     break;
+        case ibis::math::POWER:    ins.op = POWER_OP; break;
+        }
+        if (op.getLeft() == 0 || op.getRight() == 0)
+            return -3;
+        const int a = compile
+            (*static_cast<const ibis::math::term*>(op.getLeft()));
+        if (a < 0)
+            return a;
+        const int b = compile
+            (*static_cast<const ibis::math::term*>(op.getRight()));
+        if (b < 0)
+            return b;
+        ins.left = a;
+        ins.right = b;
+        ins.out = newRegister();
+        code.push_back(ins);
+        return ins.out;}
+    case ibis::math::STDFUNCTION1: {
+        const ibis::math::stdFunction1 &fn =
+            static_cast<const ibis::math::stdFunction1&>(t);
+        if (fn.getLeft() == 0)
+            return -4;
+        const int a = compile
+            (*static_cast<const ibis::math::term*>(fn.getLeft()));
+        if (a < 0)
+            return a;
+        instruction ins;
+        ins.op = FUN1;
+        ins.fun = fn.getFunction();
+        ins.left = a;
+        ins.right = a;
+        ins.out = newRegister();
+        code.push_back(ins);
+        return ins.out;}
+    case ibis::math::STDFUNCTION2: {
+        const ibis::math::stdFunction2 &fn =
+            static_cast<const ibis::math::stdFunction2&>(t);
+        if (fn.getLeft() == 0 || fn.getRight() == 0)
+            return -4;
+        const int a = compile
+            (*static_cast<const ibis::math::term*>(fn.getLeft()));
+        if (a < 0)
+            return a;
+        const int b = compile
+            (*static_cast<const ibis::math::term*>(fn.getRight()));
+        if (b < 0)
+            return b;
+        instruction ins;
+        ins.op = FUN2;
+        ins.fun = fn.getFunction();
+        ins.left = a;
+        ins.right = b;
+        ins.out = newRegister();
+        code.push_back(ins);
+        return ins.out;}
+    }
+} // ibis::math::program::compile
+
+/// Evaluate all terms on the first @c n values of the input arrays.  The
+/// value of @c n must not be larger than BLOCKSIZE.  Each operator and
+/// function produces the same values as the corresponding eval function.
+void ibis::math::program::run(uint32_t n) {
+    for (size_t j = 0; j < code.size(); ++ j) {
+        const instruction &ins = code[j];
+        double *out = &(regs[static_cast<size_t>(ins.out) * BLOCKSIZE]);
+        const double *a = &(regs[static_cast<size_t>(ins.left) * BLOCKSIZE]);
+        const double *b = &(regs[static_cast<size_t>(ins.right) * BLOCKSIZE]);
+        switch (ins.op) {
+        case NEG:
+            for (uint32_t k = 0; k < n; ++ k)
+                out[k] = -a[k];
+            break;
+        case ADD:
+            for (uint32_t k = 0; k < n; ++ k)
+                out[k] = a[k] + b[k];
+            break;
+        case SUB:
+            for (uint32_t k = 0; k < n; ++ k)
+                out[k] = a[k] - b[k];
+            break;
+        case MUL:
+            for (uint32_t k = 0; k < n; ++ k)
+                out[k] = a[k] * b[k];
+            break;
+        case DIV:
+            for (uint32_t k = 0; k < n; ++ k)
+                out[k] = (a[k] != 0.0 && b[k] != 0.0 ? a[k] / b[k] : 0.0);
+            break;
+        case REM:
+            for (uint32_t k = 0; k < n; ++ k)
+                out[k] = (a[k] != 0.0 && b[k] != 0.0 ? fmod(a[k], b[k]) :
+                          0.0);
+            break;
+        case POWER_OP:
+            for (uint32_t k = 0; k < n; ++ k)
+                out[k] = (a[k] == 0.0 ? 0.0 :
+                          b[k] == 0.0 ? 1.0 : pow(a[k], b[k]));
+            break;
+        case BIT_OR:
+            for (uint32_t k = 0; k < n; ++ k)
+                out[k] = static_cast<double>
+                    ((uint64_t)a[k] | (uint64_t)b[k]);
+            break;
+        case BIT_AND:
+            for (uint32_t k = 0; k < n; ++ k)
+                out[k] = static_cast<double>
+                    ((uint64_t)a[k] & (uint64_t)b[k]);
+            break;
+        case FUN1:
+            switch (ins.fun) {
+            case ibis::math::ACOS:
+                for (uint32_t k = 0; k < n; ++ k) out[k] = acos(a[k]);
+                break;
+            case ibis::math::ASIN:
+                for (uint32_t k = 0; k < n; ++ k) out[k] = asin(a[k]);
+                break;
+            case ibis::math::ATAN:
+                for (uint32_t k = 0; k < n; ++ k) out[k] = atan(a[k]);
+                break;
+            case ibis::math::CEIL:
+                for (uint32_t k = 0; k < n; ++ k) out[k] = ceil(a[k]);
+                break;
+            case ibis::math::COS:
+                for (uint32_t k = 0; k < n; ++ k) out[k] = cos(a[k]);
+                break;
+            case ibis::math::COSH:
+                for (uint32_t k = 0; k < n; ++ k) out[k] = cosh(a[k]);
+                break;
+            case ibis::math::EXP:
+                for (uint32_t k = 0; k < n; ++ k) out[k] = exp(a[k]);
+                break;
+            case ibis::math::FABS:
+                for (uint32_t k = 0; k < n; ++ k) out[k] = fabs(a[k]);
+                break;
+            case ibis::math::FLOOR:
+                for (uint32_t k = 0; k < n; ++ k) out[k] = floor(a[k]);
+                break;
+            case ibis::math::IS_ZERO:
+                for (uint32_t k = 0; k < n; ++ k)
+                    out[k] = (double)(0 == a[k]);
+                break;
+            case ibis::math::IS_NONZERO:
+                for (uint32_t k = 0; k < n; ++ k)
+                    out[k] = (double)(0 != a[k]);
+                break;
+            case ibis::math::FREXP:
+                for (uint32_t k = 0; k < n; ++ k) {
+                    int expptr;
+                    out[k] = frexp(a[k], &expptr);
+                }
+                break;
+            case ibis::math::LOG10:
+                for (uint32_t k = 0; k < n; ++ k) out[k] = log10(a[k]);
+                break;
+            case ibis::math::LOG:
+                for (uint32_t k = 0; k < n; ++ k) out[k] = log(a[k]);
+                break;
+            case ibis::math::MODF:
+                for (uint32_t k = 0; k < n; ++ k) {
+                    double intptr;
+                    out[k] = modf(a[k], &intptr);
+                }
+                break;
+            case ibis::math::ROUND:
+                for (uint32_t k = 0; k < n; ++ k) out[k] = floor(a[k]+0.5);
+                break;
+            case ibis::math::SIN:
+                for (uint32_t k = 0; k < n; ++ k) out[k] = sin(a[k]);
+                break;
+            case ibis::math::SINH:
+                for (uint32_t k = 0; k < n; ++ k) out[k] = sinh(a[k]);
+                break;
+            case ibis::math::SQRT:
+                for (uint32_t k = 0; k < n; ++ k) out[k] = sqrt(a[k]);
+                break;
+            case ibis::math::TAN:
+                for (uint32_t k = 0; k < n; ++ k) out[k] = tan(a[k]);
+                break;
+            case ibis::math::TANH:
+                for (uint32_t k = 0; k < n; ++ k) out[k] = tanh(a[k]);
+                break;
+            case ibis::math::TRUNC:
+                for (uint32_t k = 0; k < n; ++ k) out[k] = trunc(a[k]);
+                break;
+            default: // same as stdFunction1::eval, return the argument
+                std::copy(a, a+n, out);
+                break;
+            }
+            break;
+        case FUN2:
+            switch (ins.fun) {
+            case ibis::math::ATAN2:
+                for (uint32_t k = 0; k < n; ++ k) out[k] = atan2(a[k], b[k]);
+                break;
+            case ibis::math::FMOD:
+                for (uint32_t k = 0; k < n; ++ k) out[k] = fmod(a[k], b[k]);
+                break;
+            case ibis::math::LDEXP:
+                for (uint32_t k = 0; k < n; ++ k)
+                    out[k] = ldexp(a[k], static_cast<int>(b[k]));
+                break;
+            case ibis::math::POW:
+                for (uint32_t k = 0; k < n; ++ k) out[k] = pow(a[k], b[k]);
+                break;
+            case ibis::math::ROUND2:
+                for (uint32_t k = 0; k < n; ++ k) {
+                    const double scale = pow(1.0e1, floor(0.5+b[k]));
+                    out[k] = floor(0.5 + a[k] * scale) / scale;
+                }
+                break;
+            case ibis::math::IS_EQL:
+                for (uint32_t k = 0; k < n; ++ k)
+                    out[k] = (a[k] == b[k] ? 1.0 : 0.0);
+                break;
+            case ibis::math::IS_GTE:
+                for (uint32_t k = 0; k < n; ++ k)
+                    out[k] = (a[k] >= b[k] ? 1.0 : 0.0);
+                break;
+            case ibis::math::IS_LTE:
+                for (uint32_t k = 0; k < n; ++ k)
+                    out[k] = (a[k] <= b[k] ? 1.0 : 0.0);
+                break;
+            default: // same as stdFunction2::eval, return the 1st argument
+                std::copy(a, a+n, out);
+                break;
+            }
+            break;
+        }
+    }
+} // ibis::math::program::run
+
 void ibis::math::bediener::print(std::ostream& out) const {
     switch (operador) {
     case ibis::math::NEGATE:
@@ -166,6 +166,7 @@ public:
     /// Separate an expression tree into two connected with an AND operator.
     int separateSimple(ibis::qExpr *&simple, ibis::qExpr *&tail) const;
     void extractDeprecatedJoins(std::vector<const deprecatedJoin*>&) const;
+    void extractDisjuncts(std::vector<const qExpr*>&) const;
     /// Identify the data partitions involved in the query expression.
     virtual void getTableNames(std::set<std::string>& plist) const;
 
@@ -960,6 +961,7 @@ namespace ibis {
 	    virtual void print(std::ostream& out) const;
 	    virtual void printFull(std::ostream& out) const {print(out);}
 	    virtual term* reduce();
+	    STDFUN1 getFunction() const {return ftype;}
 
 	private:
 	    STDFUN1 ftype;
@@ -983,6 +985,7 @@ namespace ibis {
 	    virtual void print(std::ostream& out) const;
 	    virtual void printFull(std::ostream& out) const {print(out);}
 	    virtual term* reduce();
+	    STDFUN2 getFunction() const {return ftype;}
 
 	private:
 	    STDFUN2 ftype;
@@ -1159,6 +1162,59 @@ namespace ibis {
             std::string fmt_;
             std::string tzname_;
         }; // formatUnixTime
+
+	/// A flat form of arithmetic expressions for evaluating a block of
+	/// rows at a time.  The terms added with the function add are
+	/// translated into a list of instructions, each applying one
+	/// operator or standard function to whole arrays of BLOCKSIZE
+	/// values.  Compared with calling term::eval on each row, this
+	/// removes the virtual function calls and the switch statements
+	/// from the inner loops, and allows the compiler to use vector
+	/// instructions for them.
+	///
+	/// The variables are numbered as in the barrel given to the
+	/// constructor.  For each block of rows, the caller copies the
+	/// values of variable i into input(i), calls run, and then reads
+	/// the results of the terms from output.
+	class program {
+	public:
+	    /// The maximum number of rows evaluated together.
+	    enum {BLOCKSIZE = 1024};
+
+	    explicit program(const barrel &bar);
+
+	    int add(const term &t);
+	    void run(uint32_t n);
+
+	    /// The array to receive the values of the ith variable.  The
+	    /// pointer is only valid after all terms have been added.
+	    double* input(uint32_t i) {return &(regs[i*BLOCKSIZE]);}
+	    /// The results of the term identified by @c k, the return value
+	    /// of add.
+	    const double* output(int k) const {return &(regs[k*BLOCKSIZE]);}
+
+	private:
+	    /// The operations of the instructions.
+	    enum CODE {NEG, ADD, SUB, MUL, DIV, REM, POWER_OP, BIT_OR, BIT_AND,
+		       FUN1, FUN2};
+	    /// One instruction: out = left op right.  For FUN1 and FUN2,
+	    /// @c fun is the function.
+	    struct instruction {
+		CODE op;
+		int fun;
+		uint32_t out, left, right;
+	    };
+
+	    const barrel &vars; ///!< The variables.
+	    std::vector<instruction> code; ///!< The instructions in order.
+	    std::vector<double> regs; ///!< Registers of BLOCKSIZE values each.
+
+	    int compile(const term &t);
+	    uint32_t newRegister();
+
+	    program(const program&); // no copying
+	    program& operator=(const program&);
+	}; // program
     } // namespace ibis::math
 } // namespace ibis
 
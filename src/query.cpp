@@ -34,7 +34,9 @@ namespace ibis {
 
 /// Generate a weight based on estimated query processing costs.  This
 /// function produces consistent result only for operators AND and OR.  It
-/// assumes the cost of evaluating the negation to be zero.
+/// assumes the cost of evaluating the negation to be zero.  The costs of
+/// the range conditions reflect the speed of this machine once
+/// ibis::part::calibrateCosts has been run, see ibis::part::indexCost.
 double ibis::query::weight::operator()(const ibis::qExpr* ex) const {
     double res = dataset->nRows();
     switch (ex->getType()) {
@@ -771,6 +773,7 @@ int ibis::query::estimate() {
     LOGGER(ibis::gVerbose > 3)
         << evt << " -- starting to estimate query";
 
+    ibis::fileManager::arena pool("query::estimate");
     double pcnt = ibis::fileManager::instance().pageCount();
     if (dstime != 0 && dstime != mypart->timestamp()) {
         // clear the current results and prepare for re-evaluation
@@ -1018,6 +1021,7 @@ int ibis::query::evaluate(const bool evalSelect) {
 
     int ierr=-1;
     ibis::horometer timer;
+    ibis::fileManager::arena pool("query::evaluate");
     double pcnt = ibis::fileManager::instance().pageCount();
     writeLock lck(this, "evaluate");
     if ((state < FULL_EVALUATE) ||
@@ -2669,6 +2673,7 @@ void ibis::query::getBounds() {
     if (ibis::gVerbose > 7)
         logMessage("getBounds", "compute upper and lower bounds of hits");
 
+    mypart->prefetch(conds.getExpr());
     ibis::bitvector mask;
     conds.getNullMask(*mypart, mask);
     if (! comps.empty()) {
@@ -3033,6 +3038,8 @@ int ibis::query::computeHits() {
 
     int ierr = 0;
     if (hits == 0) { // have not performed an estimate
+        // start reading the files of all columns involved
+        mypart->prefetch(conds.getExpr());
         ibis::bitvector mask;
         conds.getNullMask(*mypart, mask);
         if (! comps.empty()) {
@@ -3919,6 +3926,13 @@ int ibis::query::doEvaluate(const ibis::qExpr* term,
         break;
     }
     case ibis::qExpr::LOGICAL_OR: {
+        std::vector<const ibis::qExpr*> terms;
+        term->extractDisjuncts(terms);
+        if (terms.size() > 2) {
+            ierr = doEvaluateOr(terms, 0, ht);
+            break;
+        }
+
         ierr = doEvaluate(term->getLeft(), ht);
         if (ierr >= 0) { //  && ht.cnt() < ht.size()
             ibis::bitvector b1;
@@ -4174,6 +4188,13 @@ int ibis::query::doEvaluate(const ibis::qExpr* term,
         break;
     }
     case ibis::qExpr::LOGICAL_OR: {
+        std::vector<const ibis::qExpr*> terms;
+        term->extractDisjuncts(terms);
+        if (terms.size() > 2) {
+            ierr = doEvaluateOr(terms, &mask, ht);
+            break;
+        }
+
         ierr = doEvaluate(term->getLeft(), mask, ht);
         if (ierr >= 0) {// && ht.cnt() < mask.cnt()
             ibis::bitvector b1;
@@ -4471,6 +4492,43 @@ int ibis::query::doEvaluate(const ibis::qExpr* term,
     return ierr;
 } // ibis::query::doEvaluate
 
+/// Evaluate the operands of a chain of OR operators.  The operands are
+/// evaluated one at a time, and the resulting bitvectors are combined with
+/// a single call to bitvector::orMany instead of one OR operation per
+/// operand.  If @c mask is not nil, the operands are evaluated under the
+/// mask.
+int ibis::query::doEvaluateOr(const std::vector<const ibis::qExpr*>& terms,
+                              const ibis::bitvector* mask,
+                              ibis::bitvector& ht) const {
+    std::vector<ibis::bitvector> res(terms.size());
+    ibis::array_t<ibis::bitvector*> ops;
+    ops.reserve(terms.size());
+    int ierr = 0;
+    for (size_t j = 0; j < terms.size(); ++ j) {
+        if (mask != 0)
+            ierr = doEvaluate(terms[j], *mask, res[j]);
+        else
+            ierr = doEvaluate(terms[j], res[j]);
+        if (ierr < 0) {
+            ht.clear();
+            return ierr;
+        }
+        if (ierr > 0)
+            ops.push_back(&(res[j]));
+    }
+
+    if (ops.empty()) {
+        ht.set(0, mask != 0 ? mask->size() : mypart->nRows());
+        return 0;
+    }
+    ht.orMany(ops);
+    LOGGER(ibis::gVerbose > 5)
+        << "query[" << myID << "]::doEvaluateOr -- combined "
+        << ops.size() << " of " << terms.size() << " operand"
+        << (terms.size() > 1 ? "s" : "") << " with orMany";
+    return ht.sloppyCount();
+} // ibis::query::doEvaluateOr
+
 /// A function to read the query file in a directory -- used by the
 /// constructor that takes a directory name as the argument
 /// the file contains:
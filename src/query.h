@@ -251,6 +251,8 @@ protected:
     int doEvaluate(const qExpr* term, ibis::bitvector& hits) const;
     int doEvaluate(const qExpr* term, const ibis::bitvector& mask,
 		   ibis::bitvector& hits) const;
+    int doEvaluateOr(const std::vector<const qExpr*>& terms,
+		     const ibis::bitvector* mask, ibis::bitvector& hits) const;
     int doScan(const qExpr* term, const ibis::bitvector& mask,
 	       ibis::bitvector& hits) const;
     int doScan(const qExpr* term, ibis::bitvector& hits) const;
@@ -2379,6 +2379,8 @@ int ibis::tafel::writeData(const char* dir, const char* tname,
         else { // remove the mask file
             remove(mskfile.c_str());
         }
+        (void) ibis::column::writeZoneMap(cnm.c_str(), col.type, msk);
+        (void) ibis::column::writeEncoded(cnm.c_str(), col.type);
 
         md << "\nBegin Column\nname = " << (*it).first << "\ndata_type = "
            << ibis::TYPESTRING[(int) col.type];
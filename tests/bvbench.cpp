@@ -0,0 +1,366 @@
+/// $Id$
+///
+/// A micro-benchmark for the basic operations on ibis::bitvector.  It
+/// generates pairs of bitmaps from a two-state Markov process with the
+/// specified bit density and clustering factor (the average number of
+/// consecutive ones), which are the parameters of the size models
+/// ibis::bitvector::randomSize and ibis::bitvector::markovSize.  A
+/// clustering factor of 1 or less means the bits are generated
+/// independently of each other.
+///
+/// For each combination of density and clustering factor, it times the
+/// bitwise operators (&, |, ^, -), cnt, count(mask), subset, iterating
+/// through indexSet, decoder::positions, decompress and compress.  The
+/// results are printed as comma-separated values, one line per
+/// operation, with the following fields:
+///
+/// op, nbits, density, clustering, model_bytes, actual_bytes,
+/// bytes_per_bit, words, ns_per_word, ms_per_op
+///
+/// where model_bytes is the expected size of one input bitmap according to
+/// randomSize or markovSize, actual_bytes is the average serialized size
+/// of the two input bitmaps, words is the number of compressed words
+/// touched by the operation, and ns_per_word is the elapsed time divided
+/// by words.  The lines can be compared across builds to catch
+/// performance regressions.
+///
+/// Usage:
+/// bvbench [-n nbits] [-r repeats] [-d density[,density...]]
+///         [-c clustering[,clustering...]] [-s seed] [-v[=n]]
+///
+
+#include <ibis.h>	// ibis name space, FastBit IBIS functions
+#include <twister.h>	// ibis::MersenneTwister
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cmath>	// std::log, std::floor
+
+/// Benchmark parameters.
+struct benchParam {
+    ibis::bitvector::word_t nbits;
+    unsigned repeats;
+    unsigned seed;
+    std::vector<double> densities;
+    std::vector<double> clusterings;
+};
+
+static void usage(const char *name) {
+    std::cout << "Usage:\n" << name
+	      << " [-n nbits] [-r repeats] [-d density[,density...]]\n"
+	      << "\t[-c clustering[,clustering...]] [-s seed] [-v[=n]]\n"
+	      << std::endl;
+} // usage
+
+/// Parse a comma-separated list of floating-point values.
+static void parseList(const char *str, std::vector<double>& lst) {
+    lst.clear();
+    while (str != 0 && *str != 0) {
+	char *end;
+	double tmp = strtod(str, &end);
+	if (end == str) break;
+	lst.push_back(tmp);
+	str = end;
+	while (*str == ',' || isspace(*str))
+	    ++ str;
+    }
+} // parseList
+
+static void parseArgs(int argc, char **argv, benchParam& par) {
+    par.nbits = 10000000;
+    par.repeats = 5;
+    par.seed = 0;
+    par.densities.clear();
+    par.clusterings.clear();
+    for (int i = 1; i < argc; ++ i) {
+	if (*argv[i] == '-') {
+	    switch (argv[i][1]) {
+	    case 'n':
+	    case 'N':
+		if (i+1 < argc) {
+		    ++ i;
+		    par.nbits = strtod(argv[i], 0);
+		}
+		break;
+	    case 'r':
+	    case 'R':
+		if (i+1 < argc) {
+		    ++ i;
+		    par.repeats = strtol(argv[i], 0, 0);
+		}
+		break;
+	    case 'd':
+	    case 'D':
+		if (i+1 < argc) {
+		    ++ i;
+		    parseList(argv[i], par.densities);
+		}
+		break;
+	    case 'c':
+	    case 'C':
+		if (i+1 < argc) {
+		    ++ i;
+		    parseList(argv[i], par.clusterings);
+		}
+		break;
+	    case 's':
+	    case 'S':
+		if (i+1 < argc) {
+		    ++ i;
+		    par.seed = strtol(argv[i], 0, 0);
+		}
+		break;
+	    case 'v':
+	    case 'V': {
+		const char *ptr = strchr(argv[i], '=');
+		if (ptr == 0) {
+		    ++ ibis::gVerbose;
+		}
+		else {
+		    ibis::gVerbose += strtol(ptr+1, 0, 0);
+		}
+		break;}
+	    default:
+	    case 'h':
+	    case 'H':
+		usage(*argv);
+		exit(0);
+	    }
+	}
+	else {
+	    usage(*argv);
+	    exit(0);
+	}
+    }
+    if (par.nbits <= ibis::bitvector::bitsPerLiteral())
+	par.nbits = 10000000;
+    if (par.repeats == 0)
+	par.repeats = 1;
+    if (par.densities.empty()) {
+	par.densities.push_back(0.0001);
+	par.densities.push_back(0.001);
+	par.densities.push_back(0.01);
+	par.densities.push_back(0.1);
+	par.densities.push_back(0.5);
+    }
+    if (par.clusterings.empty()) {
+	par.clusterings.push_back(1.0);
+	par.clusterings.push_back(4.0);
+	par.clusterings.push_back(64.0);
+    }
+} // parseArgs
+
+/// Draw the length of a run with the given mean from a geometric
+/// distribution.
+static ibis::bitvector::word_t
+runLength(ibis::MersenneTwister& mt, double mean) {
+    if (mean <= 1.0)
+	return 1;
+    double u = mt.nextDouble();
+    while (u <= 0.0)
+	u = mt.nextDouble();
+    return 1 + static_cast<ibis::bitvector::word_t>
+	(std::floor(std::log(u) / std::log(1.0 - 1.0 / mean)));
+} // runLength
+
+/// Generate a bitmap with @c nb bits.  The bits are set with probability
+/// @c den.  If @c f is greater than 1, the bits are generated from a
+/// Markov process where the runs of ones have @c f bits on the average,
+/// otherwise the bits are independent of each other.  The clustering
+/// factor @c f is raised to den/(1-den) if necessary, since the runs of
+/// zeros can not be shorter than 1.
+static void generate(ibis::MersenneTwister& mt, ibis::bitvector::word_t nb,
+		     double den, double& f, ibis::bitvector& bv) {
+    bv.clear();
+    if (den <= 0.0) {
+	bv.set(0, nb);
+	return;
+    }
+    if (den >= 1.0) {
+	bv.set(1, nb);
+	return;
+    }
+    if (f > 1.0 && f*(1.0-den) < den)
+	f = den / (1.0 - den);
+
+    if (f <= 1.0) {
+	for (ibis::bitvector::word_t j = 0; j < nb; ++ j)
+	    bv += static_cast<int>(mt.nextDouble() < den);
+    }
+    else {
+	const double zeros = f * (1.0 - den) / den;
+	int val = static_cast<int>(mt.nextDouble() < den);
+	ibis::bitvector::word_t j = 0;
+	while (j < nb) {
+	    ibis::bitvector::word_t len = runLength(mt, val ? f : zeros);
+	    if (len > nb - j)
+		len = nb - j;
+	    bv.appendFill(val, len);
+	    j += len;
+	    val = 1 - val;
+	}
+    }
+} // generate
+
+/// Print one line of the result.
+static void report(const char *op, ibis::bitvector::word_t nb, double den,
+		   double f, double model, double actual, double words,
+		   unsigned repeats, double sec) {
+    std::cout << op << ',' << nb << ',' << den << ',' << f << ','
+	      << std::setprecision(8) << model << ',' << actual << ','
+	      << actual / nb << ',' << words << ','
+	      << (words > 0 ? 1e9 * sec / (repeats * words) : 0.0) << ','
+	      << 1e3 * sec / repeats << std::setprecision(6) << std::endl;
+} // report
+
+/// Time all operations on bitmaps with the given density and clustering
+/// factor.
+static void runOne(ibis::MersenneTwister& mt, const benchParam& par,
+		   double den, double f) {
+    ibis::bitvector a, b;
+    generate(mt, par.nbits, den, f, a);
+    generate(mt, par.nbits, den, f, b);
+    // the first call to cnt also settles the internal counters
+    const ibis::bitvector::word_t nc = (a.cnt() + b.cnt()) / 2;
+    const double model = (f > 1.0 ?
+			  ibis::bitvector::markovSize(par.nbits, nc, f) :
+			  ibis::bitvector::randomSize(par.nbits, nc));
+    const double actual = 0.5 * (a.getSerialSize() + b.getSerialSize());
+    const double wa = a.getSerialSize() / sizeof(ibis::bitvector::word_t);
+    const double wab = wa + b.getSerialSize() / sizeof(ibis::bitvector::word_t);
+    ibis::horometer timer;
+    ibis::bitvector::word_t chk = 0;
+
+    timer.start();
+    for (unsigned r = 0; r < par.repeats; ++ r) {
+	ibis::bitvector *res = a & b;
+	chk += res->size();
+	delete res;
+    }
+    timer.stop();
+    report("and", par.nbits, den, f, model, actual, wab, par.repeats,
+	   timer.realTime());
+
+    timer.start();
+    for (unsigned r = 0; r < par.repeats; ++ r) {
+	ibis::bitvector *res = a | b;
+	chk += res->size();
+	delete res;
+    }
+    timer.stop();
+    report("or", par.nbits, den, f, model, actual, wab, par.repeats,
+	   timer.realTime());
+
+    timer.start();
+    for (unsigned r = 0; r < par.repeats; ++ r) {
+	ibis::bitvector *res = a ^ b;
+	chk += res->size();
+	delete res;
+    }
+    timer.stop();
+    report("xor", par.nbits, den, f, model, actual, wab, par.repeats,
+	   timer.realTime());
+
+    timer.start();
+    for (unsigned r = 0; r < par.repeats; ++ r) {
+	ibis::bitvector *res = a - b;
+	chk += res->size();
+	delete res;
+    }
+    timer.stop();
+    report("minus", par.nbits, den, f, model, actual, wab, par.repeats,
+	   timer.realTime());
+
+    // cnt caches its result, therefore it is timed on bitvectors freshly
+    // reconstructed from the serialized form of a
+    ibis::array_t<ibis::bitvector::word_t> ser;
+    a.write(ser);
+    double sec = 0.0;
+    for (unsigned r = 0; r < par.repeats; ++ r) {
+	ibis::bitvector cp(ser);
+	timer.start();
+	chk += cp.cnt();
+	timer.stop();
+	sec += timer.realTime();
+    }
+    report("cnt", par.nbits, den, f, model, actual, wa, par.repeats, sec);
+
+    timer.start();
+    for (unsigned r = 0; r < par.repeats; ++ r)
+	chk += a.count(b);
+    timer.stop();
+    report("count_mask", par.nbits, den, f, model, actual, wab, par.repeats,
+	   timer.realTime());
+
+    timer.start();
+    for (unsigned r = 0; r < par.repeats; ++ r) {
+	ibis::bitvector res;
+	a.subset(b, res);
+	chk += res.size();
+    }
+    timer.stop();
+    report("subset", par.nbits, den, f, model, actual, wab, par.repeats,
+	   timer.realTime());
+
+    timer.start();
+    for (unsigned r = 0; r < par.repeats; ++ r) {
+	for (ibis::bitvector::indexSet is = a.firstIndexSet();
+	     is.nIndices() > 0; ++ is) {
+	    const ibis::bitvector::word_t *ii = is.indices();
+	    chk += *ii;
+	}
+    }
+    timer.stop();
+    report("indexset", par.nbits, den, f, model, actual, wa, par.repeats,
+	   timer.realTime());
+
+    timer.start();
+    for (unsigned r = 0; r < par.repeats; ++ r) {
+	ibis::bitvector::word_t pos[256];
+	ibis::bitvector::decoder dec(a);
+	for (ibis::bitvector::word_t np = dec.positions(pos, 256); np > 0;
+	     np = dec.positions(pos, 256))
+	    chk += pos[np-1];
+    }
+    timer.stop();
+    report("decode", par.nbits, den, f, model, actual, wa, par.repeats,
+	   timer.realTime());
+
+    double dsec = 0.0, csec = 0.0;
+    for (unsigned r = 0; r < par.repeats; ++ r) {
+	ibis::bitvector cp;
+	cp.copy(a);
+	timer.start();
+	cp.decompress();
+	timer.stop();
+	dsec += timer.realTime();
+	timer.start();
+	cp.compress();
+	timer.stop();
+	csec += timer.realTime();
+	chk += cp.size();
+    }
+    report("decompress", par.nbits, den, f, model, actual, wa, par.repeats,
+	   dsec);
+    report("compress", par.nbits, den, f, model, actual,
+	   static_cast<double>(par.nbits / ibis::bitvector::bitsPerLiteral()),
+	   par.repeats, csec);
+
+    LOGGER(ibis::gVerbose > 1)
+	<< "bvbench -- density " << den << ", clustering factor " << f
+	<< ", checksum " << chk;
+} // runOne
+
+int main(int argc, char **argv) {
+    benchParam par;
+    parseArgs(argc, argv, par);
+    ibis::init();
+
+    ibis::MersenneTwister mt(par.seed);
+    std::cout << "op,nbits,density,clustering,model_bytes,actual_bytes,"
+	"bytes_per_bit,words,ns_per_word,ms_per_op" << std::endl;
+    for (size_t i = 0; i < par.densities.size(); ++ i)
+	for (size_t j = 0; j < par.clusterings.size(); ++ j)
+	    runOne(mt, par, par.densities[i], par.clusterings[j]);
+    return 0;
+} // main